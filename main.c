@@ -18,178 +18,224 @@
 #include "src/simulation.h"
 #include "src/input.h"
 #include "src/rendering.h"
+#include "src/app_state.h"
+#include "src/headless.h"
+#include "src/batch.h"
+#include "src/verify.h"
+#include "src/bench.h"
+#include "src/viewer.h"
+#include "src/region_stats.h"
+#include "src/sim_lod.h"
+#include "src/world_gen.h"
+#include <string.h>
+#include <time.h>
 
 #if defined(PLATFORM_WEB)
     #include <emscripten/emscripten.h>
 #endif
 
 //----------------------------------------------------------------------------------
-// Local Variables Definition (local to this module)
+// Application State
 //----------------------------------------------------------------------------------
-Camera camera = { 0 };
-int brushRadius = 8;  // Default brush radius (in grid cells)
-float lastSeedTime = 0;
-const float SEED_DELAY = 0.5f;  // Half second delay between seeds
-int currentSelectedType = CELL_TYPE_SOIL;  // Default to soil
-bool simulationRunning = false;  // Flag to control simulation state
-bool simulationPaused = true;    // Start with simulation paused
-bool initialStateMessageShown = false; // Flag to track if the initial state message has been shown
-bool pauseMessageDrawn = false;       // Flag to track if the pause message has been drawn
-bool stateChanged = true;             // Flag to detect state changes
-
-// Window and UI dimensions
-int windowWidth = 1920+300;
-int windowHeight = 1080;
-int uiPanelWidth = 300;  // Width of right side UI panel
-int gameWidth;           // Will be calculated based on grid dimensions
-int gameHeight;          // Will be calculated based on grid dimensions
-int minGameWidth = 800;  // Minimum game area width
-bool blackBackgroundDrawn = false;  // Flag to track initial drawing
-
-// Function to handle window resizing
-void HandleWindowResize(void) {
-    static int lastWidth = 0;
-    static int lastHeight = 0;
-
-    // Get DPI scaling factor
-    Vector2 dpiScale = GetWindowScaleDPI();
-
-    // Calculate actual pixel dimensions by dividing by DPI scaling factor
-    int newWidth = (int)(GetScreenWidth() / dpiScale.x);
-    int newHeight = (int)(GetScreenHeight() / dpiScale.y);
-
-    // Only proceed if the window dimensions have changed
-    if (newWidth != lastWidth || newHeight != lastHeight) {
-        lastWidth = newWidth;
-        lastHeight = newHeight;
-
-        // Reserve space for the UI panel
-        int actualGameWidth = newWidth - uiPanelWidth;
-
-        if (actualGameWidth < minGameWidth) {
-            actualGameWidth = minGameWidth;
-        }
-
-        // Calculate new cell size based on game area and fixed grid dimensions
-        int newCellSizeWidth = actualGameWidth / GRID_WIDTH;
-        int newCellSizeHeight = newHeight / GRID_HEIGHT;
-
-        // Use the smaller dimension to ensure grid fits
-        int newCellSize = (newCellSizeWidth < newCellSizeHeight) ? 
-                          newCellSizeWidth : newCellSizeHeight;
-
-        // Ensure cell size is at least 2 pixels
-        if (newCellSize < 2) newCellSize = 2;
-
-        // Update the global cell size
-        CELL_SIZE = newCellSize;
-
-        // Update game area dimensions based on actual grid size
-        gameWidth = CELL_SIZE * GRID_WIDTH;
-        gameHeight = CELL_SIZE * GRID_HEIGHT;
-
-        // Ensure the UI panel width remains consistent
-        uiPanelWidth = newWidth - gameWidth;
-
-        // Redraw black background after resize
-        blackBackgroundDrawn = false;
-
-        TraceLog(LOG_INFO, "Window resized: Cell size adjusted to %d pixels", CELL_SIZE);
-    }
+// Default front-end state: soil brush, paused until the player starts the simulation
+static void InitAppState(AppState* app) {
+    *app = (AppState){ 0 };
+    app->brushRadius = 8;                      // Default brush radius (in grid cells)
+    app->currentSelectedType = CELL_TYPE_SOIL; // Default to soil
+    app->simulationRunning = false;
+    app->simulationPaused = true;              // Start with simulation paused
+    app->stateChanged = true;
+
+    app->windowWidth = 1920+300;
+    app->windowHeight = 1080;
+    app->showMinimap = true;
+    app->reducedRateOffscreen = true;
+
+    // One 8 pixel square per cell; the viewport rectangle comes from the panel layout
+    app->view.zoom = 8.0f;
 }
 
 //----------------------------------------------------------------------------------
 // Local Functions Declaration
 //----------------------------------------------------------------------------------
-static void UpdateDrawFrame(void);
-void SetSimulationState(bool running, bool paused);
-void HandleStateMessages(void);
+static void UpdateDrawFrame(AppState* app, World* world);
+void SetSimulationState(AppState* app, bool running, bool paused);
+void HandleStateMessages(AppState* app);
+
+int main(int argc, char** argv) {
+    // Headless, batch, verify and benchmark runs skip the window entirely; the
+    // viewer opens its own
+    bool generate = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--generate") == 0) {
+            generate = true;
+        }
+        if (strcmp(argv[i], "--headless") == 0) {
+            return RunHeadless(argc, argv);
+        }
+        if (strcmp(argv[i], "--batch") == 0) {
+            return RunBatch(argc, argv);
+        }
+        if (strcmp(argv[i], "--verify") == 0) {
+            return RunVerify(argc, argv);
+        }
+        if (strcmp(argv[i], "--bench") == 0) {
+            return RunBench(argc, argv);
+        }
+        if (strcmp(argv[i], "--viewer") == 0) {
+            return RunViewer(argc, argv);
+        }
+    }
+
+    AppState app;
+    World world;
+    InitAppState(&app);
 
-int main(void) {
     // Initialize window with resizable flag
-    InitWindow(windowWidth, windowHeight, "Sandbox Simulation");
+    InitWindow(app.windowWidth, app.windowHeight, "Sandbox Simulation");
     SetWindowState(FLAG_WINDOW_RESIZABLE);
     
-    // Initialize grid
-    InitGrid();
-    
-    // Set initial game dimensions
-    gameWidth = CELL_SIZE * GRID_WIDTH;
-    gameHeight = CELL_SIZE * GRID_HEIGHT;
+    // Initialize grid, starting from a procedural scene with --generate
+    unsigned int seed = (unsigned int)time(NULL);
+    if (!InitWorld(&world, DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT, seed)) {
+        CloseWindow();
+        return 1;
+    }
+    if (generate) {
+        WorldGenOptions genOptions = DefaultWorldGenOptions(seed);
+        GenerateWorld(&world, &genOptions, NULL);
+    }
     
+    // Summed-area tables behind the panel's region readouts (they fall back to
+    // summing cells if this fails)
+    InitRegionStats(&world);
+
+    // Color pyramid behind the zoomable view and the minimap
+    if (!InitColorPyramid(&app.pyramid, world.width, world.height)) {
+        CleanupWorld(&world);
+        CloseWindow();
+        return 1;
+    }
+
+    // Coverage bitmap for mouse strokes, the undo history of those strokes and the rewind buffer
+    if (!InitBrushStroke(&app.stroke, world.width, world.height) ||
+        !InitUndoHistory(&app.history, world.width, world.height, HISTORY_DEFAULT_BUDGET) ||
+        !InitRewind(&app.rewind, &world, REWIND_DEFAULT_INTERVAL, REWIND_DEFAULT_BUDGET)) {
+        CleanupRewind(&app.rewind);
+        CleanupUndoHistory(&app.history);
+        CleanupBrushStroke(&app.stroke);
+        CleanupColorPyramid(&app.pyramid);
+        CleanupWorld(&world);
+        CloseWindow();
+        return 1;
+    }
+
     SetTargetFPS(60);
     
     while (!WindowShouldClose()) {
-        // Check if window was resized
-        if (IsWindowResized()) {
-            HandleWindowResize();
-        }
-        
-        UpdateDrawFrame();
+        UpdateDrawFrame(&app, &world);
     }
     
     // Cleanup
-    CleanupGrid();
+    UnloadUIPanel(&app);
+    UnloadGridTextures(&app);
+    CleanupRewind(&app.rewind);
+    CleanupUndoHistory(&app.history);
+    CleanupBrushStroke(&app.stroke);
+    CleanupColorPyramid(&app.pyramid);
+    CleanupWorld(&world);
     CloseWindow();
     
     return 0;
 }
 
 // Update and draw frame function
-static void UpdateDrawFrame(void) {
-    HandleInput(); // Handle user input first
+static void UpdateDrawFrame(AppState* app, World* world) {
+    // Lay out the viewport and side panel again when the window size or DPI changed
+    bool resized = app->panel.layout.screenWidth != 0;
+    if (UpdatePanelLayout(&app->panel, GetScreenWidth(), GetScreenHeight(), GetWindowScaleDPI().x)) {
+        const PanelLayout* layout = &app->panel.layout;
+        app->view.x = layout->viewport.x;
+        app->view.y = layout->viewport.y;
+        app->view.width = layout->viewport.width;
+        app->view.height = layout->viewport.height;
+
+        // A resized window zooms to fit the world in whole pixels per cell, at least 2
+        if (resized) {
+            float fitZoom = floorf(MinViewportZoom(&app->view, world->width, world->height));
+            app->view.zoom = (fitZoom < 2.0f) ? 2.0f : fitZoom;
+            app->blackBackgroundDrawn = false;
+            TraceLog(LOG_INFO, "Window resized: Cell size adjusted to %d pixels", (int)app->view.zoom);
+        }
+        ClampViewport(&app->view, world->width, world->height);
+    }
+
+    HandleInput(app, world); // Handle user input first
 
     BeginDrawing(); // Start rendering the frame
 
         ClearBackground(BLACK); // Clear the background at the start of the frame
 
-        if (simulationRunning && !simulationPaused) {
-            // Update the simulation state if running
-            UpdateGrid();
+        if (app->simulationRunning && !app->simulationPaused) {
+            // Full rate around the visible cells. Moving the focus changes what the
+            // following ticks compute, so recorded ticks after this one are dropped.
+            const Viewport* view = &app->view;
+            if (SetSimulationFocus(world, (int)view->cameraX, (int)view->cameraY,
+                                   (int)(view->cameraX + view->width / view->zoom) + 1,
+                                   (int)(view->cameraY + view->height / view->zoom) + 1,
+                                   SIM_LOD_MARGIN, app->reducedRateOffscreen ? SIM_LOD_DEFAULT_INTERVAL : 1)) {
+                MarkRewindEdited(&app->rewind, world);
+            }
+
+            // Update the simulation state if running, keeping keyframes to rewind to
+            RecordRewindTick(&app->rewind, world);
+            UpdateGrid(world);
         }
 
-        DrawGameGrid(); // Render the simulation grid
-        DrawUIOnRight(gameHeight, uiPanelWidth); // Render the UI elements
+        DrawGameGrid(app, world); // Render the simulation grid
+        DrawUIOnRight(app, world); // Render the UI elements
 
-        HandleStateMessages(); // Render state-specific messages on top of everything else
+        HandleStateMessages(app); // Render state-specific messages on top of everything else
 
     EndDrawing(); // Finalize and display the frame
 }
 
 // Helper function to handle state messages
-void HandleStateMessages(void) {
-    if (simulationRunning && !simulationPaused) {
+void HandleStateMessages(AppState* app) {
+    if (app->simulationRunning && !app->simulationPaused) {
         // Clear background once when transitioning to running state
-        if (!blackBackgroundDrawn) {
+        if (!app->blackBackgroundDrawn) {
             ClearBackground(BLACK);
-            blackBackgroundDrawn = true;
+            app->blackBackgroundDrawn = true;
         }
-        initialStateMessageShown = true; // Mark initial message as shown
+        app->initialStateMessageShown = true; // Mark initial message as shown
     } else {
-        // Blank a bar across the screen under the state text
+        // Blank a bar across the viewport under the state text
+        int gameWidth = (int)app->panel.layout.viewport.width;
         DrawRectangle(0, GetScreenHeight() / 2 - 20, gameWidth, 40, BLACK);
 
-        if (!simulationRunning && !initialStateMessageShown) {
+        if (!app->simulationRunning && !app->initialStateMessageShown) {
             // Draw initial state message
             DrawText("SET UP INITIAL STATE THEN PRESS SPACE TO START SIMULATION", 
                      gameWidth / 2 - MeasureText("SET UP INITIAL STATE THEN PRESS SPACE TO START SIMULATION", 20) / 2,
                      GetScreenHeight() / 2 - 15, 20, WHITE);
-        } else if (simulationPaused && !pauseMessageDrawn) {
+        } else if (app->simulationPaused && !app->pauseMessageDrawn) {
             // Draw pause message
             DrawText("SIMULATION PAUSED - PRESS SPACE TO RESUME", 
                      gameWidth / 2 - MeasureText("SIMULATION PAUSED - PRESS SPACE TO RESUME", 20) / 2,
                      GetScreenHeight() / 2 - 15, 20, WHITE);
-            pauseMessageDrawn = true; // Mark pause message as drawn
+            app->pauseMessageDrawn = true; // Mark pause message as drawn
         }
     }
 }
 
 // Update state change flag when simulation state changes
-void SetSimulationState(bool running, bool paused) {
-    if (simulationRunning != running || simulationPaused != paused) {
-        stateChanged = true;
-        pauseMessageDrawn = false; // Reset pause message flag on state change
+void SetSimulationState(AppState* app, bool running, bool paused) {
+    if (app->simulationRunning != running || app->simulationPaused != paused) {
+        app->stateChanged = true;
+        app->pauseMessageDrawn = false; // Reset pause message flag on state change
     }
-    simulationRunning = running; // Set simulationRunning to the provided value
-    simulationPaused = paused;   // Set simulationPaused to the provided value
+    app->simulationRunning = running; // Set app->simulationRunning to the provided value
+    app->simulationPaused = paused;   // Set app->simulationPaused to the provided value
 }
@@ -0,0 +1,51 @@
+#ifndef APP_STATE_H
+#define APP_STATE_H
+
+#include "raylib.h"
+#include "viewport.h"
+#include "color_pyramid.h"
+#include "ui_panel.h"
+#include "brush_stroke.h"
+#include "history.h"
+#include "rewind.h"
+#include <stdbool.h>
+
+// GPU copies of the color pyramid levels. A texture one version behind its level
+// only receives the changed rectangles; otherwise the whole level is uploaded.
+typedef struct {
+    Texture2D level[PYRAMID_MAX_LEVELS];
+    unsigned int version[PYRAMID_MAX_LEVELS];  // pyramid version each texture holds
+    Color* staging;       // contiguous copy of a rectangle for UpdateTextureRec
+    int uploadedBytes;    // bytes sent to the GPU during the last frame
+    int uploadedRects;    // texture updates issued during the last frame
+} GridTextures;
+
+// State of the interactive front end (input, UI and window layout).
+// The simulation itself lives in a World; both are passed explicitly.
+typedef struct {
+    int brushRadius;               // brush radius in grid cells
+    int currentSelectedType;       // material placed with the left mouse button
+    bool simulationRunning;
+    bool simulationPaused;
+    bool initialStateMessageShown; // the initial state message has been shown
+    bool pauseMessageDrawn;        // the pause message has been drawn
+    bool stateChanged;             // running/paused state changed since last frame
+    bool blackBackgroundDrawn;     // background cleared after a resize
+    bool mouseStartedInUI;         // the current drag began over the UI panel
+    bool showMinimap;
+    bool reducedRateOffscreen;     // parts of the world away from the view update less often
+
+    // Initial window size; the viewport and panel come from panel.layout
+    int windowWidth;
+    int windowHeight;
+
+    Viewport view;
+    ColorPyramid pyramid;   // downsampled world colors for zoomed-out views and the minimap
+    GridTextures textures;
+    UIPanel panel;          // side panel layout, widgets and cached rendering
+    BrushStroke stroke;     // the stroke painted by the held mouse button
+    UndoHistory history;    // undo/redo of brush strokes
+    RewindBuffer rewind;    // keyframes for stepping back through simulation ticks
+} AppState;
+
+#endif // APP_STATE_H
@@ -0,0 +1,269 @@
+#include "batch.h"
+#include "grid.h"
+#include "cell_rules.h"
+#include "simulation.h"
+#include "telemetry.h"
+#include "headless.h"
+#include <pthread.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#if !defined(_WIN32)
+    #include <unistd.h>
+#endif
+
+#define BATCH_MAX_VALUES 32
+
+// Parameters that can be swept, mapped onto SimParams fields
+typedef struct {
+    const char* name;
+    size_t offset;
+} BatchParam;
+
+static const BatchParam batchParams[] = {
+    { "saturation", offsetof(SimParams, saturationBase) },
+    { "saturation-per-degree", offsetof(SimParams, saturationPerDegree) },
+    { "absorb-cap", offsetof(SimParams, absorbCap) },
+    { "diagonal-chance", offsetof(SimParams, waterDiagonalChance) },
+    { "spread-chance", offsetof(SimParams, waterSpreadChance) },
+};
+
+#define BATCH_PARAM_COUNT ((int)(sizeof(batchParams) / sizeof(batchParams[0])))
+
+// One axis of the sweep: a parameter and the values it takes
+typedef struct {
+    int param;
+    int values[BATCH_MAX_VALUES];
+    int valueCount;
+} BatchAxis;
+
+// Outcome of one run
+typedef struct {
+    SimParams params;
+    int seed;
+    int startMoisture;
+    int endMoisture;
+    TelemetrySample last;
+    float meanActiveCells;
+    double seconds;
+} BatchResult;
+
+// Work shared by the worker threads
+typedef struct {
+    BatchAxis axes[BATCH_PARAM_COUNT];
+    int axisCount;
+    int seeds;
+    int ticks;
+    int jobCount;
+    int nextJob;
+    pthread_mutex_t lock;
+    BatchResult* results;
+} BatchQueue;
+
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int CountCores(void) {
+#if defined(_WIN32)
+    const char* cores = getenv("NUMBER_OF_PROCESSORS");
+    int count = cores ? atoi(cores) : 1;
+#else
+    int count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return (count < 1) ? 1 : count;
+}
+
+static int FindParam(const char* name, size_t length) {
+    for (int i = 0; i < BATCH_PARAM_COUNT; i++) {
+        if (strlen(batchParams[i].name) == length && strncmp(batchParams[i].name, name, length) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Parse "name=v1,v2,..." into a sweep axis
+static bool ParseAxis(const char* text, BatchAxis* axis) {
+    const char* equals = strchr(text, '=');
+    if (!equals) return false;
+
+    axis->param = FindParam(text, (size_t)(equals - text));
+    if (axis->param < 0) return false;
+
+    axis->valueCount = 0;
+    const char* value = equals + 1;
+    while (*value && axis->valueCount < BATCH_MAX_VALUES) {
+        axis->values[axis->valueCount++] = atoi(value);
+        value = strchr(value, ',');
+        if (!value) break;
+        value++;
+    }
+    return axis->valueCount > 0;
+}
+
+// Decode a job index into the parameter combination and seed it runs
+static void DescribeJob(const BatchQueue* queue, int job, SimParams* params, int* seed) {
+    *params = DefaultSimParams();
+    *seed = 1 + job % queue->seeds;
+    job /= queue->seeds;
+
+    for (int a = queue->axisCount - 1; a >= 0; a--) {
+        const BatchAxis* axis = &queue->axes[a];
+        int* field = (int*)((char*)params + batchParams[axis->param].offset);
+        *field = axis->values[job % axis->valueCount];
+        job /= axis->valueCount;
+    }
+}
+
+// Simulate one job in its own world
+static void RunJob(const BatchQueue* queue, int job, BatchResult* result) {
+    DescribeJob(queue, job, &result->params, &result->seed);
+
+    World world;
+    if (!InitWorld(&world, DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT, (unsigned int)result->seed)) {
+        return;
+    }
+    world.params = result->params;
+    SeedDemoScene(&world);
+
+    double start = Now();
+    result->startMoisture = CalculateTotalMoisture(&world);
+
+    long activeTotal = 0;
+    int sampled = 0;
+    for (int tick = 0; tick < queue->ticks; tick++) {
+        UpdateGrid(&world);
+
+        if (GetTelemetryTotal(&world) != sampled) {
+            activeTotal += GetLatestTelemetrySample(&world)->activeCells;
+            sampled = GetTelemetryTotal(&world);
+        }
+    }
+
+    result->endMoisture = CalculateTotalMoisture(&world);
+    if (GetLatestTelemetrySample(&world)) {
+        result->last = *GetLatestTelemetrySample(&world);
+    }
+    result->meanActiveCells = sampled > 0 ? (float)activeTotal / sampled : 0.0f;
+    result->seconds = Now() - start;
+
+    CleanupWorld(&world);
+}
+
+// Worker thread: keep taking jobs until the queue is empty
+static void* BatchWorker(void* arg) {
+    BatchQueue* queue = (BatchQueue*)arg;
+
+    for (;;) {
+        pthread_mutex_lock(&queue->lock);
+        int job = queue->nextJob++;
+        pthread_mutex_unlock(&queue->lock);
+
+        if (job >= queue->jobCount) break;
+        RunJob(queue, job, &queue->results[job]);
+    }
+    return NULL;
+}
+
+static void WriteSummary(FILE* file, const BatchQueue* queue) {
+    fprintf(file, "run,seed");
+    for (int i = 0; i < BATCH_PARAM_COUNT; i++) {
+        fprintf(file, ",%s", batchParams[i].name);
+    }
+    fprintf(file, ",ticks,start_moisture,end_moisture,water_cells,air_moisture,water_moisture,soil_moisture,mean_active_cells,seconds\n");
+
+    for (int job = 0; job < queue->jobCount; job++) {
+        const BatchResult* r = &queue->results[job];
+        fprintf(file, "%d,%d", job, r->seed);
+        for (int i = 0; i < BATCH_PARAM_COUNT; i++) {
+            fprintf(file, ",%d", *(const int*)((const char*)&r->params + batchParams[i].offset));
+        }
+        fprintf(file, ",%d,%d,%d,%d,%d,%d,%d,%.1f,%.3f\n", queue->ticks, r->startMoisture, r->endMoisture,
+                r->last.cellCounts[CELL_TYPE_WATER], r->last.airMoisture, r->last.waterMoisture,
+                r->last.soilMoisture, r->meanActiveCells, r->seconds);
+    }
+}
+
+int RunBatch(int argc, char** argv) {
+    BatchQueue queue = { 0 };
+    queue.seeds = 1;
+    queue.ticks = 1000;
+    int threads = CountCores();
+    const char* outPath = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = (i + 1 < argc);
+        if (strcmp(argv[i], "--ticks") == 0 && hasValue) {
+            queue.ticks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seeds") == 0 && hasValue) {
+            queue.seeds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--out") == 0 && hasValue) {
+            outPath = argv[++i];
+        } else if (strcmp(argv[i], "--param") == 0 && hasValue) {
+            if (queue.axisCount >= BATCH_PARAM_COUNT || !ParseAxis(argv[++i], &queue.axes[queue.axisCount])) {
+                printf("ERROR: Invalid parameter sweep '%s'\n", argv[i]);
+                return 1;
+            }
+            queue.axisCount++;
+        }
+    }
+    if (queue.seeds < 1) queue.seeds = 1;
+    if (threads < 1) threads = 1;
+
+    queue.jobCount = queue.seeds;
+    for (int a = 0; a < queue.axisCount; a++) {
+        queue.jobCount *= queue.axes[a].valueCount;
+    }
+    if (threads > queue.jobCount) threads = queue.jobCount;
+
+    queue.results = (BatchResult*)calloc(queue.jobCount, sizeof(BatchResult));
+    pthread_t* workers = (pthread_t*)malloc(threads * sizeof(pthread_t));
+    if (!queue.results || !workers) {
+        printf("ERROR: Failed to allocate memory for batch runs\n");
+        free(queue.results);
+        free(workers);
+        return 1;
+    }
+
+    // Rule kernels are shared read-only by every world, so build them before the workers start
+    CompileCellRules();
+    pthread_mutex_init(&queue.lock, NULL);
+
+    printf("Batch: %d runs of %d ticks on %d threads\n", queue.jobCount, queue.ticks, threads);
+    double start = Now();
+
+    int started = 0;
+    for (int t = 0; t < threads; t++) {
+        if (pthread_create(&workers[started], NULL, BatchWorker, &queue) == 0) {
+            started++;
+        } else {
+            printf("ERROR: Failed to start batch worker %d\n", t);
+        }
+    }
+    if (started == 0) BatchWorker(&queue); // Fall back to running on this thread
+    for (int t = 0; t < started; t++) {
+        pthread_join(workers[t], NULL);
+    }
+
+    printf("Batch finished in %.2f s\n", Now() - start);
+
+    FILE* out = outPath ? fopen(outPath, "w") : stdout;
+    if (!out) {
+        printf("ERROR: Failed to open batch summary %s\n", outPath);
+    } else {
+        WriteSummary(out, &queue);
+        if (out != stdout) fclose(out);
+    }
+
+    pthread_mutex_destroy(&queue.lock);
+    free(workers);
+    free(queue.results);
+    return out ? 0 : 1;
+}
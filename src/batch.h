@@ -0,0 +1,11 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+// Run a parameter sweep: every combination of the given parameter values is
+// simulated headless, one world per worker thread, and summarized as CSV.
+// Options: --ticks N, --seeds N, --threads N, --out file.csv,
+//          --param name=v1,v2,... (repeatable, see batchParams in batch.c)
+// Returns the process exit code.
+int RunBatch(int argc, char** argv);
+
+#endif // BATCH_H
@@ -0,0 +1,193 @@
+#include "bench.h"
+#include "grid.h"
+#include "cell_types.h"
+#include "simulation.h"
+#include "update_water.h"
+#include "fluid.h"
+#include "headless.h"
+#include "world_gen.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_MAX_WIDTHS 8
+
+typedef enum {
+    BENCH_WATER_RULES,
+    BENCH_WATER_PRESSURE,
+    BENCH_AIR,
+    BENCH_COUNT_NEIGHBOURS,
+    BENCH_MERGE_AIR,
+    BENCH_TICK,
+    BENCH_KERNEL_COUNT
+} BenchKernel;
+
+static const char* benchKernelNames[BENCH_KERNEL_COUNT] = {
+    "UpdateWater (rules)", "UpdateWaterPressure", "UpdateAir",
+    "CountWaterNeighbors", "MergeAirMoisture", "UpdateGrid",
+};
+
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Run one kernel over the whole world; returns a value that depends on the result
+static int RunKernel(World* world, BenchKernel kernel) {
+    int sum = 0;
+    switch (kernel) {
+        case BENCH_WATER_RULES:
+            SetWaterModel(world, WATER_MODEL_CELLULAR);
+            UpdateWater(world);
+            break;
+        case BENCH_WATER_PRESSURE:
+            // Keep every chunk awake so each call does the same amount of work
+            SetWaterModel(world, WATER_MODEL_PRESSURE);
+            WakeAllFluid(world);
+            UpdateWater(world);
+            break;
+        case BENCH_AIR:
+            UpdateAir(world);
+            break;
+        case BENCH_COUNT_NEIGHBOURS:
+            for (int y = 1; y < world->height - 1; y++) {
+                for (int x = 1; x < world->width - 1; x++) {
+                    sum += CountWaterNeighbors(world, x, y);
+                }
+            }
+            break;
+        case BENCH_MERGE_AIR:
+            for (int y = 1; y < world->height - 1; y++) {
+                for (int x = 1; x < world->width - 1; x++) {
+                    MergeAirMoisture(world, x, y);
+                }
+            }
+            break;
+        case BENCH_TICK:
+            UpdateGrid(world);
+            break;
+        default:
+            break;
+    }
+    return sum;
+}
+
+// Fingerprint of the cells, identical for every layout when the kernels agree
+static unsigned int HashWorld(const World* world) {
+    unsigned int hash = 2166136261u;
+    for (int y = 0; y < world->height; y++) {
+        for (int x = 0; x < world->width; x++) {
+            const GridCell* cell = GetCell(world, x, y);
+            hash = (hash ^ (unsigned int)(cell->type + 1)) * 16777619u;
+            hash = (hash ^ (unsigned int)cell->moisture) * 16777619u;
+        }
+    }
+    return hash;
+}
+
+// Time every kernel on one layout; fills ms[kernel] with the mean time per call
+static bool BenchLayout(int width, int height, int layout, bool generated, int reps, double* ms, unsigned int* hash) {
+    World world;
+    if (!InitWorldWithLayout(&world, width, height, 1, layout)) return false;
+    if (generated) {
+        WorldGenOptions options = DefaultWorldGenOptions(1);
+        if (!GenerateWorld(&world, &options, NULL)) {
+            CleanupWorld(&world);
+            return false;
+        }
+    } else {
+        SeedDemoScene(&world);
+    }
+
+    volatile int sink = 0;
+    for (int k = 0; k < BENCH_KERNEL_COUNT; k++) {
+        sink += RunKernel(&world, (BenchKernel)k);  // Warm up caches and page mappings
+
+        double start = Now();
+        for (int r = 0; r < reps; r++) {
+            sink += RunKernel(&world, (BenchKernel)k);
+        }
+        ms[k] = (Now() - start) * 1000.0 / reps;
+    }
+    (void)sink;
+
+    *hash = HashWorld(&world);
+    CleanupWorld(&world);
+    return true;
+}
+
+int RunBench(int argc, char** argv) {
+    int widths[BENCH_MAX_WIDTHS] = { DEFAULT_GRID_WIDTH, 1920, 4096 };
+    int widthCount = 3;
+    int height = DEFAULT_GRID_HEIGHT;
+    int reps = 10;
+    int onlyLayout = -1;
+    bool generated = false;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = (i + 1 < argc);
+        if (strcmp(argv[i], "--widths") == 0 && hasValue) {
+            widthCount = 0;
+            for (char* p = argv[++i]; *p && widthCount < BENCH_MAX_WIDTHS; ) {
+                int width = (int)strtol(p, &p, 10);
+                if (width >= 3) widths[widthCount++] = width;
+                if (*p == ',') p++;
+                else if (*p) break;
+            }
+        } else if (strcmp(argv[i], "--height") == 0 && hasValue) {
+            height = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--reps") == 0 && hasValue) {
+            reps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--scene") == 0 && hasValue) {
+            generated = (strcmp(argv[++i], "generated") == 0);
+        } else if (strcmp(argv[i], "--layout") == 0 && hasValue) {
+            onlyLayout = ParseGridLayout(argv[++i]);
+            if (onlyLayout < 0) {
+                printf("ERROR: Unknown grid layout '%s'\n", argv[i]);
+                return 1;
+            }
+        }
+    }
+    if (reps < 1) reps = 1;
+    if (height < 3 || widthCount == 0) {
+        printf("ERROR: Invalid benchmark size\n");
+        return 1;
+    }
+
+    int status = 0;
+    for (int w = 0; w < widthCount; w++) {
+        double ms[GRID_LAYOUT_COUNT][BENCH_KERNEL_COUNT] = { { 0 } };
+        unsigned int hash[GRID_LAYOUT_COUNT] = { 0 };
+        bool ran[GRID_LAYOUT_COUNT] = { false };
+
+        for (int layout = 0; layout < GRID_LAYOUT_COUNT; layout++) {
+            if (onlyLayout >= 0 && layout != onlyLayout) continue;
+            ran[layout] = BenchLayout(widths[w], height, layout, generated, reps, ms[layout], &hash[layout]);
+            if (!ran[layout]) status = 1;
+        }
+
+        printf("\n%dx%d, ms per call (%d calls)\n%-22s", widths[w], height, reps, "kernel");
+        for (int layout = 0; layout < GRID_LAYOUT_COUNT; layout++) {
+            if (ran[layout]) printf("%10s", GetGridLayoutName(layout));
+        }
+        printf("\n");
+        for (int k = 0; k < BENCH_KERNEL_COUNT; k++) {
+            printf("%-22s", benchKernelNames[k]);
+            for (int layout = 0; layout < GRID_LAYOUT_COUNT; layout++) {
+                if (ran[layout]) printf("%10.3f", ms[layout][k]);
+            }
+            printf("\n");
+        }
+
+        // Storage order must never change the results
+        for (int layout = 1; layout < GRID_LAYOUT_COUNT; layout++) {
+            if (ran[layout] && ran[0] && hash[layout] != hash[0]) {
+                printf("ERROR: %s layout produced a different world than rows\n", GetGridLayoutName(layout));
+                status = 1;
+            }
+        }
+    }
+    return status;
+}
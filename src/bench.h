@@ -0,0 +1,12 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+// Time the neighbourhood-heavy kernels (water rules and pressure solver, air,
+// CountWaterNeighbors, MergeAirMoisture, a full UpdateGrid) on the same scene
+// stored in each grid layout, at several widths.
+// Options: --widths w1,w2,... --height N, --reps N, --layout rows|tiles|morton (only that one),
+// --scene demo|generated (the headless demo scene or a procedural one, see world_gen.h)
+// Returns the process exit code.
+int RunBench(int argc, char** argv);
+
+#endif // BENCH_H
@@ -0,0 +1,152 @@
+#include "brush_stroke.h"
+#include "cell_actions.h"
+#include "fluid.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+bool InitBrushStroke(BrushStroke* stroke, int width, int height) {
+    memset(stroke, 0, sizeof(BrushStroke));
+    stroke->width = width;
+    stroke->height = height;
+    stroke->wordsPerRow = (width + 63) / 64;
+
+    stroke->coverage = (uint64_t*)calloc((size_t)stroke->wordsPerRow * height, sizeof(uint64_t));
+    if (!stroke->coverage) {
+        printf("ERROR: Failed to allocate memory for brush coverage\n");
+        return false;
+    }
+    return true;
+}
+
+void CleanupBrushStroke(BrushStroke* stroke) {
+    free(stroke->coverage);
+    free(stroke->pending);
+    memset(stroke, 0, sizeof(BrushStroke));
+}
+
+// Queue a cell for placement
+static void QueueCell(BrushStroke* stroke, int x, int y) {
+    if (stroke->pendingCount == stroke->pendingCapacity) {
+        int capacity = stroke->pendingCapacity ? stroke->pendingCapacity * 2 : 1024;
+        int* pending = (int*)realloc(stroke->pending, capacity * sizeof(int));
+        if (!pending) {
+            printf("ERROR: Failed to allocate memory for brush stamps\n");
+            return;
+        }
+        stroke->pending = pending;
+        stroke->pendingCapacity = capacity;
+    }
+
+    if (stroke->pendingCount == 0) {
+        stroke->pendingX0 = x;
+        stroke->pendingY0 = y;
+        stroke->pendingX1 = x + 1;
+        stroke->pendingY1 = y + 1;
+    } else {
+        if (x < stroke->pendingX0) stroke->pendingX0 = x;
+        if (y < stroke->pendingY0) stroke->pendingY0 = y;
+        if (x >= stroke->pendingX1) stroke->pendingX1 = x + 1;
+        if (y >= stroke->pendingY1) stroke->pendingY1 = y + 1;
+    }
+    stroke->pending[stroke->pendingCount++] = y * stroke->width + x;
+}
+
+// Queue every uncovered interior cell within 'radius' of the segment (x0, y0)-(x1, y1)
+static void SweepSegment(BrushStroke* stroke, int radius, int x0, int y0, int x1, int y1) {
+    int minX = ((x0 < x1) ? x0 : x1) - radius;
+    int maxX = ((x0 > x1) ? x0 : x1) + radius;
+    int minY = ((y0 < y1) ? y0 : y1) - radius;
+    int maxY = ((y0 > y1) ? y0 : y1) + radius;
+
+    // Border cells are never painted
+    if (minX < 1) minX = 1;
+    if (minY < 1) minY = 1;
+    if (maxX > stroke->width - 2) maxX = stroke->width - 2;
+    if (maxY > stroke->height - 2) maxY = stroke->height - 2;
+    if (minX > maxX || minY > maxY) return;
+
+    if (minY < stroke->coveredY0) stroke->coveredY0 = minY;
+    if (maxY + 1 > stroke->coveredY1) stroke->coveredY1 = maxY + 1;
+
+    int dx = x1 - x0;
+    int dy = y1 - y0;
+    int lengthSquared = dx * dx + dy * dy;
+    int radiusSquared = radius * radius;
+
+    for (int y = minY; y <= maxY; y++) {
+        uint64_t* row = stroke->coverage + (size_t)y * stroke->wordsPerRow;
+        for (int x = minX; x <= maxX; x++) {
+            uint64_t bit = (uint64_t)1 << (x & 63);
+            if (row[x >> 6] & bit) continue;
+
+            // Distance from the cell to the closest point of the segment
+            float t = 0.0f;
+            if (lengthSquared > 0) {
+                t = (float)((x - x0) * dx + (y - y0) * dy) / lengthSquared;
+                if (t < 0.0f) t = 0.0f;
+                if (t > 1.0f) t = 1.0f;
+            }
+            float ex = x - (x0 + t * dx);
+            float ey = y - (y0 + t * dy);
+            if (ex * ex + ey * ey > radiusSquared) continue;
+
+            row[x >> 6] |= bit;
+            QueueCell(stroke, x, y);
+        }
+    }
+}
+
+void BeginBrushStroke(BrushStroke* stroke, int cellType, int radius, int x, int y) {
+    if (!stroke->coverage) return;
+
+    // Only the rows the previous stroke touched hold coverage bits
+    if (stroke->coveredY1 > stroke->coveredY0) {
+        memset(stroke->coverage + (size_t)stroke->coveredY0 * stroke->wordsPerRow, 0,
+               (size_t)(stroke->coveredY1 - stroke->coveredY0) * stroke->wordsPerRow * sizeof(uint64_t));
+    }
+    stroke->coveredY0 = stroke->height;
+    stroke->coveredY1 = 0;
+
+    stroke->active = true;
+    stroke->cellType = cellType;
+    stroke->radius = radius;
+    stroke->lastX = x;
+    stroke->lastY = y;
+    SweepSegment(stroke, radius, x, y, x, y);
+}
+
+void ContinueBrushStroke(BrushStroke* stroke, int radius, int x, int y) {
+    if (!stroke->active) return;
+
+    // A resting cursor covers nothing new unless the brush grew
+    if (x == stroke->lastX && y == stroke->lastY && radius <= stroke->radius) return;
+
+    SweepSegment(stroke, radius, stroke->lastX, stroke->lastY, x, y);
+    stroke->radius = radius;
+    stroke->lastX = x;
+    stroke->lastY = y;
+}
+
+void EndBrushStroke(BrushStroke* stroke) {
+    stroke->active = false;
+}
+
+int ApplyBrushStroke(BrushStroke* stroke, World* world) {
+    int count = stroke->pendingCount;
+    stroke->lastApplied = count;
+    if (count == 0) return 0;
+    stroke->pendingCount = 0;
+
+    // The grid may have been replaced since the stroke began
+    if (world->width != stroke->width || world->height != stroke->height) return 0;
+
+    for (int i = 0; i < count; i++) {
+        int index = stroke->pending[i];
+        PlaceCell(world, index % stroke->width, index / stroke->width, stroke->cellType);
+    }
+
+    // One wake for the whole batch instead of one per cell
+    WakeFluidRect(world, stroke->pendingX0 - 1, stroke->pendingY0 - 1, stroke->pendingX1 + 1, stroke->pendingY1 + 1);
+    return count;
+}
@@ -0,0 +1,52 @@
+#ifndef BRUSH_STROKE_H
+#define BRUSH_STROKE_H
+
+#include "grid.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+// A held mouse button paints one stroke. The segment between the last and the
+// current cursor cell is swept with the brush, and a coverage bitmap makes sure
+// each cell is stamped only once per stroke. Stamps are queued and placed in one
+// batch per frame, so painting costs only the newly covered cells.
+typedef struct {
+    uint64_t* coverage;   // one bit per cell stamped during the current stroke, row-major
+    int width;
+    int height;
+    int wordsPerRow;
+
+    bool active;
+    int cellType;
+    int radius;           // brush radius of the last sweep
+    int lastX;            // cursor cell of the previous frame
+    int lastY;
+    int coveredY0;        // rows holding coverage bits, cleared when the next stroke begins
+    int coveredY1;
+
+    int* pending;         // cell indices queued for the next ApplyBrushStroke
+    int pendingCount;
+    int pendingCapacity;
+    int pendingX0;        // bounding box of the queued cells, [x0, x1) x [y0, y1)
+    int pendingY0;
+    int pendingX1;
+    int pendingY1;
+
+    int lastApplied;      // cells placed by the last ApplyBrushStroke
+} BrushStroke;
+
+bool InitBrushStroke(BrushStroke* stroke, int width, int height);
+void CleanupBrushStroke(BrushStroke* stroke);
+
+// Start a stroke at a cell, forgetting the coverage of the previous one
+void BeginBrushStroke(BrushStroke* stroke, int cellType, int radius, int x, int y);
+
+// Sweep the brush from the last cursor cell to (x, y)
+void ContinueBrushStroke(BrushStroke* stroke, int radius, int x, int y);
+
+void EndBrushStroke(BrushStroke* stroke);
+
+// Place every queued cell and wake the fluid solver around them once.
+// Returns the number of cells placed.
+int ApplyBrushStroke(BrushStroke* stroke, World* world);
+
+#endif // BRUSH_STROKE_H
@@ -2,221 +2,221 @@
 #include "grid.h"
 #include "cell_types.h"
 #include "cell_defaults.h"  // Add this include
+#include "fluid.h"
+#include "telemetry.h"
+#include "organisms.h"
+#include "dirty_tiles.h"
+#include "palette.h"
 #include <stdio.h>
 
 // Place soil at the given position
-void PlaceSoil(Vector2 position) {
+void PlaceSoil(World* world, Vector2 position) {
     int x = (int)position.x;
     int y = (int)position.y;
     
     // Ensure position is within grid bounds
-    if(x < 0 || x >= GRID_WIDTH || y < 0 || y >= GRID_HEIGHT) return;
+    if(x < 0 || x >= world->width || y < 0 || y >= world->height) return;
     
     // Initialize with defaults first
-    InitializeCellDefaults(&grid[y][x], CELL_TYPE_SOIL);
-    grid[y][x].position = (Vector2){x * CELL_SIZE, y * CELL_SIZE};
+    InitializeCellDefaults(GetCell(world, x, y), CELL_TYPE_SOIL);
+    MarkCellDirty(world, x, y);
 }
 
 // Place water at the given position
-void PlaceWater(Vector2 position) {
+void PlaceWater(World* world, Vector2 position) {
     int x = (int)position.x;
     int y = (int)position.y;
     
     // Ensure position is within grid bounds
-    if(x < 0 || x >= GRID_WIDTH || y < 0 || y >= GRID_HEIGHT) return;
+    if(x < 0 || x >= world->width || y < 0 || y >= world->height) return;
     
     // Initialize with defaults first
-    InitializeCellDefaults(&grid[y][x], CELL_TYPE_WATER);
+    InitializeCellDefaults(GetCell(world, x, y), CELL_TYPE_WATER);
     // Give newly placed water a random moisture level between 700 and 1000
-    grid[y][x].moisture = 700 + GetRandomValue(0, 300);
-    grid[y][x].position = (Vector2){x * CELL_SIZE, y * CELL_SIZE};
-    
-    // Update color based on moisture
-    float intensityPct = (float)grid[y][x].moisture / 1000.0f;
-    grid[y][x].baseColor = (Color){
-        0 + (int)(200 * (1.0f - intensityPct)),
-        120 + (int)(135 * (1.0f - intensityPct)),
-        255,
-        255
-    };
+    GetCell(world, x, y)->moisture = 700 + CellRandom(world, x, y, RANDOM_PLACE_MOISTURE, 0, 300);
+    MarkCellDirty(world, x, y);
 }
 
 // Place rock at the given position
-void PlaceRock(Vector2 position) {
+void PlaceRock(World* world, Vector2 position) {
     int x = (int)position.x;
     int y = (int)position.y;
     
     // Ensure position is within grid bounds
-    if(x < 0 || x >= GRID_WIDTH || y < 0 || y >= GRID_HEIGHT) return;
+    if(x < 0 || x >= world->width || y < 0 || y >= world->height) return;
     
     // Initialize with defaults first
-    InitializeCellDefaults(&grid[y][x], CELL_TYPE_ROCK);
-    grid[y][x].position = (Vector2){x * CELL_SIZE, y * CELL_SIZE};
+    InitializeCellDefaults(GetCell(world, x, y), CELL_TYPE_ROCK);
+    MarkCellDirty(world, x, y);
     
     // Rocks can have slight color variation
-    int variation = GetRandomValue(-15, 15);
-    grid[y][x].baseColor = (Color){
-        128 + variation,  // Base gray with variation
-        128 + variation,
-        128 + variation,
-        255
-    };
+    GetCell(world, x, y)->variation = RandomColorVariation(world, x, y);
+}
+
+// Random color variation seed for a new cell (see palette.h)
+unsigned char RandomColorVariation(const World* world, int x, int y) {
+    return (unsigned char)CellRandom(world, x, y, RANDOM_PLACE_VARIATION, 0, PALETTE_VARIATIONS - 1);
 }
 
 // Place plant at the given position
-void PlacePlant(Vector2 position) {
+void PlacePlant(World* world, Vector2 position) {
     int x = (int)position.x;
     int y = (int)position.y;
     
-    // Ensure position is within grid bounds
-    if(x < 0 || x >= GRID_WIDTH || y < 0 || y >= GRID_HEIGHT) return;
+    // Ensure position is inside the border, organisms look at all four neighbours
+    if(x < 1 || x >= world->width - 1 || y < 1 || y >= world->height - 1) return;
     
     // Only allow plants to grow on soil
-    if(grid[y][x].type != CELL_TYPE_SOIL && grid[y][x].type != CELL_TYPE_AIR) {
+    if(GetCell(world, x, y)->type != CELL_TYPE_SOIL && GetCell(world, x, y)->type != CELL_TYPE_AIR) {
         return;
     }
     
     // Initialize with defaults first
-    InitializeCellDefaults(&grid[y][x], CELL_TYPE_PLANT);
-    grid[y][x].position = (Vector2){x * CELL_SIZE, y * CELL_SIZE};
+    InitializeCellDefaults(GetCell(world, x, y), CELL_TYPE_PLANT);
+    MarkCellDirty(world, x, y);
     
     // Add some color variation to plants
-    int greenVariation = GetRandomValue(-20, 20);
-    grid[y][x].baseColor = (Color){
-        20 + GetRandomValue(0, 30),         // Small amount of red
-        150 + greenVariation,               // Varied green
-        40 + GetRandomValue(-20, 20),       // Small amount of blue
-        255
-    };
+    GetCell(world, x, y)->variation = RandomColorVariation(world, x, y);
     
     // Start with some energy for growth
-    grid[y][x].Energy = 5 + GetRandomValue(0, 5);
+    GetCell(world, x, y)->Energy = 5 + CellRandom(world, x, y, RANDOM_PLACE_ENERGY, 0, 5);
     
-    // Initialize age (starts at 0)
-    grid[y][x].age = 0;
+    // Age is measured from the tick the plant was placed
+    GetCell(world, x, y)->birthTick = world->tick;
     
     // Plants start with moderate moisture needs
-    grid[y][x].moisture = 50 + GetRandomValue(-10, 10);
+    GetCell(world, x, y)->moisture = 50 + CellRandom(world, x, y, RANDOM_PLACE_MOISTURE, -10, 10);
     
-    // Set a unique ID if tracking plants individually
-    static int nextPlantID = 1;
-    grid[y][x].objectID = nextPlantID++;
+    // Join a neighbouring plant or start a new one in the organism table
+    AddOrganismCell(world, x, y);
 }
 
 // Place moss at the given position
-void PlaceMoss(Vector2 position) {
+void PlaceMoss(World* world, Vector2 position) {
     int x = (int)position.x;
     int y = (int)position.y;
     
-    // Ensure position is within grid bounds
-    if(x < 0 || x >= GRID_WIDTH || y < 0 || y >= GRID_HEIGHT) return;
+    // Ensure position is inside the border, organisms look at all four neighbours
+    if(x < 1 || x >= world->width - 1 || y < 1 || y >= world->height - 1) return;
     
     // Initialize with defaults first
-    InitializeCellDefaults(&grid[y][x], CELL_TYPE_MOSS);
-    grid[y][x].position = (Vector2){x * CELL_SIZE, y * CELL_SIZE};
+    InitializeCellDefaults(GetCell(world, x, y), CELL_TYPE_MOSS);
+    MarkCellDirty(world, x, y);
     
     // Moss has a darker green shade with some variation
-    int greenVariation = GetRandomValue(-10, 10);
-    grid[y][x].baseColor = (Color){
-        10 + GetRandomValue(0, 10),        // Almost no red
-        80 + greenVariation,               // Dark green with variation
-        30 + GetRandomValue(-10, 10),      // Small amount of blue
-        255
-    };
+    GetCell(world, x, y)->variation = RandomColorVariation(world, x, y);
     
     // Moss starts with less energy than plants
-    grid[y][x].Energy = 3 + GetRandomValue(0, 3);
+    GetCell(world, x, y)->Energy = 3 + CellRandom(world, x, y, RANDOM_PLACE_ENERGY, 0, 3);
     
-    // Initialize age (starts at 0)
-    grid[y][x].age = 0;
+    // Age is measured from the tick the moss was placed
+    GetCell(world, x, y)->birthTick = world->tick;
     
     // Moss prefers higher moisture
-    grid[y][x].moisture = 70 + GetRandomValue(-5, 15);
+    GetCell(world, x, y)->moisture = 70 + CellRandom(world, x, y, RANDOM_PLACE_MOISTURE, -5, 15);
+    
+    // Join a neighbouring colony or start a new one in the organism table
+    AddOrganismCell(world, x, y);
 }
 
 // Place air at the given position
-void PlaceAir(Vector2 position) {
+void PlaceAir(World* world, Vector2 position) {
     int x = (int)position.x;
     int y = (int)position.y;
     
     // Ensure position is within grid bounds
-    if(x < 0 || x >= GRID_WIDTH || y < 0 || y >= GRID_HEIGHT) return;
+    if(x < 0 || x >= world->width || y < 0 || y >= world->height) return;
     
     // Initialize with defaults first
-    InitializeCellDefaults(&grid[y][x], CELL_TYPE_AIR);
-    grid[y][x].position = (Vector2){x * CELL_SIZE, y * CELL_SIZE};
+    InitializeCellDefaults(GetCell(world, x, y), CELL_TYPE_AIR);
+    MarkCellDirty(world, x, y);
     
     // Air can have slight moisture variation
-    grid[y][x].moisture = GetRandomValue(5, 15);
-    
-    // Update color based on moisture (invisible until high moisture)
-    if (grid[y][x].moisture > 75) {
-        int brightness = (grid[y][x].moisture - 75) * (255 / 25);
-        grid[y][x].baseColor = (Color){brightness, brightness, brightness, 255};
-    } else {
-        grid[y][x].baseColor = BLACK;  // Invisible air
-    }
+    GetCell(world, x, y)->moisture = CellRandom(world, x, y, RANDOM_PLACE_MOISTURE, 5, 15);
 }
 
-// Move cell function - swaps properties but not position of two cells
-void MoveCell(int x1, int y1, int x2, int y2) {
+// Move cell function - swaps the contents of two cells
+void MoveCell(World* world, int x1, int y1, int x2, int y2) {
     // Bounds checking to prevent memory corruption
-    if (x1 < 0 || x1 >= GRID_WIDTH || y1 < 0 || y1 >= GRID_HEIGHT ||
-        x2 < 0 || x2 >= GRID_WIDTH || y2 < 0 || y2 >= GRID_HEIGHT) {
+    if (x1 < 0 || x1 >= world->width || y1 < 0 || y1 >= world->height ||
+        x2 < 0 || x2 >= world->width || y2 < 0 || y2 >= world->height) {
         return;  // Skip if out of bounds
     }
     
     // Prevent swapping with border tiles
-    if ((x1 == 0 || x1 == GRID_WIDTH - 1 || y1 == 0 || y1 == GRID_HEIGHT - 1) ||
-        (x2 == 0 || x2 == GRID_WIDTH - 1 || y2 == 0 || y2 == GRID_HEIGHT - 1)) {
+    if ((x1 == 0 || x1 == world->width - 1 || y1 == 0 || y1 == world->height - 1) ||
+        (x2 == 0 || x2 == world->width - 1 || y2 == 0 || y2 == world->height - 1)) {
         return; // Skip if either cell is a border tile
     }
     
     // Swap cells
-    GridCell temp = grid[y1][x1];
-    grid[y1][x1] = grid[y2][x2];
-    grid[y2][x2] = temp;
-    
-    // Update position properties to match new grid locations
-  //  grid[y1][x1].position = (Vector2){x1 * CELL_SIZE, y1 * CELL_SIZE};
-  //  grid[y2][x2].position = (Vector2){x2 * CELL_SIZE, y2 * CELL_SIZE};
+    GridCell* a = GetCell(world, x1, y1);
+    GridCell* b = GetCell(world, x2, y2);
+    GridCell temp = *a;
+    *a = *b;
+    *b = temp;
+    CountActiveCells(world, 2);
+    MarkCellDirty(world, x1, y1);
+    MarkCellDirty(world, x2, y2);
+
+    // Organisms track where their cells are
+    if (a->objectID) {
+        OrganismCellMoved(world, a->objectID, x2, y2, x1, y1);
+    }
+    if (b->objectID) {
+        OrganismCellMoved(world, b->objectID, x1, y1, x2, y2);
+    }
+
+    // Moving water disturbs the pressure solver around both cells
+    if (a->type == CELL_TYPE_WATER || b->type == CELL_TYPE_WATER) {
+        WakeFluidAt(world, x1, y1);
+        WakeFluidAt(world, x2, y2);
+    }
+}
+
+// Place a single cell of the given type
+void PlaceCell(World* world, int x, int y, int cellType) {
+    switch(cellType) {
+        case CELL_TYPE_SOIL:
+            PlaceSoil(world, (Vector2){x, y});
+            break;
+        case CELL_TYPE_WATER:
+            PlaceWater(world, (Vector2){x, y});
+            break;
+        case CELL_TYPE_PLANT:
+            PlacePlant(world, (Vector2){x, y});
+            break;
+        case CELL_TYPE_ROCK:
+            PlaceRock(world, (Vector2){x, y});
+            break;
+        case CELL_TYPE_MOSS:
+            PlaceMoss(world, (Vector2){x, y});
+            break;
+        case CELL_TYPE_AIR:
+            PlaceAir(world, (Vector2){x, y});
+            break;
+    }
 }
 
 // Place cells in a circular pattern
-void PlaceCircularPattern(int centerX, int centerY, int cellType, int radius) {
+void PlaceCircularPattern(World* world, int centerX, int centerY, int cellType, int radius) {
     for(int y = centerY - radius; y <= centerY + radius; y++) {
         for(int x = centerX - radius; x <= centerX + radius; x++) {
             // Skip border cells
-            if (x == 0 || x == GRID_WIDTH - 1 || y == 0 || y == GRID_HEIGHT - 1) {
+            if (x == 0 || x == world->width - 1 || y == 0 || y == world->height - 1) {
                 continue;
             }
 
             float distanceSquared = (x - centerX) * (x - centerX) + (y - centerY) * (y - centerY);
 
-            if(distanceSquared <= radius * radius && x >= 0 && x < GRID_WIDTH && y >= 0 && y < GRID_HEIGHT) {
-                switch(cellType) {
-                    case CELL_TYPE_SOIL:
-                        PlaceSoil((Vector2){x, y});
-                        break;
-                    case CELL_TYPE_WATER:
-                        PlaceWater((Vector2){x, y});
-                        break;
-                    case CELL_TYPE_PLANT:
-                        PlacePlant((Vector2){x, y});
-                        break;
-                    case CELL_TYPE_ROCK:
-                        PlaceRock((Vector2){x, y});
-                        break;
-                    case CELL_TYPE_MOSS:
-                        PlaceMoss((Vector2){x, y});
-                        break;
-                    case CELL_TYPE_AIR:
-                        PlaceAir((Vector2){x, y});
-                        break;
-                }
+            if(distanceSquared <= radius * radius && x >= 0 && x < world->width && y >= 0 && y < world->height) {
+                PlaceCell(world, x, y, cellType);
             }
         }
     }
+
+    // Wake the solver around the whole pattern at once
+    WakeFluidRect(world, centerX - radius - 1, centerY - radius - 1, centerX + radius + 2, centerY + radius + 2);
 }
 
 // Function to absorb moisture from one cell to another
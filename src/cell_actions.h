@@ -2,30 +2,37 @@
 #define CELL_ACTIONS_H
 
 #include "raylib.h"
+#include "grid.h"
+
+// Random color variation seed for new rock, plant and moss cells
+unsigned char RandomColorVariation(const World* world, int x, int y);
 
 // Function to place soil
-void PlaceSoil(Vector2 position);
+void PlaceSoil(World* world, Vector2 position);
 
 // Function to place water
-void PlaceWater(Vector2 position);
+void PlaceWater(World* world, Vector2 position);
 
 // Function to place plant
-void PlacePlant(Vector2 position);
+void PlacePlant(World* world, Vector2 position);
 
 // Function to place rock
-void PlaceRock(Vector2 position);
+void PlaceRock(World* world, Vector2 position);
 
 // Function to place moss
-void PlaceMoss(Vector2 position);
+void PlaceMoss(World* world, Vector2 position);
 
 // Function to place air
-void PlaceAir(Vector2 position);
+void PlaceAir(World* world, Vector2 position);
+
+// Function to place a single cell of any type (does not wake the fluid solver)
+void PlaceCell(World* world, int x, int y, int cellType);
 
 // Function to place cells in a circular pattern
-void PlaceCircularPattern(int centerX, int centerY, int cellType, int radius);
+void PlaceCircularPattern(World* world, int centerX, int centerY, int cellType, int radius);
 
 // Function to move a cell from one position to another
-void MoveCell(int x1, int y1, int x2, int y2);
+void MoveCell(World* world, int x1, int y1, int x2, int y2);
 
 
 #endif // CELL_ACTIONS_H
@@ -0,0 +1,170 @@
+#include "cell_rules.h"
+#include "grid.h"
+#include "cell_actions.h"
+#include "update_water.h"
+#include "chunk_summary.h"
+#include "sim_lod.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <limits.h>
+
+// A compiled action is packed into 16 bits:
+// bits 0-3 move slot, bits 4-7 alternative slot, bits 8-14 chance, bit 15 falls.
+// Chances above 100 refer to a tunable parameter (CHANCE_PARAM_BASE + RULE_CHANCE_*).
+#define CHANCE_PARAM_BASE 100
+#define ACTION_NONE ((uint16_t)(NB_NONE | (NB_NONE << 4)))
+#define KERNEL_SIZE (1 << (2 * NB_COUNT))
+
+// Material rule tables, indexed by cell type. Adding a material only needs a row here.
+typedef struct {
+    int cellType;
+    const CellRule* rules;
+    const int* count;
+} MaterialRules;
+
+static const MaterialRules materialRules[] = {
+    { CELL_TYPE_WATER, waterRules, &waterRuleCount },
+};
+
+// Neighbour offsets for each slot
+static const int nbDx[NB_COUNT] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+static const int nbDy[NB_COUNT] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+
+// Neighbour class of each cell type, indexed by type + 1 so the border maps to slot 0
+static const uint8_t typeClass[CELL_TYPE_MOSS + 2] = {
+    RULE_CLASS_FIXED,   // border
+    RULE_CLASS_EMPTY,   // air
+    RULE_CLASS_SOLID,   // soil
+    RULE_CLASS_LIQUID,  // water
+    RULE_CLASS_SOLID,   // plant
+    RULE_CLASS_SOLID,   // rock
+    RULE_CLASS_SOLID,   // moss
+};
+
+// Compiled lookup kernels, one per cell type (NULL when the type has no rules)
+static uint16_t* ruleKernels[CELL_TYPE_MOSS + 1] = { NULL };
+
+#define CLASS_OF(cell) (typeClass[(cell).type + 1])
+
+// Pack the classes of the 8 neighbours of (x, y) into a 16-bit code
+static inline int PackNeighbourhood(const World* world, int x, int y) {
+    const GridCell* cells = world->cells;
+    int up = world->rowOffset[y - 1];
+    int row = world->rowOffset[y];
+    int down = world->rowOffset[y + 1];
+    int left = world->colOffset[x - 1];
+    int centre = world->colOffset[x];
+    int right = world->colOffset[x + 1];
+
+    return CLASS_OF(cells[up + left]) |
+           CLASS_OF(cells[up + centre]) << 2 |
+           CLASS_OF(cells[up + right]) << 4 |
+           CLASS_OF(cells[row + left]) << 6 |
+           CLASS_OF(cells[row + right]) << 8 |
+           CLASS_OF(cells[down + left]) << 10 |
+           CLASS_OF(cells[down + centre]) << 12 |
+           CLASS_OF(cells[down + right]) << 14;
+}
+
+// Find the first rule matching a neighbourhood code and encode its action
+static uint16_t CompileAction(const CellRule* rules, int count, int code) {
+    for (int r = 0; r < count; r++) {
+        bool matches = true;
+        for (int slot = 0; slot < NB_COUNT && matches; slot++) {
+            int cls = (code >> (2 * slot)) & 3;
+            if (rules[r].match[slot] != 0 && !(rules[r].match[slot] & (1 << cls))) {
+                matches = false;
+            }
+        }
+
+        if (matches) {
+            int chance = rules[r].chanceParam ? CHANCE_PARAM_BASE + rules[r].chanceParam : rules[r].chance;
+            return (uint16_t)((rules[r].move & 0xF) |
+                              (rules[r].alt & 0xF) << 4 |
+                              (chance & 0x7F) << 8 |
+                              (rules[r].falls ? 1 : 0) << 15);
+        }
+    }
+    return ACTION_NONE;
+}
+
+// Compile every material's rule table into a lookup kernel indexed by neighbourhood code
+void CompileCellRules(void) {
+    for (size_t m = 0; m < sizeof(materialRules) / sizeof(materialRules[0]); m++) {
+        int cellType = materialRules[m].cellType;
+        if (ruleKernels[cellType]) continue; // Already compiled
+
+        uint16_t* kernel = (uint16_t*)malloc(KERNEL_SIZE * sizeof(uint16_t));
+        if (!kernel) {
+            printf("ERROR: Failed to allocate rule kernel for cell type %d\n", cellType);
+            continue;
+        }
+
+        for (int code = 0; code < KERNEL_SIZE; code++) {
+            kernel[code] = CompileAction(materialRules[m].rules, *materialRules[m].count, code);
+        }
+        ruleKernels[cellType] = kernel;
+    }
+}
+
+// Resolve the chance stored in a compiled action against the world's parameters
+static int ActionChance(const SimParams* params, uint16_t action) {
+    int chance = (action >> 8) & 0x7F;
+    switch (chance - CHANCE_PARAM_BASE) {
+        case RULE_CHANCE_WATER_DIAGONAL: return params->waterDiagonalChance;
+        case RULE_CHANCE_WATER_SPREAD: return params->waterSpreadChance;
+    }
+    return chance;
+}
+
+// Apply the compiled rules of a cell type to every interior cell
+void ApplyCellRules(World* world, int cellType) {
+    const uint16_t* kernel = ruleKernels[cellType];
+    if (!kernel) return;
+
+    int width = world->width;
+    int height = world->height;
+
+    bool processRightToLeft = CellRandom(world, 0, 0, RANDOM_WATER_SCAN, 0, 1);
+    int startX = processRightToLeft ? width - 2 : 1;
+    int endX = processRightToLeft ? 0 : width - 1;
+    int stepX = processRightToLeft ? -1 : 1;
+
+    // Tiles without the material are stepped over, unless a move reached them,
+    // and so are tiles not due this tick
+    RefreshChunkSummaries(world);
+
+    for (int y = height - 2; y >= 1; y--) {
+        for (int x = startX; x != endX; x += stepX) {
+            if ((x == startX || (x & (DIRTY_TILE_SIZE - 1)) == ((stepX > 0) ? 0 : DIRTY_TILE_SIZE - 1)) &&
+                (!TileIsDue(world, x, y) || TileLacks(world, x, y, cellType, INT_MIN))) {
+                x = TileScanEnd(x, stepX, endX);
+                continue;
+            }
+            if (GetCell(world, x, y)->type != cellType) continue;
+
+            uint16_t action = kernel[PackNeighbourhood(world, x, y)];
+            int slot = action & 0xF;
+            int alt = (action >> 4) & 0xF;
+
+            // Random choice between two candidate moves
+            if (alt != NB_NONE && CellRandom(world, x, y, RANDOM_WATER_CHOICE, 0, 100) >= ActionChance(&world->params, action)) {
+                slot = alt;
+            }
+
+            bool hasMoved = false;
+            GetCell(world, x, y)->is_falling = false;
+            if (slot != NB_NONE) {
+                MoveCell(world, x, y, x + nbDx[slot], y + nbDy[slot]);
+                hasMoved = (action >> 15) & 1;
+            }
+
+            // Prevent cells next to the border from being flagged as falling
+            if (x == 1 || x == width - 2 || y == 1 || y == height - 2) {
+                hasMoved = false;
+            }
+
+            GetCell(world, x, y)->is_falling = hasMoved;
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef CELL_RULES_H
+#define CELL_RULES_H
+
+#include "grid.h"
+#include <stdint.h>
+
+// Neighbour classes - every cell type maps to one of these 2-bit codes
+#define RULE_CLASS_EMPTY 0  // air, free space a cell can move into
+#define RULE_CLASS_LIQUID 1 // water
+#define RULE_CLASS_SOLID 2  // soil, plant, rock, moss
+#define RULE_CLASS_FIXED 3  // immutable border
+
+// Masks used in rule patterns (0 = don't care)
+#define RULE_EMPTY (1 << RULE_CLASS_EMPTY)
+#define RULE_LIQUID (1 << RULE_CLASS_LIQUID)
+#define RULE_SOLID (1 << RULE_CLASS_SOLID)
+#define RULE_FIXED (1 << RULE_CLASS_FIXED)
+
+// Neighbour slots of the 3x3 window, in packed code order (2 bits each)
+enum {
+    NB_UP_LEFT, NB_UP, NB_UP_RIGHT,
+    NB_LEFT, NB_RIGHT,
+    NB_DOWN_LEFT, NB_DOWN, NB_DOWN_RIGHT,
+    NB_COUNT,
+    NB_NONE = 0xF
+};
+
+// A single rule: if every neighbour matches its mask, swap with the 'move' neighbour.
+// When 'alt' is set, 'move' is taken with 'chance'% probability and 'alt' otherwise.
+// A non-zero 'chanceParam' (RULE_CHANCE_*) takes the chance from the world's SimParams instead.
+typedef struct {
+    uint8_t match[NB_COUNT];
+    uint8_t move;
+    uint8_t alt;
+    uint8_t chance;
+    uint8_t chanceParam;
+    bool falls;     // a successful move marks the cell as falling
+} CellRule;
+
+// Compile every material's rule table into its lookup kernel (safe to call more than once)
+void CompileCellRules(void);
+
+// Apply the compiled rules of a cell type to every interior cell, bottom to top
+void ApplyCellRules(World* world, int cellType);
+
+#endif // CELL_RULES_H
@@ -0,0 +1,123 @@
+#include "chunk_summary.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <float.h>
+#include <limits.h>
+
+struct ChunkSummaries {
+    int tilesX;
+    int tilesY;
+    uint32_t epoch;             // tile epoch the summaries are up to date with
+    MaterialSummary* tiles;     // CHUNK_MATERIALS entries per tile
+};
+
+static const MaterialSummary emptySummary = { 0, INT_MIN, FLT_MAX, -FLT_MAX };
+static const MaterialSummary unknownSummary = { INT_MAX, INT_MAX, -FLT_MAX, FLT_MAX };
+
+bool InitChunkSummaries(World* world) {
+    CleanupChunkSummaries(world);
+
+    ChunkSummaries* summaries = (ChunkSummaries*)calloc(1, sizeof(ChunkSummaries));
+    if (!summaries) {
+        printf("ERROR: Failed to allocate chunk summaries\n");
+        return false;
+    }
+    summaries->tilesX = (world->width + DIRTY_TILE_SIZE - 1) / DIRTY_TILE_SIZE;
+    summaries->tilesY = (world->height + DIRTY_TILE_SIZE - 1) / DIRTY_TILE_SIZE;
+    summaries->tiles = (MaterialSummary*)malloc((size_t)summaries->tilesX * summaries->tilesY *
+                                                CHUNK_MATERIALS * sizeof(MaterialSummary));
+    if (!summaries->tiles) {
+        printf("ERROR: Failed to allocate chunk summaries\n");
+        free(summaries);
+        return false;
+    }
+
+    // Epoch 0 is older than every tile, so the first refresh builds everything
+    summaries->epoch = 0;
+    world->summaries = summaries;
+    return true;
+}
+
+void CleanupChunkSummaries(World* world) {
+    ChunkSummaries* summaries = world->summaries;
+    if (!summaries) return;
+
+    free(summaries->tiles);
+    free(summaries);
+    world->summaries = NULL;
+}
+
+static void BuildTileSummary(ChunkSummaries* summaries, const World* world, int tx, int ty) {
+    MaterialSummary* tile = summaries->tiles + ((size_t)ty * summaries->tilesX + tx) * CHUNK_MATERIALS;
+    for (int m = 0; m < CHUNK_MATERIALS; m++) {
+        tile[m] = emptySummary;
+    }
+
+    int x0 = tx * DIRTY_TILE_SIZE;
+    int y0 = ty * DIRTY_TILE_SIZE;
+    int x1 = (x0 + DIRTY_TILE_SIZE < world->width) ? x0 + DIRTY_TILE_SIZE : world->width;
+    int y1 = (y0 + DIRTY_TILE_SIZE < world->height) ? y0 + DIRTY_TILE_SIZE : world->height;
+    for (int y = y0; y < y1; y++) {
+        int temperature = GetRowTemperature(world, y);
+        for (int x = x0; x < x1; x++) {
+            const GridCell* cell = GetCell(world, x, y);
+            if (cell->type < 0 || cell->type >= CHUNK_MATERIALS) continue;
+
+            MaterialSummary* s = &tile[cell->type];
+            s->count++;
+            if (cell->moisture > s->maxMoisture) s->maxMoisture = cell->moisture;
+            if (temperature < s->minTemperature) s->minTemperature = temperature;
+            if (temperature > s->maxTemperature) s->maxTemperature = temperature;
+        }
+    }
+}
+
+void RefreshChunkSummaries(World* world) {
+    ChunkSummaries* summaries = world->summaries;
+    if (!summaries) return;
+
+    uint32_t epoch = AdvanceTileEpoch(world);
+    for (int ty = 0; ty < summaries->tilesY; ty++) {
+        for (int tx = 0; tx < summaries->tilesX; tx++) {
+            if (TileChangedSince(world, ty * summaries->tilesX + tx, summaries->epoch)) {
+                BuildTileSummary(summaries, world, tx, ty);
+            }
+        }
+    }
+    summaries->epoch = epoch;
+}
+
+MaterialSummary SummarizeMaterial(const World* world, int material, int x0, int y0, int x1, int y1) {
+    const ChunkSummaries* summaries = world->summaries;
+    if (!summaries || material < 0 || material >= CHUNK_MATERIALS) return unknownSummary;
+
+    MaterialSummary result = emptySummary;
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > world->width) x1 = world->width;
+    if (y1 > world->height) y1 = world->height;
+    if (x0 >= x1 || y0 >= y1) return result;
+
+    for (int ty = y0 >> DIRTY_TILE_SHIFT; ty <= (y1 - 1) >> DIRTY_TILE_SHIFT; ty++) {
+        for (int tx = x0 >> DIRTY_TILE_SHIFT; tx <= (x1 - 1) >> DIRTY_TILE_SHIFT; tx++) {
+            const MaterialSummary* s = &summaries->tiles[((size_t)ty * summaries->tilesX + tx) * CHUNK_MATERIALS + material];
+            if (s->count == 0) continue;
+            result.count += s->count;
+            if (s->maxMoisture > result.maxMoisture) result.maxMoisture = s->maxMoisture;
+            if (s->minTemperature < result.minTemperature) result.minTemperature = s->minTemperature;
+            if (s->maxTemperature > result.maxTemperature) result.maxTemperature = s->maxTemperature;
+        }
+    }
+    return result;
+}
+
+bool TileLacks(const World* world, int x, int y, int material, int minMoisture) {
+    const ChunkSummaries* summaries = world->summaries;
+    if (!summaries || !world->dirty) return false;
+
+    int tile = (y >> DIRTY_TILE_SHIFT) * summaries->tilesX + (x >> DIRTY_TILE_SHIFT);
+    if (TileChangedSince(world, tile, summaries->epoch)) return false;
+
+    const MaterialSummary* s = &summaries->tiles[(size_t)tile * CHUNK_MATERIALS + material];
+    return s->count == 0 || s->maxMoisture < minMoisture;
+}
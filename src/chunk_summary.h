@@ -0,0 +1,51 @@
+#ifndef CHUNK_SUMMARY_H
+#define CHUNK_SUMMARY_H
+
+#include "grid.h"
+#include "dirty_tiles.h"
+
+// Per-tile bounds of each material's temperature and moisture, so threshold
+// checks (evaporation, condensation) can reject whole tiles in which no cell
+// can cross the threshold. Tiles are the dirty tiles (DIRTY_TILE_SIZE square);
+// RefreshChunkSummaries rebuilds the ones that changed since its last call.
+//
+// The summaries also let passes step over tiles that hold nothing they act on,
+// such as plain air or solid rock, in O(1) (see TileLacks). Such a tile becomes
+// visited again as soon as anything writes to it, and skippable again at the
+// next refresh once it is back to holding nothing of interest.
+#define CHUNK_MATERIALS (CELL_TYPE_MOSS + 1)
+
+typedef struct ChunkSummaries ChunkSummaries;
+
+typedef struct {
+    int count;              // cells of the material, 0 when there are none
+    int maxMoisture;
+    float minTemperature;
+    float maxTemperature;
+} MaterialSummary;
+
+// Allocate the world's summaries (called from InitWorld; copies made with
+// CloneWorld have none, and every check then assumes the worst)
+bool InitChunkSummaries(World* world);
+void CleanupChunkSummaries(World* world);
+
+// Rebuild the summaries of tiles changed since the last refresh
+void RefreshChunkSummaries(World* world);
+
+// Bounds for one material over the tiles overlapping [x0, x1) x [y0, y1).
+// Without summaries the bounds admit anything.
+MaterialSummary SummarizeMaterial(const World* world, int material, int x0, int y0, int x1, int y1);
+
+// True when the tile containing (x, y) held no cell of the material with at least
+// minMoisture moisture at the last refresh and has not been written to since.
+// Without summaries every tile may hold anything.
+bool TileLacks(const World* world, int x, int y, int material, int minMoisture);
+
+// Last x of the tile containing x when scanning a row in steps of 'step' (1 or
+// -1) towards 'end' (exclusive), so that x += step then leaves the tile
+static inline int TileScanEnd(int x, int step, int end) {
+    int last = (step > 0) ? (x | (DIRTY_TILE_SIZE - 1)) : (x & ~(DIRTY_TILE_SIZE - 1));
+    return ((last - end) * step >= 0) ? end - step : last;
+}
+
+#endif // CHUNK_SUMMARY_H
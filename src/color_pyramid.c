@@ -0,0 +1,145 @@
+#include "color_pyramid.h"
+#include "palette.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+bool InitColorPyramid(ColorPyramid* pyramid, int width, int height) {
+    *pyramid = (ColorPyramid){ 0 };
+    BuildPalette();
+
+    // Halve each level (rounding up) until a single texel is left
+    int w = width;
+    int h = height;
+    while (pyramid->levelCount < PYRAMID_MAX_LEVELS) {
+        PyramidLevel* level = &pyramid->level[pyramid->levelCount++];
+        level->width = w;
+        level->height = h;
+        level->pixels = (Color*)calloc((size_t)w * h, sizeof(Color));
+        if (!level->pixels) {
+            printf("ERROR: Failed to allocate memory for color pyramid\n");
+            CleanupColorPyramid(pyramid);
+            return false;
+        }
+
+        if (w == 1 && h == 1) break;
+        w = (w + 1) / 2;
+        h = (h + 1) / 2;
+    }
+
+    return true;
+}
+
+void CleanupColorPyramid(ColorPyramid* pyramid) {
+    for (int i = 0; i < pyramid->levelCount; i++) {
+        free(pyramid->level[i].pixels);
+    }
+    *pyramid = (ColorPyramid){ 0 };
+}
+
+// Copy one tile of cell colors into level 0, reporting whether anything changed
+static bool RefreshBaseTile(ColorPyramid* pyramid, const World* world, int x0, int y0, int x1, int y1) {
+    PyramidLevel* base = &pyramid->level[0];
+    Color colors[DIRTY_TILE_SIZE];
+    size_t rowBytes = (x1 - x0) * sizeof(Color);
+    bool changed = false;
+
+    for (int y = y0; y < y1; y++) {
+        Color* out = &base->pixels[y * base->width + x0];
+        FillCellColors(world, x0, y, colors, x1 - x0);
+        if (memcmp(out, colors, rowBytes) != 0) {
+            memcpy(out, colors, rowBytes);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+// Rebuild the texels of 'dst' in [x0, x1) x [y0, y1) from the 2x2 blocks below them
+static void DownsampleRegion(const PyramidLevel* src, PyramidLevel* dst, int x0, int y0, int x1, int y1) {
+    for (int y = y0; y < y1; y++) {
+        int sy0 = 2 * y;
+        int sy1 = (sy0 + 1 < src->height) ? sy0 + 1 : sy0;
+        const Color* top = &src->pixels[sy0 * src->width];
+        const Color* bottom = &src->pixels[sy1 * src->width];
+
+        for (int x = x0; x < x1; x++) {
+            int sx0 = 2 * x;
+            int sx1 = (sx0 + 1 < src->width) ? sx0 + 1 : sx0;
+            Color a = top[sx0], b = top[sx1], c = bottom[sx0], d = bottom[sx1];
+            dst->pixels[y * dst->width + x] = (Color){
+                (a.r + b.r + c.r + d.r + 2) / 4,
+                (a.g + b.g + c.g + d.g + 2) / 4,
+                (a.b + b.b + c.b + d.b + 2) / 4,
+                (a.a + b.a + c.a + d.a + 2) / 4
+            };
+        }
+    }
+}
+
+int RefreshColorPyramid(ColorPyramid* pyramid, World* world) {
+    pyramid->dirtyTiles = 0;
+    pyramid->rectCount = 0;
+    if (pyramid->levelCount == 0 || !world->dirty ||
+        pyramid->level[0].width != world->width || pyramid->level[0].height != world->height) {
+        return 0;
+    }
+
+    // Copy the dirty tiles into level 0. Tiles whose colors turn out unchanged
+    // (e.g. two identical cells swapped) are dropped from the dirty set.
+    DirtyMap* dirty = world->dirty;
+    for (int ty = 0; ty < dirty->tilesY; ty++) {
+        for (int tx = 0; tx < dirty->tilesX; tx++) {
+            if (!IsTileDirty(world, tx, ty)) continue;
+
+            int x0 = tx * DIRTY_TILE_SIZE;
+            int y0 = ty * DIRTY_TILE_SIZE;
+            int x1 = (x0 + DIRTY_TILE_SIZE < world->width) ? x0 + DIRTY_TILE_SIZE : world->width;
+            int y1 = (y0 + DIRTY_TILE_SIZE < world->height) ? y0 + DIRTY_TILE_SIZE : world->height;
+
+            if (RefreshBaseTile(pyramid, world, x0, y0, x1, y1)) {
+                pyramid->dirtyTiles++;
+            } else {
+                int tile = ty * dirty->tilesX + tx;
+                dirty->bits[tile >> 6] &= ~((uint64_t)1 << (tile & 63));
+            }
+        }
+    }
+    if (pyramid->dirtyTiles == 0) return 0;
+
+    // Propagate each changed rectangle up the pyramid. A rectangle's footprint on
+    // level n is its cell range shifted right by n, so level n-1 is always up to
+    // date for the texels it reads.
+    pyramid->rectCount = CollectDirtyRects(world, pyramid->rects, PYRAMID_MAX_RECTS);
+    ClearDirtyTiles(world);
+
+    for (int r = 0; r < pyramid->rectCount; r++) {
+        const DirtyRect* rect = &pyramid->rects[r];
+        for (int n = 1; n < pyramid->levelCount; n++) {
+            DownsampleRegion(&pyramid->level[n - 1], &pyramid->level[n],
+                             rect->x0 >> n, rect->y0 >> n, ((rect->x1 - 1) >> n) + 1, ((rect->y1 - 1) >> n) + 1);
+        }
+    }
+
+    for (int n = 0; n < pyramid->levelCount; n++) {
+        pyramid->level[n].version++;
+    }
+    return pyramid->dirtyTiles;
+}
+
+int PyramidLevelForZoom(const ColorPyramid* pyramid, float zoom) {
+    int n = 0;
+    while (n + 1 < pyramid->levelCount && zoom * (1 << n) < 1.0f) {
+        n++;
+    }
+    return n;
+}
+
+int PyramidLevelForSize(const ColorPyramid* pyramid, int maxWidth, int maxHeight) {
+    int n = 0;
+    while (n + 1 < pyramid->levelCount &&
+           (pyramid->level[n].width > maxWidth || pyramid->level[n].height > maxHeight)) {
+        n++;
+    }
+    return n;
+}
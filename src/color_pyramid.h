@@ -0,0 +1,44 @@
+#ifndef COLOR_PYRAMID_H
+#define COLOR_PYRAMID_H
+
+#include "grid.h"
+#include "dirty_tiles.h"
+#include <stdbool.h>
+
+#define PYRAMID_MAX_LEVELS 16
+#define PYRAMID_MAX_RECTS 64   // changed rectangles kept from the last refresh
+
+// One level of the pyramid; level n holds one texel per 2^n x 2^n cells
+typedef struct {
+    Color* pixels;
+    int width;
+    int height;
+    unsigned int version;  // bumped whenever a texel of this level changes
+} PyramidLevel;
+
+// Mip pyramid of the world's colors (looked up in the palette), built with a 2x2 box filter.
+// Only the world's dirty tiles are copied and downsampled again.
+typedef struct ColorPyramid {
+    PyramidLevel level[PYRAMID_MAX_LEVELS];
+    int levelCount;
+    int dirtyTiles;        // tiles whose colors changed in the last refresh
+    DirtyRect rects[PYRAMID_MAX_RECTS];  // those tiles merged into rectangles (level 0 cells)
+    int rectCount;
+} ColorPyramid;
+
+// Allocate every level for a width x height grid
+bool InitColorPyramid(ColorPyramid* pyramid, int width, int height);
+void CleanupColorPyramid(ColorPyramid* pyramid);
+
+// Copy the colors of the world's dirty tiles into level 0, rebuild those tiles
+// on every level above it and clear the dirty tiles. Returns the number of tiles
+// whose colors changed; their rectangles are left in pyramid->rects.
+int RefreshColorPyramid(ColorPyramid* pyramid, World* world);
+
+// Coarsest level whose texels still cover at least one screen pixel at 'zoom'
+int PyramidLevelForZoom(const ColorPyramid* pyramid, float zoom);
+
+// Finest level that fits in maxWidth x maxHeight texels
+int PyramidLevelForSize(const ColorPyramid* pyramid, int maxWidth, int maxHeight);
+
+#endif // COLOR_PYRAMID_H
@@ -0,0 +1,183 @@
+#include "dirty_tiles.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+void InitDirtyTiles(World* world) {
+    CleanupDirtyTiles(world);
+
+    DirtyMap* dirty = (DirtyMap*)calloc(1, sizeof(DirtyMap));
+    if (!dirty) {
+        printf("ERROR: Failed to allocate memory for dirty tiles\n");
+        return;
+    }
+
+    dirty->tilesX = (world->width + DIRTY_TILE_SIZE - 1) / DIRTY_TILE_SIZE;
+    dirty->tilesY = (world->height + DIRTY_TILE_SIZE - 1) / DIRTY_TILE_SIZE;
+    dirty->words = (dirty->tilesX * dirty->tilesY + 63) / 64;
+    dirty->bits = (uint64_t*)calloc(dirty->words, sizeof(uint64_t));
+    dirty->stamp = (uint32_t*)calloc((size_t)dirty->tilesX * dirty->tilesY, sizeof(uint32_t));
+    if (!dirty->bits || !dirty->stamp) {
+        printf("ERROR: Failed to allocate memory for dirty tiles\n");
+        free(dirty->bits);
+        free(dirty->stamp);
+        free(dirty);
+        return;
+    }
+    dirty->epoch = 1;
+    world->dirty = dirty;
+
+    // Nothing has been drawn yet
+    MarkAllDirty(world);
+}
+
+void CleanupDirtyTiles(World* world) {
+    DirtyMap* dirty = world->dirty;
+    if (!dirty) return;
+
+    free(dirty->bits);
+    free(dirty->stamp);
+    free(dirty);
+    world->dirty = NULL;
+}
+
+void MarkRectDirty(World* world, int x0, int y0, int x1, int y1) {
+    DirtyMap* dirty = world->dirty;
+    if (!dirty) return;
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > world->width) x1 = world->width;
+    if (y1 > world->height) y1 = world->height;
+    if (x0 >= x1 || y0 >= y1) return;
+
+    for (int ty = y0 >> DIRTY_TILE_SHIFT; ty <= (y1 - 1) >> DIRTY_TILE_SHIFT; ty++) {
+        for (int tx = x0 >> DIRTY_TILE_SHIFT; tx <= (x1 - 1) >> DIRTY_TILE_SHIFT; tx++) {
+            int tile = ty * dirty->tilesX + tx;
+            dirty->bits[tile >> 6] |= (uint64_t)1 << (tile & 63);
+            dirty->stamp[tile] = dirty->epoch;
+        }
+    }
+}
+
+void MarkAllDirty(World* world) {
+    DirtyMap* dirty = world->dirty;
+    if (!dirty) return;
+
+    int tiles = dirty->tilesX * dirty->tilesY;
+    memset(dirty->bits, 0xFF, dirty->words * sizeof(uint64_t));
+    if (tiles % 64) {
+        dirty->bits[dirty->words - 1] = ((uint64_t)1 << (tiles % 64)) - 1;
+    }
+    for (int i = 0; i < tiles; i++) {
+        dirty->stamp[i] = dirty->epoch;
+    }
+}
+
+uint32_t AdvanceTileEpoch(const World* world) {
+    DirtyMap* dirty = world->dirty;
+    if (!dirty) return 0;
+    return dirty->epoch++;
+}
+
+void ClearDirtyTiles(World* world) {
+    if (!world->dirty) return;
+    memset(world->dirty->bits, 0, world->dirty->words * sizeof(uint64_t));
+}
+
+bool IsTileDirty(const World* world, int tileX, int tileY) {
+    const DirtyMap* dirty = world->dirty;
+    if (!dirty) return true;
+    int tile = tileY * dirty->tilesX + tileX;
+    return (dirty->bits[tile >> 6] >> (tile & 63)) & 1;
+}
+
+int CountDirtyTiles(const World* world) {
+    const DirtyMap* dirty = world->dirty;
+    if (!dirty) return 0;
+
+    int count = 0;
+    for (int i = 0; i < dirty->words; i++) {
+        uint64_t word = dirty->bits[i];
+        while (word) {
+            word &= word - 1;
+            count++;
+        }
+    }
+    return count;
+}
+
+int CollectDirtyRects(const World* world, DirtyRect* rects, int maxRects) {
+    const DirtyMap* dirty = world->dirty;
+    if (!dirty || maxRects <= 0) return 0;
+
+    int count = 0;
+    int openFirst = 0;  // rectangles from openFirst on end at the previous tile row
+    bool overflow = false;
+    int minX = dirty->tilesX, minY = dirty->tilesY, maxX = -1, maxY = -1;
+
+    for (int ty = 0; ty < dirty->tilesY; ty++) {
+        int rowFirst = count;
+
+        for (int tx = 0; tx < dirty->tilesX; tx++) {
+            if (!IsTileDirty(world, tx, ty)) continue;
+
+            // Extend to the end of the run
+            int runEnd = tx + 1;
+            while (runEnd < dirty->tilesX && IsTileDirty(world, runEnd, ty)) {
+                runEnd++;
+            }
+
+            if (tx < minX) minX = tx;
+            if (runEnd - 1 > maxX) maxX = runEnd - 1;
+            if (ty < minY) minY = ty;
+            maxY = ty;
+
+            if (!overflow) {
+                // Grow a rectangle from the row above with exactly this span
+                int x0 = tx * DIRTY_TILE_SIZE;
+                int x1 = runEnd * DIRTY_TILE_SIZE;
+                bool merged = false;
+                for (int r = openFirst; r < rowFirst; r++) {
+                    if (rects[r].x0 == x0 && rects[r].x1 == x1 && rects[r].y1 == ty * DIRTY_TILE_SIZE) {
+                        rects[r].y1 = (ty + 1) * DIRTY_TILE_SIZE;
+                        merged = true;
+                        break;
+                    }
+                }
+
+                if (!merged) {
+                    if (count == maxRects) {
+                        overflow = true;
+                    } else {
+                        rects[count++] = (DirtyRect){ x0, ty * DIRTY_TILE_SIZE, x1, (ty + 1) * DIRTY_TILE_SIZE };
+                    }
+                }
+            }
+            tx = runEnd;
+        }
+
+        // Only rectangles that reached this row can keep growing. The ones
+        // added before rowFirst but extended here also stay open.
+        if (!overflow) {
+            int first = count;
+            for (int r = openFirst; r < count; r++) {
+                if (rects[r].y1 == (ty + 1) * DIRTY_TILE_SIZE && r < first) first = r;
+            }
+            openFirst = first;
+        }
+    }
+
+    if (maxX < 0) return 0;
+    if (overflow) {
+        rects[0] = (DirtyRect){ minX * DIRTY_TILE_SIZE, minY * DIRTY_TILE_SIZE,
+                                (maxX + 1) * DIRTY_TILE_SIZE, (maxY + 1) * DIRTY_TILE_SIZE };
+        count = 1;
+    }
+
+    // Clip to the grid
+    for (int r = 0; r < count; r++) {
+        if (rects[r].x1 > world->width) rects[r].x1 = world->width;
+        if (rects[r].y1 > world->height) rects[r].y1 = world->height;
+    }
+    return count;
+}
@@ -0,0 +1,68 @@
+#ifndef DIRTY_TILES_H
+#define DIRTY_TILES_H
+
+#include "grid.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+// Changed regions of the grid are tracked per tile in a bitmap, so consumers
+// (the renderer's color pyramid and texture uploads) only revisit those tiles.
+// The bitmap belongs to the renderer, which clears it every frame. Tiles also
+// carry the epoch of their last change, so other consumers (per-tile summaries)
+// can each find what changed since their own last refresh.
+#define DIRTY_TILE_SHIFT 4
+#define DIRTY_TILE_SIZE (1 << DIRTY_TILE_SHIFT)  // cells per side of a tile
+
+typedef struct DirtyMap {
+    uint64_t* bits;   // one bit per tile, row-major
+    uint32_t* stamp;  // epoch of each tile's last change
+    uint32_t epoch;   // stamped on tiles changed from now on
+    int tilesX;
+    int tilesY;
+    int words;
+} DirtyMap;
+
+// A rectangle of cells, [x0, x1) x [y0, y1)
+typedef struct {
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+} DirtyRect;
+
+// Allocate the world's bitmap with every tile dirty (called from InitWorld/CleanupWorld)
+void InitDirtyTiles(World* world);
+void CleanupDirtyTiles(World* world);
+
+// Record a change to one cell (called from MoveCell, Place* and every color update)
+static inline void MarkCellDirty(World* world, int x, int y) {
+    DirtyMap* dirty = world->dirty;
+    if (!dirty) return;
+    int tile = (y >> DIRTY_TILE_SHIFT) * dirty->tilesX + (x >> DIRTY_TILE_SHIFT);
+    dirty->bits[tile >> 6] |= (uint64_t)1 << (tile & 63);
+    dirty->stamp[tile] = dirty->epoch;
+}
+
+// Record a change to every cell in [x0, x1) x [y0, y1)
+void MarkRectDirty(World* world, int x0, int y0, int x1, int y1);
+void MarkAllDirty(World* world);
+void ClearDirtyTiles(World* world);
+
+// Start a new epoch and return the previous one: a tile changed after this call
+// has a stamp greater than the returned value (see TileChangedSince)
+uint32_t AdvanceTileEpoch(const World* world);
+
+// True when the tile changed after AdvanceTileEpoch returned 'epoch'
+static inline bool TileChangedSince(const World* world, int tile, uint32_t epoch) {
+    return world->dirty == NULL || world->dirty->stamp[tile] > epoch;
+}
+
+bool IsTileDirty(const World* world, int tileX, int tileY);
+int CountDirtyTiles(const World* world);
+
+// Merge the dirty tiles into rectangles: runs of tiles within a row, joined with
+// identical runs in the rows below. Rectangles are in cells, clipped to the grid.
+// When more than maxRects would be needed, the bounding box is returned instead.
+int CollectDirtyRects(const World* world, DirtyRect* rects, int maxRects);
+
+#endif // DIRTY_TILES_H
@@ -0,0 +1,343 @@
+#include "fluid.h"
+#include "grid.h"
+#include "cell_types.h"
+#include "simulation.h"
+#include "telemetry.h"
+#include "dirty_tiles.h"
+#include "sim_lod.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+// Allocate solver buffers sized to the world's grid
+void InitFluid(World* world) {
+    CleanupFluid(world);
+
+    FluidState* f = (FluidState*)calloc(1, sizeof(FluidState));
+    if (!f) {
+        printf("ERROR: Failed to allocate memory for fluid solver\n");
+        return;
+    }
+    world->fluid = f;
+
+    f->width = world->width;
+    f->height = world->height;
+    f->chunksX = (f->width + FLUID_CHUNK_SIZE - 1) / FLUID_CHUNK_SIZE;
+    f->chunksY = (f->height + FLUID_CHUNK_SIZE - 1) / FLUID_CHUNK_SIZE;
+
+    f->delta = (int*)calloc(f->width * f->height, sizeof(int));
+    f->snapshot = (int*)calloc(f->width * f->height, sizeof(int));
+    f->chunkAwake = (unsigned char*)calloc(f->chunksX * f->chunksY, 1);
+    f->chunkTouched = (unsigned char*)calloc(f->chunksX * f->chunksY, 1);
+    if (!f->delta || !f->snapshot || !f->chunkAwake || !f->chunkTouched) {
+        printf("ERROR: Failed to allocate memory for fluid solver\n");
+        CleanupFluid(world);
+        return;
+    }
+
+    WakeAllFluid(world);
+}
+
+// Release solver buffers
+void CleanupFluid(World* world) {
+    FluidState* f = world->fluid;
+    if (!f) return;
+
+    free(f->delta);
+    free(f->snapshot);
+    free(f->chunkAwake);
+    free(f->chunkTouched);
+    free(f);
+    world->fluid = NULL;
+}
+
+// Copy the solver state of a world of the same size
+void CopyFluid(World* dst, const World* src) {
+    FluidState* to = dst->fluid;
+    const FluidState* from = src->fluid;
+    if (!to || !from || to->width != from->width || to->height != from->height) return;
+
+    int cells = from->width * from->height;
+    int chunks = from->chunksX * from->chunksY;
+    memcpy(to->delta, from->delta, cells * sizeof(int));
+    memcpy(to->snapshot, from->snapshot, cells * sizeof(int));
+    memcpy(to->chunkAwake, from->chunkAwake, chunks);
+    memcpy(to->chunkTouched, from->chunkTouched, chunks);
+    to->awakeChunks = from->awakeChunks;
+    to->tick = from->tick;
+}
+
+// Wake the chunks touching a cell and its direct neighbours
+void WakeFluidAt(World* world, int x, int y) {
+    FluidState* f = world->fluid;
+    if (!f) return;
+
+    int cx0 = (x > 0 ? x - 1 : 0) / FLUID_CHUNK_SIZE;
+    int cy0 = (y > 0 ? y - 1 : 0) / FLUID_CHUNK_SIZE;
+    int cx1 = (x + 1 < f->width ? x + 1 : f->width - 1) / FLUID_CHUNK_SIZE;
+    int cy1 = (y + 1 < f->height ? y + 1 : f->height - 1) / FLUID_CHUNK_SIZE;
+
+    for (int cy = cy0; cy <= cy1; cy++) {
+        for (int cx = cx0; cx <= cx1; cx++) {
+            f->chunkAwake[cy * f->chunksX + cx] = 1;
+        }
+    }
+}
+
+// Wake the chunks overlapping [x0, x1) x [y0, y1)
+void WakeFluidRect(World* world, int x0, int y0, int x1, int y1) {
+    FluidState* f = world->fluid;
+    if (!f) return;
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > f->width) x1 = f->width;
+    if (y1 > f->height) y1 = f->height;
+    if (x0 >= x1 || y0 >= y1) return;
+
+    for (int cy = y0 / FLUID_CHUNK_SIZE; cy <= (y1 - 1) / FLUID_CHUNK_SIZE; cy++) {
+        for (int cx = x0 / FLUID_CHUNK_SIZE; cx <= (x1 - 1) / FLUID_CHUNK_SIZE; cx++) {
+            f->chunkAwake[cy * f->chunksX + cx] = 1;
+        }
+    }
+}
+
+// Wake every chunk
+void WakeAllFluid(World* world) {
+    FluidState* f = world->fluid;
+    if (!f) return;
+
+    for (int i = 0; i < f->chunksX * f->chunksY; i++) {
+        f->chunkAwake[i] = 1;
+    }
+}
+
+int GetAwakeFluidChunks(const World* world) {
+    return world->fluid ? world->fluid->awakeChunks : 0;
+}
+
+// Liquid mass of a cell (air vapour does not take part in pressure flow)
+static int LiquidMass(const GridCell* cell) {
+    return (cell->type == CELL_TYPE_WATER) ? cell->moisture : 0;
+}
+
+// Only air and water cells can receive liquid
+static bool CanHoldLiquid(const GridCell* cell) {
+    return cell->type == CELL_TYPE_WATER || cell->type == CELL_TYPE_AIR;
+}
+
+// Mass the lower of two stacked cells should hold when they share 'total'
+static int StableLowerMass(int total) {
+    if (total <= WATER_MAX_MASS) {
+        return total;
+    } else if (total < 2 * WATER_MAX_MASS + WATER_MAX_COMPRESS) {
+        return (WATER_MAX_MASS * WATER_MAX_MASS + total * WATER_MAX_COMPRESS) /
+               (WATER_MAX_MASS + WATER_MAX_COMPRESS);
+    }
+    return (total + WATER_MAX_COMPRESS) / 2;
+}
+
+// Limit a flow to what is left in the cell. Tiny flows are dropped so settled
+// water goes idle, and flows into air must be big enough to form a water cell,
+// unless the whole cell moves (a falling drop). Sideways and upward flows are
+// halved to damp oscillation.
+static int LimitFlow(int flow, int remaining, const GridCell* target, bool damp) {
+    if (flow >= remaining) return remaining;
+    if (flow < WATER_SETTLE_FLOW) return 0;
+    if (damp && flow > WATER_MIN_FLOW) flow /= 2;
+    if (target->type == CELL_TYPE_AIR && flow < WATER_MIN_MASS) return 0;
+    return flow;
+}
+
+// Set the fill level of a water cell from its mass
+static void UpdateWaterVolume(GridCell* cell) {
+    int volume = 1 + (cell->moisture * 9) / WATER_MAX_MASS;
+    cell->volume = (volume > 10) ? 10 : volume;
+}
+
+// Apply a mass change, converting between air and water as needed
+static void ApplyMass(World* world, int x, int y, int delta) {
+    GridCell* cell = GetCell(world, x, y);
+    cell->moisture += delta;
+    cell->is_falling = false;
+    CountActiveCells(world, 1);
+    MarkCellDirty(world, x, y);
+
+    if (cell->type == CELL_TYPE_AIR) {
+        // Liquid arriving in air turns it into water, merging with its vapour
+        cell->type = CELL_TYPE_WATER;
+        UpdateWaterVolume(cell);
+    } else if (cell->moisture <= 0) {
+        // Drained water cells turn back into air
+        cell->type = CELL_TYPE_AIR;
+        cell->volume = 1;
+    } else {
+        UpdateWaterVolume(cell);
+    }
+}
+
+// Move mass between two cells through the delta buffer
+static void Flow(FluidState* f, int fromIndex, int toIndex, int amount) {
+    f->delta[fromIndex] -= amount;
+    f->delta[toIndex] += amount;
+}
+
+// Compute the outgoing flows of one water cell
+static void FlowCell(World* world, int x, int y) {
+    FluidState* f = world->fluid;
+    const GridCell* cell = GetCell(world, x, y);
+    int remaining = cell->moisture;
+    int index = y * f->width + x;
+
+    // Down: fill the cell below up to its stable mass
+    const GridCell* below = GetCell(world, x, y + 1);
+    if (CanHoldLiquid(below)) {
+        int belowMass = LiquidMass(below);
+        int flow = LimitFlow(StableLowerMass(remaining + belowMass) - belowMass, remaining, below, false);
+        if (flow > 0) {
+            Flow(f, index, index + f->width, flow);
+            remaining -= flow;
+        }
+    }
+    if (remaining <= 0) return;
+
+    // Sideways: equalize with each horizontal neighbour
+    for (int side = -1; side <= 1; side += 2) {
+        const GridCell* neighbour = GetCell(world, x + side, y);
+        if (!CanHoldLiquid(neighbour)) continue;
+
+        int flow = LimitFlow((cell->moisture - LiquidMass(neighbour)) / 4, remaining, neighbour, true);
+        if (flow > 0) {
+            Flow(f, index, index + side, flow);
+            remaining -= flow;
+        }
+    }
+    if (remaining <= 0) return;
+
+    // Up: only compressed water pushes mass upward
+    const GridCell* above = GetCell(world, x, y - 1);
+    if (CanHoldLiquid(above)) {
+        int flow = LimitFlow(remaining - StableLowerMass(remaining + LiquidMass(above)), remaining, above, true);
+        if (flow > 0) {
+            Flow(f, index, index - f->width, flow);
+        }
+    }
+}
+
+// Mass-based pressure equalization for water. Each water cell holds a fractional
+// mass in its moisture field; mass only moves between cells, so total moisture is
+// conserved. Every FLUID_SETTLE_WINDOW ticks, chunks whose cells changed by no more
+// than WATER_SETTLE_DELTA over the window go to sleep until something wakes them.
+void UpdateWaterPressure(World* world) {
+    FluidState* f = world->fluid;
+    if (!f || world->width != f->width || world->height > f->height) return;
+
+    int chunksX = f->chunksX;
+    int chunksY = f->chunksY;
+    unsigned char* chunkAwake = f->chunkAwake;
+    unsigned char* chunkTouched = f->chunkTouched;
+
+    // Flows can land in the neighbours of awake chunks
+    int chunkCount = chunksX * chunksY;
+    for (int i = 0; i < chunkCount; i++) {
+        chunkTouched[i] = 0;
+    }
+    f->awakeChunks = 0;
+    for (int cy = 0; cy < chunksY; cy++) {
+        for (int cx = 0; cx < chunksX; cx++) {
+            if (!chunkAwake[cy * chunksX + cx]) continue;
+            f->awakeChunks++;
+
+            for (int ny = cy - 1; ny <= cy + 1; ny++) {
+                for (int nx = cx - 1; nx <= cx + 1; nx++) {
+                    if (nx >= 0 && nx < chunksX && ny >= 0 && ny < chunksY) {
+                        chunkTouched[ny * chunksX + nx] = 1;
+                    }
+                }
+            }
+        }
+    }
+
+    // Compute flows for awake chunks that are due this tick (see sim_lod.h). A flow
+    // takes mass from one cell and gives it to another in the same delta buffer,
+    // so chunks that sit out leave the total intact.
+    for (int cy = 0; cy < chunksY; cy++) {
+        for (int cx = 0; cx < chunksX; cx++) {
+            if (!chunkAwake[cy * chunksX + cx] || !TileIsDue(world, cx * FLUID_CHUNK_SIZE, cy * FLUID_CHUNK_SIZE)) continue;
+
+            int y0 = cy * FLUID_CHUNK_SIZE;
+            int x0 = cx * FLUID_CHUNK_SIZE;
+            int y1 = y0 + FLUID_CHUNK_SIZE;
+            int x1 = x0 + FLUID_CHUNK_SIZE;
+            if (y0 < 1) y0 = 1;
+            if (x0 < 1) x0 = 1;
+            if (y1 > world->height - 1) y1 = world->height - 1;
+            if (x1 > world->width - 1) x1 = world->width - 1;
+
+            for (int y = y0; y < y1; y++) {
+                for (int x = x0; x < x1; x++) {
+                    if (GetCell(world, x, y)->type == CELL_TYPE_WATER && GetCell(world, x, y)->moisture > 0) {
+                        FlowCell(world, x, y);
+                    }
+                }
+            }
+        }
+    }
+
+    // Apply the accumulated deltas; a sleeping chunk that receives water wakes up
+    for (int cy = 0; cy < chunksY; cy++) {
+        for (int cx = 0; cx < chunksX; cx++) {
+            int c = cy * chunksX + cx;
+            if (!chunkTouched[c]) continue;
+
+            int y1 = (cy + 1) * FLUID_CHUNK_SIZE;
+            int x1 = (cx + 1) * FLUID_CHUNK_SIZE;
+            if (y1 > world->height) y1 = world->height;
+            if (x1 > world->width) x1 = world->width;
+
+            for (int y = cy * FLUID_CHUNK_SIZE; y < y1; y++) {
+                for (int x = cx * FLUID_CHUNK_SIZE; x < x1; x++) {
+                    int index = y * f->width + x;
+                    if (f->delta[index] != 0) {
+                        ApplyMass(world, x, y, f->delta[index]);
+                        f->delta[index] = 0;
+                        chunkAwake[c] = 1;
+                    }
+                }
+            }
+        }
+    }
+
+    // At the end of each window, put chunks to sleep whose water has stopped moving.
+    // Comparing against a snapshot lets small oscillations settle while slow creep
+    // in one direction keeps its chunk awake.
+    if (++f->tick % FLUID_SETTLE_WINDOW != 0) return;
+
+    for (int cy = 0; cy < chunksY; cy++) {
+        for (int cx = 0; cx < chunksX; cx++) {
+            int c = cy * chunksX + cx;
+            if (!chunkAwake[c]) continue;
+
+            int y1 = (cy + 1) * FLUID_CHUNK_SIZE;
+            int x1 = (cx + 1) * FLUID_CHUNK_SIZE;
+            if (y1 > world->height) y1 = world->height;
+            if (x1 > world->width) x1 = world->width;
+
+            bool settled = true;
+            for (int y = cy * FLUID_CHUNK_SIZE; y < y1; y++) {
+                for (int x = cx * FLUID_CHUNK_SIZE; x < x1; x++) {
+                    int index = y * f->width + x;
+                    int mass = LiquidMass(GetCell(world, x, y));
+                    int change = mass - f->snapshot[index];
+                    if (change > WATER_SETTLE_DELTA || change < -WATER_SETTLE_DELTA) {
+                        settled = false;
+                    }
+                    f->snapshot[index] = mass;
+                }
+            }
+
+            if (settled) {
+                chunkAwake[c] = 0;
+            }
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef FLUID_H
+#define FLUID_H
+
+#include "grid.h"
+#include <stdbool.h>
+
+// Liquid mass units, stored in the water cell's moisture field
+#define WATER_MAX_MASS 1000     // mass of a full, uncompressed water cell
+#define WATER_MAX_COMPRESS 20   // extra mass a cell can hold per cell of water above it
+#define WATER_MIN_MASS 5        // smallest flow that can turn an air cell into water
+#define WATER_MIN_FLOW 4        // flows above this are halved to damp oscillation
+#define WATER_SETTLE_FLOW 2     // smaller flows are dropped
+#define WATER_SETTLE_DELTA 4    // a chunk sleeps once no cell changed by more than this over a window
+
+// Size of the sleep/wake chunks used to let settled water go idle
+#define FLUID_CHUNK_SIZE 16
+#define FLUID_SETTLE_WINDOW 16  // ticks between checks for settled chunks
+
+// Per-world solver state
+typedef struct FluidState {
+    int* delta;               // pending mass change per cell, applied after all flows are computed
+    int* snapshot;            // liquid mass of each cell at the start of the current settle window
+    unsigned char* chunkAwake;   // chunks whose flows are computed
+    unsigned char* chunkTouched; // chunks next to awake ones where flows may land
+    int width;
+    int height;
+    int chunksX;
+    int chunksY;
+    int awakeChunks;
+    int tick;
+} FluidState;
+
+// Allocate and release the solver buffers (called from InitWorld/CleanupWorld)
+void InitFluid(World* world);
+void CleanupFluid(World* world);
+
+// Copy the solver state between worlds of the same size
+void CopyFluid(World* dst, const World* src);
+
+// Mass-based pressure equalization pass for water
+void UpdateWaterPressure(World* world);
+
+// Wake the chunks around a cell so the solver re-checks them
+void WakeFluidAt(World* world, int x, int y);
+
+// Wake the chunks overlapping a rectangle of cells, [x0, x1) x [y0, y1)
+void WakeFluidRect(World* world, int x0, int y0, int x1, int y1);
+
+// Wake every chunk, e.g. after switching water models
+void WakeAllFluid(World* world);
+
+// Number of chunks whose flows were computed by the last solver tick
+int GetAwakeFluidChunks(const World* world);
+
+#endif // FLUID_H
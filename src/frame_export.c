@@ -0,0 +1,371 @@
+#include "frame_export.h"
+#include "palette.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// One queue slot: the colors of the exported region and the encoder's buffers
+typedef struct {
+    int tick;
+    Color* colors;          // cropWidth * cropHeight captured colors
+    unsigned char* pixels;  // downscaled RGB
+    unsigned char* encoded; // encoded file contents
+} ExportFrameSlot;
+
+struct FrameExporter {
+    FrameExportOptions options;
+    int outWidth;
+    int outHeight;
+
+    ExportFrameSlot* slots;
+    int* freeSlots;         // stack of slots the simulation can fill
+    int freeCount;
+    int* readySlots;        // ring of slots waiting for an encoder
+    int readyHead;
+    int readyCount;
+    bool stopping;
+
+    pthread_t threads[FRAME_EXPORT_MAX_THREADS];
+    int threadCount;
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+
+    FrameExportStats stats;
+};
+
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+FrameExportOptions DefaultFrameExportOptions(void) {
+    FrameExportOptions options;
+    memset(&options, 0, sizeof(options));
+    options.directory = ".";
+    options.every = FRAME_EXPORT_DEFAULT_EVERY;
+    options.scale = 1;
+    options.threads = FRAME_EXPORT_DEFAULT_THREADS;
+    options.queueSize = FRAME_EXPORT_DEFAULT_QUEUE;
+    options.format = FRAME_FORMAT_PPM;
+    return options;
+}
+
+bool ParseFrameFormat(const char* text, FrameExportOptions* options) {
+    if (strcmp(text, "ppm") == 0) {
+        options->format = FRAME_FORMAT_PPM;
+    } else if (strcmp(text, "qoi") == 0) {
+        options->format = FRAME_FORMAT_QOI;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool ParseFrameCrop(const char* text, FrameExportOptions* options) {
+    int x, y, w, h;
+    if (sscanf(text, "%d,%d,%d,%d", &x, &y, &w, &h) != 4 || x < 0 || y < 0 || w <= 0 || h <= 0) {
+        return false;
+    }
+    options->cropX = x;
+    options->cropY = y;
+    options->cropWidth = w;
+    options->cropHeight = h;
+    return true;
+}
+
+// Average scale x scale blocks of captured colors into RGB pixels
+static void Downscale(const FrameExporter* e, const Color* colors, unsigned char* out) {
+    int scale = e->options.scale;
+    int width = e->options.cropWidth;
+    int height = e->options.cropHeight;
+
+    for (int oy = 0; oy < e->outHeight; oy++) {
+        int y0 = oy * scale;
+        int y1 = (y0 + scale < height) ? y0 + scale : height;
+        for (int ox = 0; ox < e->outWidth; ox++) {
+            int x0 = ox * scale;
+            int x1 = (x0 + scale < width) ? x0 + scale : width;
+
+            int r = 0, g = 0, b = 0;
+            for (int y = y0; y < y1; y++) {
+                const Color* row = colors + (size_t)y * width;
+                for (int x = x0; x < x1; x++) {
+                    r += row[x].r;
+                    g += row[x].g;
+                    b += row[x].b;
+                }
+            }
+            int n = (x1 - x0) * (y1 - y0);
+            unsigned char* p = out + ((size_t)oy * e->outWidth + ox) * 3;
+            p[0] = (unsigned char)(r / n);
+            p[1] = (unsigned char)(g / n);
+            p[2] = (unsigned char)(b / n);
+        }
+    }
+}
+
+static unsigned char* Put32(unsigned char* p, unsigned int v) {
+    p[0] = (unsigned char)(v >> 24);
+    p[1] = (unsigned char)(v >> 16);
+    p[2] = (unsigned char)(v >> 8);
+    p[3] = (unsigned char)v;
+    return p + 4;
+}
+
+// Encode RGB pixels as QOI (https://qoiformat.org); returns the encoded size
+static size_t EncodeQOI(const unsigned char* pixels, int width, int height, unsigned char* out) {
+    // RGBA entries: the index starts out as transparent black, which never matches an opaque pixel
+    unsigned char index[64][4];
+    memset(index, 0, sizeof(index));
+    unsigned char* p = out;
+
+    memcpy(p, "qoif", 4);
+    p = Put32(p + 4, (unsigned int)width);
+    p = Put32(p, (unsigned int)height);
+    *p++ = 3; // RGB
+    *p++ = 0; // sRGB
+
+    unsigned char pr = 0, pg = 0, pb = 0; // previous pixel, alpha stays 255
+    int run = 0;
+    size_t count = (size_t)width * height;
+    for (size_t i = 0; i < count; i++) {
+        unsigned char r = pixels[i * 3];
+        unsigned char g = pixels[i * 3 + 1];
+        unsigned char b = pixels[i * 3 + 2];
+
+        if (r == pr && g == pg && b == pb) {
+            run++;
+            if (run == 62 || i + 1 == count) {
+                *p++ = (unsigned char)(0xC0 | (run - 1)); // QOI_OP_RUN
+                run = 0;
+            }
+            continue;
+        }
+        if (run > 0) {
+            *p++ = (unsigned char)(0xC0 | (run - 1));
+            run = 0;
+        }
+
+        int hash = (r * 3 + g * 5 + b * 7 + 255 * 11) % 64;
+        if (index[hash][0] == r && index[hash][1] == g && index[hash][2] == b && index[hash][3] == 255) {
+            *p++ = (unsigned char)hash; // QOI_OP_INDEX
+        } else {
+            index[hash][0] = r;
+            index[hash][1] = g;
+            index[hash][2] = b;
+            index[hash][3] = 255;
+
+            signed char dr = (signed char)(r - pr);
+            signed char dg = (signed char)(g - pg);
+            signed char db = (signed char)(b - pb);
+            signed char drg = (signed char)(dr - dg);
+            signed char dbg = (signed char)(db - dg);
+            if (dr > -3 && dr < 2 && dg > -3 && dg < 2 && db > -3 && db < 2) {
+                *p++ = (unsigned char)(0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)); // QOI_OP_DIFF
+            } else if (drg > -9 && drg < 8 && dg > -33 && dg < 32 && dbg > -9 && dbg < 8) {
+                *p++ = (unsigned char)(0x80 | (dg + 32)); // QOI_OP_LUMA
+                *p++ = (unsigned char)((drg + 8) << 4 | (dbg + 8));
+            } else {
+                *p++ = 0xFE; // QOI_OP_RGB
+                *p++ = r;
+                *p++ = g;
+                *p++ = b;
+            }
+        }
+        pr = r;
+        pg = g;
+        pb = b;
+    }
+
+    static const unsigned char padding[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+    memcpy(p, padding, sizeof(padding));
+    return (size_t)(p - out) + sizeof(padding);
+}
+
+// Downscale, encode and write one frame (runs on an encoder thread)
+static bool WriteFrame(FrameExporter* e, ExportFrameSlot* slot) {
+    Downscale(e, slot->colors, slot->pixels);
+
+    bool qoi = (e->options.format == FRAME_FORMAT_QOI);
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/frame_%06d.%s", e->options.directory, slot->tick, qoi ? "qoi" : "ppm");
+
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        printf("ERROR: Failed to open frame file %s\n", path);
+        return false;
+    }
+
+    size_t size = (size_t)e->outWidth * e->outHeight * 3;
+    bool ok;
+    if (qoi) {
+        size_t encoded = EncodeQOI(slot->pixels, e->outWidth, e->outHeight, slot->encoded);
+        ok = fwrite(slot->encoded, 1, encoded, file) == encoded;
+    } else {
+        fprintf(file, "P6\n%d %d\n255\n", e->outWidth, e->outHeight);
+        ok = fwrite(slot->pixels, 1, size, file) == size;
+    }
+    return (fclose(file) == 0) && ok;
+}
+
+static void* ExportWorker(void* arg) {
+    FrameExporter* e = (FrameExporter*)arg;
+
+    pthread_mutex_lock(&e->lock);
+    for (;;) {
+        while (e->readyCount == 0 && !e->stopping) {
+            pthread_cond_wait(&e->ready, &e->lock);
+        }
+        if (e->readyCount == 0) break; // Stopping and drained
+
+        int slot = e->readySlots[e->readyHead];
+        e->readyHead = (e->readyHead + 1) % e->options.queueSize;
+        e->readyCount--;
+        pthread_mutex_unlock(&e->lock);
+
+        bool ok = WriteFrame(e, &e->slots[slot]);
+
+        pthread_mutex_lock(&e->lock);
+        if (ok) {
+            e->stats.written++;
+        } else {
+            e->stats.failed++;
+        }
+        e->freeSlots[e->freeCount++] = slot;
+    }
+    pthread_mutex_unlock(&e->lock);
+    return NULL;
+}
+
+static void FreeExporter(FrameExporter* e) {
+    if (e->slots) {
+        for (int i = 0; i < e->options.queueSize; i++) {
+            free(e->slots[i].colors);
+            free(e->slots[i].pixels);
+            free(e->slots[i].encoded);
+        }
+    }
+    free(e->slots);
+    free(e->freeSlots);
+    free(e->readySlots);
+    free(e);
+}
+
+FrameExporter* StartFrameExport(const World* world, const FrameExportOptions* options) {
+    FrameExporter* e = (FrameExporter*)calloc(1, sizeof(FrameExporter));
+    if (!e) {
+        printf("ERROR: Failed to allocate memory for frame export\n");
+        return NULL;
+    }
+    e->options = *options;
+    FrameExportOptions* o = &e->options;
+    if (o->every < 1) o->every = 1;
+    if (o->scale < 1) o->scale = 1;
+    if (o->queueSize < 1) o->queueSize = 1;
+    if (o->threads < 1) o->threads = 1;
+    if (o->threads > FRAME_EXPORT_MAX_THREADS) o->threads = FRAME_EXPORT_MAX_THREADS;
+
+    // Clip the region to the grid
+    if (o->cropWidth <= 0 || o->cropHeight <= 0) {
+        o->cropX = 0;
+        o->cropY = 0;
+        o->cropWidth = world->width;
+        o->cropHeight = world->height;
+    }
+    if (o->cropX + o->cropWidth > world->width) o->cropWidth = world->width - o->cropX;
+    if (o->cropY + o->cropHeight > world->height) o->cropHeight = world->height - o->cropY;
+    if (o->cropWidth <= 0 || o->cropHeight <= 0) {
+        printf("ERROR: Frame region lies outside the %dx%d grid\n", world->width, world->height);
+        free(e);
+        return NULL;
+    }
+    e->outWidth = (o->cropWidth + o->scale - 1) / o->scale;
+    e->outHeight = (o->cropHeight + o->scale - 1) / o->scale;
+
+    size_t cells = (size_t)o->cropWidth * o->cropHeight;
+    size_t pixels = (size_t)e->outWidth * e->outHeight;
+    e->slots = (ExportFrameSlot*)calloc(o->queueSize, sizeof(ExportFrameSlot));
+    e->freeSlots = (int*)malloc(o->queueSize * sizeof(int));
+    e->readySlots = (int*)malloc(o->queueSize * sizeof(int));
+    bool allocated = e->slots && e->freeSlots && e->readySlots;
+    for (int i = 0; allocated && i < o->queueSize; i++) {
+        e->slots[i].colors = (Color*)malloc(cells * sizeof(Color));
+        e->slots[i].pixels = (unsigned char*)malloc(pixels * 3);
+        // Worst case for QOI: 4 bytes per pixel plus header and padding
+        e->slots[i].encoded = (o->format == FRAME_FORMAT_QOI) ? (unsigned char*)malloc(pixels * 4 + 22) : NULL;
+        allocated = e->slots[i].colors && e->slots[i].pixels &&
+                    (o->format != FRAME_FORMAT_QOI || e->slots[i].encoded);
+        e->freeSlots[e->freeCount++] = i;
+    }
+    if (!allocated) {
+        printf("ERROR: Failed to allocate memory for frame export\n");
+        FreeExporter(e);
+        return NULL;
+    }
+
+    BuildPalette();
+    pthread_mutex_init(&e->lock, NULL);
+    pthread_cond_init(&e->ready, NULL);
+    for (int t = 0; t < o->threads; t++) {
+        if (pthread_create(&e->threads[e->threadCount], NULL, ExportWorker, e) == 0) {
+            e->threadCount++;
+        } else {
+            printf("ERROR: Failed to start frame encoder %d\n", t);
+        }
+    }
+    if (e->threadCount == 0) {
+        pthread_mutex_destroy(&e->lock);
+        pthread_cond_destroy(&e->ready);
+        FreeExporter(e);
+        return NULL;
+    }
+    return e;
+}
+
+void ExportFrame(FrameExporter* e, const World* world) {
+    if (!e || world->tick % e->options.every != 0) return;
+    double start = Now();
+
+    // Never wait for an encoder: without a free slot the frame is dropped
+    pthread_mutex_lock(&e->lock);
+    int slot = (e->freeCount > 0) ? e->freeSlots[--e->freeCount] : -1;
+    if (slot < 0) e->stats.dropped++;
+    pthread_mutex_unlock(&e->lock);
+    if (slot < 0) return;
+
+    const FrameExportOptions* o = &e->options;
+    ExportFrameSlot* frame = &e->slots[slot];
+    frame->tick = world->tick;
+    for (int y = 0; y < o->cropHeight; y++) {
+        FillCellColors(world, o->cropX, o->cropY + y, frame->colors + (size_t)y * o->cropWidth, o->cropWidth);
+    }
+
+    pthread_mutex_lock(&e->lock);
+    e->readySlots[(e->readyHead + e->readyCount) % o->queueSize] = slot;
+    e->readyCount++;
+    e->stats.captured++;
+    pthread_cond_signal(&e->ready);
+    pthread_mutex_unlock(&e->lock);
+
+    e->stats.captureSeconds += Now() - start;
+}
+
+void FinishFrameExport(FrameExporter* e, FrameExportStats* stats) {
+    if (!e) return;
+
+    pthread_mutex_lock(&e->lock);
+    e->stopping = true;
+    pthread_cond_broadcast(&e->ready);
+    pthread_mutex_unlock(&e->lock);
+    for (int t = 0; t < e->threadCount; t++) {
+        pthread_join(e->threads[t], NULL);
+    }
+
+    if (stats) *stats = e->stats;
+    pthread_mutex_destroy(&e->lock);
+    pthread_cond_destroy(&e->ready);
+    FreeExporter(e);
+}
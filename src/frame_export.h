@@ -0,0 +1,62 @@
+#ifndef FRAME_EXPORT_H
+#define FRAME_EXPORT_H
+
+#include "grid.h"
+#include <stdbool.h>
+
+// Image sequence export for unattended runs. The simulation thread only copies
+// the cell colors of the exported region into a free queue slot; background
+// encoder threads downscale, encode and write the frames. When every slot is
+// busy the frame is dropped and counted, so exporting never blocks UpdateGrid.
+#define FRAME_EXPORT_DEFAULT_EVERY 50
+#define FRAME_EXPORT_DEFAULT_QUEUE 8
+#define FRAME_EXPORT_DEFAULT_THREADS 2
+#define FRAME_EXPORT_MAX_THREADS 16
+
+typedef enum {
+    FRAME_FORMAT_PPM,   // binary PPM (P6)
+    FRAME_FORMAT_QOI,   // Quite OK Image format, lossless and compact
+} FrameFormat;
+
+typedef struct {
+    const char* directory;  // frames are written as directory/frame_<tick>.<ext> (must exist)
+    int every;              // ticks between frames
+    int scale;              // each output pixel averages scale x scale cells
+    int cropX;              // exported region in cells, a zero size means the whole grid
+    int cropY;
+    int cropWidth;
+    int cropHeight;
+    int threads;            // encoder threads
+    int queueSize;          // frames that can wait for an encoder
+    FrameFormat format;
+} FrameExportOptions;
+
+typedef struct {
+    int captured;           // frames handed to the encoders
+    int written;
+    int dropped;            // frames skipped because the queue was full
+    int failed;             // frames that could not be written
+    double captureSeconds;  // time spent on the simulation thread
+} FrameExportStats;
+
+typedef struct FrameExporter FrameExporter;
+
+// Default options: every 50 ticks, full grid, full size, PPM
+FrameExportOptions DefaultFrameExportOptions(void);
+
+// Parse "ppm" or "qoi" into the format field; returns false on other names
+bool ParseFrameFormat(const char* text, FrameExportOptions* options);
+
+// Parse "x,y,w,h" into the crop fields; returns false on malformed input
+bool ParseFrameCrop(const char* text, FrameExportOptions* options);
+
+// Start the encoder threads; returns NULL on failure
+FrameExporter* StartFrameExport(const World* world, const FrameExportOptions* options);
+
+// Queue a frame when the world's tick is due (call after UpdateGrid)
+void ExportFrame(FrameExporter* exporter, const World* world);
+
+// Wait for queued frames to be written, stop the threads and free the exporter
+void FinishFrameExport(FrameExporter* exporter, FrameExportStats* stats);
+
+#endif // FRAME_EXPORT_H
@@ -0,0 +1,271 @@
+#include "frame_publish.h"
+#include "palette.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#if !defined(_WIN32)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#define FRAME_PUBLISH_ALIGN 64
+#define FRAME_PUBLISH_MAX_NAME 64
+
+struct FramePublisher {
+    char name[FRAME_PUBLISH_MAX_NAME];
+    FrameSegmentHeader* header;
+    unsigned char* base;
+    size_t bytes;
+    int every;
+    FramePublishStats stats;
+};
+
+struct FrameSubscriber {
+    const FrameSegmentHeader* header;
+    const unsigned char* base;
+    size_t bytes;
+};
+
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static size_t AlignUp(size_t bytes) {
+    return (bytes + FRAME_PUBLISH_ALIGN - 1) & ~(size_t)(FRAME_PUBLISH_ALIGN - 1);
+}
+
+// Shared-memory object names start with a single slash
+static bool MakeSegmentName(const char* name, char* out) {
+    int written = snprintf(out, FRAME_PUBLISH_MAX_NAME, "%s%s", (name[0] == '/') ? "" : "/", name);
+    if (written <= 1 || written >= FRAME_PUBLISH_MAX_NAME || strchr(out + 1, '/') != NULL) {
+        printf("ERROR: Invalid shared memory name '%s'\n", name);
+        return false;
+    }
+    return true;
+}
+
+uint32_t FrameChecksum(const Color* colors, const unsigned char* types, int count, int tick) {
+    uint32_t hash = 2166136261u ^ (uint32_t)tick;
+    for (int i = 0; i < count; i++) {
+        uint32_t word = (uint32_t)colors[i].r | ((uint32_t)colors[i].g << 8) |
+                        ((uint32_t)colors[i].b << 16) | ((uint32_t)colors[i].a << 24);
+        hash = (hash ^ word) * 16777619u;
+        hash = (hash ^ types[i]) * 16777619u;
+    }
+    return hash;
+}
+
+#if defined(_WIN32)
+
+FramePublisher* StartFramePublish(const World* world, const char* name, int every) {
+    printf("ERROR: Frame publishing needs POSIX shared memory, which is not available on this platform\n");
+    return NULL;
+}
+
+void PublishFrame(FramePublisher* publisher, const World* world) {
+}
+
+void StopFramePublish(FramePublisher* publisher, FramePublishStats* stats) {
+    if (stats) memset(stats, 0, sizeof(*stats));
+}
+
+FrameSubscriber* AttachFramePublish(const char* name) {
+    printf("ERROR: Frame publishing needs POSIX shared memory, which is not available on this platform\n");
+    return NULL;
+}
+
+void DetachFramePublish(FrameSubscriber* subscriber) {
+}
+
+#else
+
+FramePublisher* StartFramePublish(const World* world, const char* name, int every) {
+    FramePublisher* p = (FramePublisher*)calloc(1, sizeof(FramePublisher));
+    if (!p) {
+        printf("ERROR: Failed to allocate frame publisher\n");
+        return NULL;
+    }
+    if (!MakeSegmentName(name, p->name)) {
+        free(p);
+        return NULL;
+    }
+
+    size_t cells = (size_t)world->width * world->height;
+    size_t slotOffset = AlignUp(sizeof(FrameSegmentHeader));
+    size_t slotBytes = AlignUp(cells * (sizeof(Color) + 1));
+    p->bytes = slotOffset + FRAME_PUBLISH_SLOTS * slotBytes;
+    p->every = (every > 0) ? every : 1;
+    BuildPalette();
+
+    // Start from a fresh object: viewers still mapping an old one keep their copy
+    shm_unlink(p->name);
+    int fd = shm_open(p->name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        printf("ERROR: Failed to create shared memory '%s'\n", p->name);
+        free(p);
+        return NULL;
+    }
+    void* mapped = MAP_FAILED;
+    if (ftruncate(fd, (off_t)p->bytes) == 0) {
+        mapped = mmap(NULL, p->bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        printf("ERROR: Failed to map %zu bytes of shared memory '%s'\n", p->bytes, p->name);
+        shm_unlink(p->name);
+        free(p);
+        return NULL;
+    }
+
+    p->base = (unsigned char*)mapped;
+    p->header = (FrameSegmentHeader*)mapped;
+    p->header->version = FRAME_PUBLISH_VERSION;
+    p->header->width = world->width;
+    p->header->height = world->height;
+    p->header->slotOffset = (uint32_t)slotOffset;
+    p->header->slotBytes = (uint32_t)slotBytes;
+    p->header->latest = FRAME_PUBLISH_NONE;
+    // Readers only trust the layout once the magic number is there
+    __atomic_store_n(&p->header->magic, FRAME_PUBLISH_MAGIC, __ATOMIC_RELEASE);
+
+    PublishFrame(p, world);
+    return p;
+}
+
+// Fill one slot under its sequence counter and make it the newest frame
+static void WriteSlot(FramePublisher* p, const World* world, uint32_t slot) {
+    FrameSlotHeader* slotHeader = &p->header->slots[slot];
+    int width = world->width;
+    int height = world->height;
+    Color* colors = (Color*)(p->base + p->header->slotOffset + (size_t)slot * p->header->slotBytes);
+    unsigned char* types = (unsigned char*)(colors + (size_t)width * height);
+
+    uint32_t sequence = slotHeader->sequence;
+    __atomic_store_n(&slotHeader->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    for (int y = 0; y < height; y++) {
+        FillCellColors(world, 0, y, colors + (size_t)y * width, width);
+        unsigned char* row = types + (size_t)y * width;
+        for (int x = 0; x < width; x++) {
+            row[x] = (unsigned char)GetCell(world, x, y)->type;
+        }
+    }
+    slotHeader->tick = world->tick;
+    slotHeader->checksum = FrameChecksum(colors, types, width * height, world->tick);
+
+    __atomic_store_n(&slotHeader->sequence, sequence + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&p->header->latest, slot, __ATOMIC_RELEASE);
+}
+
+void PublishFrame(FramePublisher* publisher, const World* world) {
+    if (!publisher) return;
+    if (world->tick % publisher->every != 0) {
+        publisher->stats.skipped++;
+        return;
+    }
+
+    // Never the newest slot, which is what readers pick up. With three slots a
+    // reader has two publish intervals to finish with a frame before it is reused.
+    double start = Now();
+    uint32_t latest = publisher->header->latest;
+    uint32_t slot = (latest == FRAME_PUBLISH_NONE) ? 0 : (latest + 1) % FRAME_PUBLISH_SLOTS;
+    WriteSlot(publisher, world, slot);
+    publisher->stats.published++;
+    publisher->stats.publishSeconds += Now() - start;
+}
+
+void StopFramePublish(FramePublisher* publisher, FramePublishStats* stats) {
+    if (stats) memset(stats, 0, sizeof(*stats));
+    if (!publisher) return;
+    if (stats) *stats = publisher->stats;
+
+    __atomic_store_n(&publisher->header->closed, 1, __ATOMIC_RELEASE);
+    munmap(publisher->base, publisher->bytes);
+    shm_unlink(publisher->name);
+    free(publisher);
+}
+
+FrameSubscriber* AttachFramePublish(const char* name) {
+    char segmentName[FRAME_PUBLISH_MAX_NAME];
+    if (!MakeSegmentName(name, segmentName)) return NULL;
+
+    int fd = shm_open(segmentName, O_RDONLY, 0);
+    if (fd < 0) return NULL;
+
+    struct stat info;
+    void* mapped = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && (size_t)info.st_size >= sizeof(FrameSegmentHeader)) {
+        mapped = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mapped == MAP_FAILED) return NULL;
+
+    const FrameSegmentHeader* header = (const FrameSegmentHeader*)mapped;
+    size_t bytes = (size_t)info.st_size;
+    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != FRAME_PUBLISH_MAGIC ||
+        header->version != FRAME_PUBLISH_VERSION || header->width <= 0 || header->height <= 0 ||
+        (size_t)header->slotBytes < (size_t)header->width * header->height * (sizeof(Color) + 1) ||
+        header->slotOffset + (size_t)FRAME_PUBLISH_SLOTS * header->slotBytes > bytes) {
+        munmap(mapped, bytes);
+        return NULL;
+    }
+
+    FrameSubscriber* s = (FrameSubscriber*)malloc(sizeof(FrameSubscriber));
+    if (!s) {
+        munmap(mapped, bytes);
+        return NULL;
+    }
+    s->header = header;
+    s->base = (const unsigned char*)mapped;
+    s->bytes = bytes;
+    return s;
+}
+
+void DetachFramePublish(FrameSubscriber* subscriber) {
+    if (!subscriber) return;
+    munmap((void*)subscriber->base, subscriber->bytes);
+    free(subscriber);
+}
+
+#endif
+
+bool BeginReadFrame(const FrameSubscriber* subscriber, PublishedFrame* frame) {
+    const FrameSegmentHeader* header = subscriber->header;
+
+    // The newest slot can only be mid-write if the publisher lapped us since
+    // reading latest; look again in that case
+    for (int attempt = 0; attempt < FRAME_PUBLISH_SLOTS; attempt++) {
+        uint32_t slot = __atomic_load_n(&header->latest, __ATOMIC_ACQUIRE);
+        if (slot >= FRAME_PUBLISH_SLOTS) return false;
+
+        uint32_t sequence = __atomic_load_n(&header->slots[slot].sequence, __ATOMIC_ACQUIRE);
+        if (sequence & 1) continue;
+
+        const unsigned char* data = subscriber->base + header->slotOffset + (size_t)slot * header->slotBytes;
+        frame->width = header->width;
+        frame->height = header->height;
+        frame->tick = header->slots[slot].tick;
+        frame->checksum = header->slots[slot].checksum;
+        frame->colors = (const Color*)data;
+        frame->types = data + (size_t)header->width * header->height * sizeof(Color);
+        frame->slot = (int)slot;
+        frame->sequence = sequence;
+        return true;
+    }
+    return false;
+}
+
+bool EndReadFrame(const FrameSubscriber* subscriber, const PublishedFrame* frame) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&subscriber->header->slots[frame->slot].sequence, __ATOMIC_RELAXED) == frame->sequence;
+}
+
+bool IsFramePublishClosed(const FrameSubscriber* subscriber) {
+    return __atomic_load_n(&subscriber->header->closed, __ATOMIC_ACQUIRE) != 0;
+}
@@ -0,0 +1,91 @@
+#ifndef FRAME_PUBLISH_H
+#define FRAME_PUBLISH_H
+
+#include "grid.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Live frames for an out-of-process viewer. The simulation writes the color and
+// cell type planes of the whole grid into a POSIX shared-memory segment holding
+// FRAME_PUBLISH_SLOTS frames. Every slot is guarded by a sequence counter that is
+// odd while the slot is being written (a seqlock), and the writer always fills
+// a slot other than the newest one, so it never waits for a reader. Readers map
+// the segment read-only and use the newest slot in place, then check its
+// sequence counter to find out whether the frame was overwritten meanwhile.
+#define FRAME_PUBLISH_SLOTS 3
+#define FRAME_PUBLISH_MAGIC 0x53444E53u   // "SNDS"
+#define FRAME_PUBLISH_VERSION 1
+#define FRAME_PUBLISH_NONE 0xFFFFFFFFu    // no frame published yet
+
+typedef struct {
+    uint32_t sequence;      // even when the slot holds a complete frame
+    int32_t tick;
+    uint32_t checksum;      // FrameChecksum of the slot, for readers checking consistency
+    uint32_t reserved;
+} FrameSlotHeader;
+
+// Start of the shared segment, followed by the slots at slotOffset + n * slotBytes.
+// A slot holds width * height Colors followed by width * height cell types, one
+// byte each (the border type -1 is stored as 255).
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    int32_t width;
+    int32_t height;
+    uint32_t slotOffset;
+    uint32_t slotBytes;
+    uint32_t latest;        // slot of the newest complete frame, or FRAME_PUBLISH_NONE
+    uint32_t closed;        // set when the publisher stopped
+    FrameSlotHeader slots[FRAME_PUBLISH_SLOTS];
+} FrameSegmentHeader;
+
+typedef struct {
+    int published;
+    int skipped;            // ticks that were not due (see every)
+    double publishSeconds;  // time spent on the simulation thread
+} FramePublishStats;
+
+// A frame borrowed from the shared segment, valid until EndReadFrame says otherwise
+typedef struct {
+    int width;
+    int height;
+    int tick;
+    uint32_t checksum;
+    const Color* colors;
+    const unsigned char* types;
+    int slot;
+    uint32_t sequence;
+} PublishedFrame;
+
+typedef struct FramePublisher FramePublisher;
+typedef struct FrameSubscriber FrameSubscriber;
+
+// Create the shared segment (name like "/sandbox", a missing slash is added) and
+// publish the current state; every is the number of ticks between frames.
+// Returns NULL on failure.
+FramePublisher* StartFramePublish(const World* world, const char* name, int every);
+
+// Publish a frame when the world's tick is due (call after UpdateGrid)
+void PublishFrame(FramePublisher* publisher, const World* world);
+
+// Mark the segment closed, unlink it and free the publisher
+void StopFramePublish(FramePublisher* publisher, FramePublishStats* stats);
+
+// Map a publisher's segment read-only; returns NULL when it does not exist
+FrameSubscriber* AttachFramePublish(const char* name);
+
+// Borrow the newest complete frame; returns false when there is none yet
+bool BeginReadFrame(const FrameSubscriber* subscriber, PublishedFrame* frame);
+
+// True when the borrowed frame was not touched by the publisher while it was used
+bool EndReadFrame(const FrameSubscriber* subscriber, const PublishedFrame* frame);
+
+// True once the publisher has stopped
+bool IsFramePublishClosed(const FrameSubscriber* subscriber);
+
+// Hash of a frame's planes and tick, as stored in FrameSlotHeader.checksum
+uint32_t FrameChecksum(const Color* colors, const unsigned char* types, int count, int tick);
+
+void DetachFramePublish(FrameSubscriber* subscriber);
+
+#endif // FRAME_PUBLISH_H
@@ -1,95 +1,358 @@
 #include "grid.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#if defined(_WIN32)
+    #include <malloc.h>
+#else
+    #include <sys/mman.h>
+#endif
 #include "src/cell_defaults.h"
+#include "src/cell_rules.h"
+#include "src/fluid.h"
+#include "src/telemetry.h"
+#include "src/update_water.h"
+#include "src/organisms.h"
+#include "src/dirty_tiles.h"
+#include "src/region_stats.h"
+#include "src/chunk_summary.h"
 
-// Grid constants
-int CELL_SIZE = 8;
-int GRID_WIDTH = 1920 * 2 / 8; // Double the width
-int GRID_HEIGHT = 1080 * 2 / 8; // Double the height
+// Default values for the tunable constants
+SimParams DefaultSimParams(void) {
+    SimParams params;
+    params.saturationBase = 60;
+    params.saturationPerDegree = 2;
+    params.absorbCap = 4;
+    params.waterDiagonalChance = 50;
+    params.waterSpreadChance = 50;
+    return params;
+}
+
+static const char* gridLayoutNames[GRID_LAYOUT_COUNT] = { "rows", "tiles", "morton" };
 
-// Grid data
-GridCell** grid = NULL;
+const char* GetGridLayoutName(int layout) {
+    return (layout >= 0 && layout < GRID_LAYOUT_COUNT) ? gridLayoutNames[layout] : "unknown";
+}
 
-// Initialize the grid
-void InitGrid(void) {
-    grid = (GridCell**)malloc(GRID_HEIGHT * sizeof(GridCell*));
-    if (!grid) {
-        printf("ERROR: Failed to allocate memory for grid rows\n");
-        return;
+int ParseGridLayout(const char* name) {
+    for (int i = 0; i < GRID_LAYOUT_COUNT; i++) {
+        if (strcmp(name, gridLayoutNames[i]) == 0) return i;
     }
-    
-    for(int i = 0; i < GRID_HEIGHT; i++) {
-        grid[i] = (GridCell*)malloc(GRID_WIDTH * sizeof(GridCell));
-        if (!grid[i]) {
-            printf("ERROR: Failed to allocate memory for grid row %d\n", i);
-            // Clean up already allocated rows
-            for (int j = 0; j < i; j++) {
-                free(grid[j]);
-            }
-            free(grid);
-            grid = NULL;
-            return;
+    return -1;
+}
+
+// Round up to a multiple of 'step'
+static size_t RoundUp(size_t value, size_t step) {
+    return (value + step - 1) / step * step;
+}
+
+// Cells between the starts of consecutive rows of the row-major layout: the
+// smallest padding that starts every row on a cache line
+static int GridRowStride(int width) {
+    int cellsPerLine = 1;
+    while ((cellsPerLine * sizeof(GridCell)) % GRID_ROW_ALIGNMENT != 0) {
+        cellsPerLine++;
+    }
+    return (int)RoundUp(width, cellsPerLine);
+}
+
+// Cells stored for a world, including row and tile padding. A tile or chunk of
+// cells is always a whole number of cache lines.
+static size_t GridCellCount(int layout, int width, int height) {
+    switch (layout) {
+        case GRID_LAYOUT_TILES:
+            return RoundUp(width, GRID_TILE_SIZE) * RoundUp(height, GRID_TILE_SIZE);
+        case GRID_LAYOUT_MORTON:
+            return RoundUp(width, GRID_MORTON_SIZE) * RoundUp(height, GRID_MORTON_SIZE);
+    }
+    return (size_t)GridRowStride(width) * height;
+}
+
+// Size of the grid arena: the cells, then the row and column offset tables and
+// the row temperatures
+static size_t GridArenaBytes(int layout, int width, int height) {
+    size_t bytes = RoundUp(GridCellCount(layout, width, height) * sizeof(GridCell), GRID_ROW_ALIGNMENT) +
+                   ((size_t)width + 2 * (size_t)height) * sizeof(int);
+    if (bytes >= GRID_HUGE_PAGE_SIZE) {
+        // Whole huge pages, so the kernel can back the arena with them
+        bytes = RoundUp(bytes, GRID_HUGE_PAGE_SIZE);
+    }
+    return bytes;
+}
+
+size_t GetGridBytes(const World* world) {
+    return GridArenaBytes(world->layout, world->width, world->height);
+}
+
+size_t GetGridCellCount(const World* world) {
+    return GridCellCount(world->layout, world->width, world->height);
+}
+
+// Spread the bits of v apart so that x and y interleave (bit i moves to bit 2i)
+static int SpreadBits(int v) {
+    int spread = 0;
+    for (int bit = 0; bit < 8; bit++) {
+        spread |= ((v >> bit) & 1) << (2 * bit);
+    }
+    return spread;
+}
+
+// Fill the offset tables so that rowOffset[y] + colOffset[x] is the index of (x, y)
+static void BuildGridOffsets(World* world) {
+    int tileCells = GRID_TILE_SIZE * GRID_TILE_SIZE;
+    int chunkCells = GRID_MORTON_SIZE * GRID_MORTON_SIZE;
+    int tilesX = (world->width + GRID_TILE_SIZE - 1) / GRID_TILE_SIZE;
+    int chunksX = (world->width + GRID_MORTON_SIZE - 1) / GRID_MORTON_SIZE;
+    int stride = GridRowStride(world->width);
+
+    for (int y = 0; y < world->height; y++) {
+        switch (world->layout) {
+            case GRID_LAYOUT_TILES:
+                world->rowOffset[y] = (y / GRID_TILE_SIZE) * tilesX * tileCells + (y % GRID_TILE_SIZE) * GRID_TILE_SIZE;
+                break;
+            case GRID_LAYOUT_MORTON:
+                world->rowOffset[y] = (y / GRID_MORTON_SIZE) * chunksX * chunkCells + (SpreadBits(y % GRID_MORTON_SIZE) << 1);
+                break;
+            default:
+                world->rowOffset[y] = y * stride;
+                break;
+        }
+    }
+    for (int x = 0; x < world->width; x++) {
+        switch (world->layout) {
+            case GRID_LAYOUT_TILES:
+                world->colOffset[x] = (x / GRID_TILE_SIZE) * tileCells + x % GRID_TILE_SIZE;
+                break;
+            case GRID_LAYOUT_MORTON:
+                world->colOffset[x] = (x / GRID_MORTON_SIZE) * chunkCells + SpreadBits(x % GRID_MORTON_SIZE);
+                break;
+            default:
+                world->colOffset[x] = x;
+                break;
         }
-        
-        for(int j = 0; j < GRID_WIDTH; j++) {
+    }
+}
+
+static void* AllocateArena(size_t bytes, size_t alignment) {
+#if defined(_WIN32)
+    return _aligned_malloc(bytes, alignment);
+#else
+    void* arena = NULL;
+    return (posix_memalign(&arena, alignment, bytes) == 0) ? arena : NULL;
+#endif
+}
+
+static void FreeArena(void* arena) {
+#if defined(_WIN32)
+    _aligned_free(arena);
+#else
+    free(arena);
+#endif
+}
+
+// Allocate the whole grid as one aligned arena in the world's layout.
+// Large arenas are aligned to and advised for transparent huge pages. The cells
+// are left uninitialized; the caller fills or copies them.
+static bool AllocateGrid(World* world) {
+    size_t bytes = GridArenaBytes(world->layout, world->width, world->height);
+    size_t alignment = (bytes >= GRID_HUGE_PAGE_SIZE) ? GRID_HUGE_PAGE_SIZE : GRID_ROW_ALIGNMENT;
+    unsigned char* arena = (unsigned char*)AllocateArena(bytes, alignment);
+    if (!arena) {
+        printf("ERROR: Failed to allocate memory for grid\n");
+        world->cells = NULL;
+        return false;
+    }
+#if defined(MADV_HUGEPAGE)
+    if (alignment == GRID_HUGE_PAGE_SIZE) {
+        madvise(arena, bytes, MADV_HUGEPAGE);  // Only a hint, fine if it fails
+    }
+#endif
+
+    size_t cellBytes = RoundUp(GridCellCount(world->layout, world->width, world->height) * sizeof(GridCell), GRID_ROW_ALIGNMENT);
+    world->cells = (GridCell*)arena;
+    world->rowOffset = (int*)(arena + cellBytes);
+    world->colOffset = world->rowOffset + world->height;
+    world->rowTemperature = world->colOffset + world->width;
+    BuildGridOffsets(world);
+    return true;
+}
+
+// Initialize a world with row-major cells
+bool InitWorld(World* world, int width, int height, unsigned int seed) {
+    return InitWorldWithLayout(world, width, height, seed, GRID_LAYOUT_ROWS);
+}
+
+// Initialize a world: allocate its grid, fill it with air and set up the solvers
+bool InitWorldWithLayout(World* world, int width, int height, unsigned int seed, int layout) {
+    world->layout = (layout >= 0 && layout < GRID_LAYOUT_COUNT) ? layout : GRID_LAYOUT_ROWS;
+    world->width = width;
+    world->height = height;
+    // Spread small seeds across the state; xorshift needs a non-zero state
+    world->rngState = seed * 2654435761u + 0x9E3779B9u;
+    if (world->rngState == 0) world->rngState = 1;
+    world->randomKey = ((uint64_t)seed << 32 | seed) * 0x9E3779B97F4A7C15ull + 0xD1B54A32D192ED03ull;
+    world->tick = 0;
+    world->waterModel = WATER_MODEL_CELLULAR;
+    world->params = DefaultSimParams();
+    world->lod = (SimLOD){ 1, 0, 0, 0, 0 };
+    world->fluid = NULL;
+    world->telemetry = NULL;
+    world->organisms = NULL;
+    world->dirty = NULL;
+    world->regionStats = NULL;
+    world->summaries = NULL;
+
+    if (!AllocateGrid(world)) {
+        return false;
+    }
+    
+    for(int i = 0; i < height; i++) {
+        for(int j = 0; j < width; j++) {
             // Use the default initializer for consistent cell setup
-            InitializeCellDefaults(&grid[i][j], CELL_TYPE_AIR);
-            
-            // Update position based on grid coordinates
-            grid[i][j].position = (Vector2){j * CELL_SIZE, i * CELL_SIZE};
+            InitializeCellDefaults(GetCell(world, j, i), CELL_TYPE_AIR);
             
             // Make border cells immutable
-            if (i == 0 || i == GRID_HEIGHT-1 || j == 0 || j == GRID_WIDTH-1) {
-                grid[i][j].type = CELL_TYPE_BORDER;
+            if (i == 0 || i == height-1 || j == 0 || j == width-1) {
+                GetCell(world, j, i)->type = CELL_TYPE_BORDER;
             }
         }
     }
     
     // After all cells are initialized, set up the temperature gradient
-    InitializeTemperatureGradient();
+    InitializeTemperatureGradient(world);
+
+    // Build the lookup kernels for rule-driven materials (shared by all worlds)
+    CompileCellRules();
+
+    // Allocate the pressure solver for the mass-based water model
+    InitFluid(world);
+
+    // Start a fresh telemetry history for the new grid
+    InitTelemetry(world);
+
+    // Empty organism table for plants and moss
+    InitOrganisms(world);
+
+    // Every tile starts out dirty so the first frame draws everything
+    InitDirtyTiles(world);
+
+    // Bounds that let threshold checks skip tiles, built on first use
+    InitChunkSummaries(world);
     
     printf("Grid initialized with temperature gradient\n");
+    return true;
+}
+
+// Allocate a world of the same size as src and copy its state. The copy has no
+// dirty map, since nothing draws it (used for rewind keyframes).
+bool CloneWorld(World* dst, const World* src) {
+    *dst = *src;
+    dst->fluid = NULL;
+    dst->telemetry = NULL;
+    dst->organisms = NULL;
+    dst->dirty = NULL;
+    dst->regionStats = NULL;
+    dst->summaries = NULL;
+    if (!AllocateGrid(dst)) {
+        return false;
+    }
+
+    if (src->fluid) InitFluid(dst);
+    InitTelemetry(dst);
+    InitOrganisms(dst);
+    if ((src->fluid && !dst->fluid) || !dst->telemetry || !dst->organisms || !CopyWorldState(dst, src)) {
+        CleanupWorld(dst);
+        return false;
+    }
+    return true;
+}
+
+// Overwrite a world with the state of another of the same size, so that it
+// continues exactly as src would
+bool CopyWorldState(World* dst, const World* src) {
+    if (dst->width != src->width || dst->height != src->height) return false;
+
+    if (dst->layout == src->layout) {
+        memcpy(dst->cells, src->cells, GridCellCount(src->layout, src->width, src->height) * sizeof(GridCell));
+    } else {
+        for (int y = 0; y < src->height; y++) {
+            for (int x = 0; x < src->width; x++) {
+                *GetCell(dst, x, y) = *GetCell(src, x, y);
+            }
+        }
+    }
+    memcpy(dst->rowTemperature, src->rowTemperature, src->height * sizeof(int));
+    dst->rngState = src->rngState;
+    dst->randomKey = src->randomKey;
+    dst->tick = src->tick;
+    dst->waterModel = src->waterModel;
+    dst->params = src->params;
+    dst->lod = src->lod;
+
+    CopyFluid(dst, src);
+    CopyTelemetry(dst, src);
+    if (!CopyOrganisms(dst, src)) return false;
+
+    // Every cell may have changed
+    MarkAllDirty(dst);
+    return true;
 }
 
-// Add the function definition after InitGrid
-void InitializeTemperatureGradient(void) {
+// Add the function definition after InitWorld
+void InitializeTemperatureGradient(World* world) {
     const float baseTemp = 18.0f;     // Bottom temperature in Celsius
     const float topTemp = 5.0f;       // Top temperature in Celsius
     const float tempRange = baseTemp - topTemp;
     
-    for(int y = 0; y < GRID_HEIGHT; y++) {
+    for(int y = 0; y < world->height; y++) {
         // Calculate temperature based on y position (cooler at top)
-        float tempAtHeight = baseTemp - (tempRange * (float)y / GRID_HEIGHT);
-        
-        for(int x = 0; x < GRID_WIDTH; x++) {
-            grid[y][x].temperature = tempAtHeight;
-        }
+        float tempAtHeight = baseTemp - (tempRange * (float)y / world->height);
+        world->rowTemperature[y] = (int)tempAtHeight;
     }
     
     printf("Temperature gradient initialized (%.1f°C to %.1f°C)\n", baseTemp, topTemp);
 }
 
-// Clean up the grid when program ends
-void CleanupGrid(void) {
-    if (grid) {
-        for(int i = 0; i < GRID_HEIGHT; i++) {
-            if (grid[i]) {
-                free(grid[i]);
-            }
-        }
-        free(grid);
-        grid = NULL;
+// Release everything owned by a world
+void CleanupWorld(World* world) {
+    CleanupFluid(world);
+    CleanupTelemetry(world);
+    CleanupOrganisms(world);
+    CleanupDirtyTiles(world);
+    CleanupRegionStats(world);
+    CleanupChunkSummaries(world);
+
+    // The cells and their offset tables share one arena
+    FreeArena(world->cells);
+    world->cells = NULL;
+    world->rowOffset = NULL;
+    world->colOffset = NULL;
+}
+
+// Per-world xorshift random stream, same contract as GetRandomValue (inclusive range)
+int WorldRandom(World* world, int min, int max) {
+    if (min > max) {
+        int temp = max;
+        max = min;
+        min = temp;
     }
+
+    uint32_t x = world->rngState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    world->rngState = x;
+
+    return min + (int)(x % (uint32_t)(max - min + 1));
 }
 
 // Calculate total moisture in the system
-int CalculateTotalMoisture(void) {
+int CalculateTotalMoisture(const World* world) {
     int totalMoisture = 0;
     
-    for(int y = 0; y < GRID_HEIGHT; y++) {
-        for(int x = 0; x < GRID_WIDTH; x++) {
-            totalMoisture += grid[y][x].moisture;
+    for(int y = 0; y < world->height; y++) {
+        for(int x = 0; x < world->width; x++) {
+            totalMoisture += GetCell(world, x, y)->moisture;
         }
     }
     
@@ -97,12 +360,12 @@ int CalculateTotalMoisture(void) {
 }
 
 // Check if a tile is a border or out of bounds
-bool IsBorderTile(int x, int y) {
-    return (x < 1 || x >= GRID_WIDTH - 1 || y < 1 || y >= GRID_HEIGHT - 1 || 
-            grid[y][x].type == CELL_TYPE_BORDER);
+bool IsBorderTile(const World* world, int x, int y) {
+    return (x < 1 || x >= world->width - 1 || y < 1 || y >= world->height - 1 || 
+            GetCell(world, x, y)->type == CELL_TYPE_BORDER);
 }
 
 // Check if we can move to a tile
-bool CanMoveTo(int x, int y) {
-    return !IsBorderTile(x, y);
+bool CanMoveTo(const World* world, int x, int y) {
+    return !IsBorderTile(world, x, y);
 }
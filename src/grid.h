@@ -2,24 +2,154 @@
 #define GRID_H
 
 #include "cell_types.h"
+#include <stdint.h>
+#include <stddef.h>
 
-// Grid constants
-extern  int CELL_SIZE;
-extern  int GRID_WIDTH;
-extern  int GRID_HEIGHT;
+// Default world dimensions
+#define DEFAULT_GRID_WIDTH (1920 * 2 / 8)  // Double the width
+#define DEFAULT_GRID_HEIGHT (1080 * 2 / 8) // Double the height
 
-// Grid data
-extern GridCell** grid;
+// Grid arena layout: rows and tiles start on cache lines, and large grids are
+// backed by huge pages
+#define GRID_ROW_ALIGNMENT 64
+#define GRID_HUGE_PAGE_SIZE (2 * 1024 * 1024)
 
-// Grid initialization and utility functions
-void InitGrid(void);
-void CleanupGrid(void);
-int CalculateTotalMoisture(void);
+// Storage orders for a world's cells, all addressed through GetCell
+#define GRID_LAYOUT_ROWS 0    // row-major, rows padded to cache lines
+#define GRID_LAYOUT_TILES 1   // GRID_TILE_SIZE square tiles, row-major inside each tile
+#define GRID_LAYOUT_MORTON 2  // GRID_MORTON_SIZE square chunks, Z-order inside each chunk
+#define GRID_LAYOUT_COUNT 3
+#define GRID_TILE_SIZE 8
+#define GRID_MORTON_SIZE 16
+
+// Rule probabilities that can be tuned per world (see CellRule.chanceParam)
+#define RULE_CHANCE_FIXED 0           // use the chance stored in the rule
+#define RULE_CHANCE_WATER_DIAGONAL 1  // water picking the left diagonal when both are open
+#define RULE_CHANCE_WATER_SPREAD 2    // water picking the left side when spreading
+
+// What a counter-based random number (CellRandom) decides. Each decision about a
+// cell on a tick draws from its own stream, independent of every other draw.
+enum {
+    RANDOM_WATER_SCAN,        // scan direction of the water rules (once per tick)
+    RANDOM_WATER_CHOICE,      // water picking between two moves
+    RANDOM_SOIL_SCAN,         // scan direction of the soil pass (once per tick)
+    RANDOM_SOIL_DIAGONAL,     // soil picking a diagonal
+    RANDOM_AIR_DIAGONAL,      // rising air picking a diagonal
+    RANDOM_EVAPORATE,         // whether a water cell evaporates
+    RANDOM_EVAPORATE_AMOUNT,  // how much it evaporates
+    RANDOM_TICK_X,            // random-tick sample positions (per chunk and sample)
+    RANDOM_TICK_Y,
+    RANDOM_PLACE_MOISTURE,    // initial contents of a placed or grown cell
+    RANDOM_PLACE_ENERGY,
+    RANDOM_PLACE_VARIATION,
+    RANDOM_ORGANISM_SCHEDULE, // organisms, keyed on their first cell
+    RANDOM_ORGANISM_ABSORB,
+    RANDOM_ORGANISM_GROW,
+    RANDOM_ORGANISM_DIRECTION,
+};
+
+// Tunable simulation constants
+typedef struct {
+    int saturationBase;       // air saturation limit at 0 degrees (UpdateAir)
+    int saturationPerDegree;  // extra saturation per degree of temperature
+    int absorbCap;            // most moisture moved by one AbsorbMoisture call
+    int waterDiagonalChance;  // % chance for RULE_CHANCE_WATER_DIAGONAL
+    int waterSpreadChance;    // % chance for RULE_CHANCE_WATER_SPREAD
+} SimParams;
+
+// Simulation level of detail (see sim_lod.h)
+typedef struct {
+    int interval;             // ticks between updates of tiles outside the focus, 1 for every tick
+    int x0, y0, x1, y1;       // focus rectangle, updated every tick
+} SimLOD;
+
+// A self-contained simulation instance. Every simulation function takes the
+// world it operates on, so several worlds can run side by side in one process.
+typedef struct World {
+    GridCell* cells;        // cell storage in the order of 'layout' (use GetCell)
+    int* rowOffset;         // index of row y's contribution to a cell's position in 'cells'
+    int* colOffset;         // index of column x's contribution
+    int* rowTemperature;    // temperature of row y, shared by every cell in it
+    int layout;             // GRID_LAYOUT_* of the cells
+    int width;
+    int height;
+    uint32_t rngState;      // per-world random stream for scene setup (WorldRandom)
+    uint64_t randomKey;     // key of the counter-based random numbers (CellRandom)
+    int tick;               // number of UpdateGrid calls so far
+    int waterModel;         // WATER_MODEL_* in use
+    SimParams params;
+    SimLOD lod;             // which tiles update at a reduced rate
+    struct FluidState* fluid;         // pressure solver buffers
+    struct TelemetryState* telemetry; // recorded statistics
+    struct OrganismTable* organisms;  // plants and moss colonies
+    struct DirtyMap* dirty;           // tiles changed since the renderer last looked
+    struct RegionStats* regionStats;  // summed-area tables for region queries, optional
+    struct ChunkSummaries* summaries; // per-tile bounds for threshold checks
+} World;
+
+// The cell at (x, y). Every layout splits a cell's index into a row and a column
+// part, so the lookup is the same two table reads whatever the storage order.
+static inline GridCell* GetCell(const World* world, int x, int y) {
+    return &world->cells[world->rowOffset[y] + world->colOffset[x]];
+}
+
+// Temperature at row y. It only depends on height, so cells keep no copy of it.
+static inline int GetRowTemperature(const World* world, int y) {
+    return world->rowTemperature[y];
+}
+
+// Counter-based random bits: a pure function of (world seed, tick, x, y, purpose),
+// so a cell's random decisions do not depend on the order cells are updated in
+static inline uint32_t CellRandomBits(const World* world, int x, int y, int purpose) {
+    uint64_t h = world->randomKey ^ ((uint64_t)(uint32_t)world->tick << 32 | (uint32_t)purpose);
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+    h ^= ((uint64_t)(uint32_t)y << 32 | (uint32_t)x) + (h >> 31);
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+    return (uint32_t)((h ^ (h >> 31)) >> 32);
+}
+
+// Counter-based random integer in [min, max], same contract as WorldRandom
+static inline int CellRandom(const World* world, int x, int y, int purpose, int min, int max) {
+    if (min > max) {
+        int temp = max;
+        max = min;
+        min = temp;
+    }
+    uint64_t range = (uint64_t)((int64_t)max - min + 1);
+    return min + (int)(((uint64_t)CellRandomBits(world, x, y, purpose) * range) >> 32);
+}
+
+// Default values for the tunable constants
+SimParams DefaultSimParams(void);
+
+// World initialization and utility functions
+bool InitWorld(World* world, int width, int height, unsigned int seed);
+bool InitWorldWithLayout(World* world, int width, int height, unsigned int seed, int layout);
+void CleanupWorld(World* world);
+
+// Deep copies of a world's state (grid, random stream, solvers, organisms, telemetry)
+bool CloneWorld(World* dst, const World* src);
+bool CopyWorldState(World* dst, const World* src);  // sizes must match, layouts may differ
+
+// Bytes taken by a world's grid arena (cells, offset and temperature tables)
+size_t GetGridBytes(const World* world);
+
+// Cells stored in world->cells, padding included (same for worlds of one size and layout)
+size_t GetGridCellCount(const World* world);
+
+// Layout names for command line options ("rows", "tiles", "morton"); -1 if unknown
+const char* GetGridLayoutName(int layout);
+int ParseGridLayout(const char* name);
+
+int WorldRandom(World* world, int min, int max);
+int CalculateTotalMoisture(const World* world);
 int ClampMoisture(int value);
-bool IsBorderTile(int x, int y);
-bool CanMoveTo(int x, int y);
+bool IsBorderTile(const World* world, int x, int y);
+bool CanMoveTo(const World* world, int x, int y);
 
-// Initialize temperature gradient for all cells
-void InitializeTemperatureGradient(void);
+// Initialize the temperature gradient of all rows
+void InitializeTemperatureGradient(World* world);
 
 #endif // GRID_H
@@ -0,0 +1,284 @@
+#include "headless.h"
+#include "grid.h"
+#include "cell_types.h"
+#include "cell_actions.h"
+#include "simulation.h"
+#include "telemetry.h"
+#include "color_pyramid.h"
+#include "rewind.h"
+#include "frame_export.h"
+#include "frame_publish.h"
+#include "sim_lod.h"
+#include "world_gen.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// Build a small reproducible scene: a soil floor, rocks, and a body of water above it
+void SeedDemoScene(World* world) {
+    int floorY = world->height - world->height / 6;
+    for (int x = 1; x < world->width - 1; x += 8) {
+        PlaceCircularPattern(world, x, floorY + WorldRandom(world, 0, 8), CELL_TYPE_SOIL, 12);
+    }
+    for (int i = 0; i < 6; i++) {
+        PlaceCircularPattern(world, WorldRandom(world, 20, world->width - 20), floorY - 10, CELL_TYPE_ROCK, 6);
+    }
+    PlaceCircularPattern(world, world->width / 2, world->height / 3, CELL_TYPE_WATER, 30);
+}
+
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int RunHeadless(int argc, char** argv) {
+    int ticks = 1000;
+    int seed = 1;
+    int interval = TELEMETRY_DEFAULT_INTERVAL;
+    const char* csvPath = NULL;
+    const char* binPath = NULL;
+    int seekTick = -1;
+    FrameExportOptions frameOptions = DefaultFrameExportOptions();
+    bool exportFrames = false;
+    const char* publishName = NULL;
+    int publishEvery = 1;
+    int layout = GRID_LAYOUT_ROWS;
+    int focus[4] = { 0, 0, 0, 0 };
+    bool hasFocus = false;
+    int lodInterval = SIM_LOD_DEFAULT_INTERVAL;
+    int width = DEFAULT_GRID_WIDTH;
+    int height = DEFAULT_GRID_HEIGHT;
+    bool generate = false;
+    int generateThreads = 0;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = (i + 1 < argc);
+        if (strcmp(argv[i], "--ticks") == 0 && hasValue) {
+            ticks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            seed = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--interval") == 0 && hasValue) {
+            interval = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--telemetry") == 0 && hasValue) {
+            csvPath = argv[++i];
+        } else if (strcmp(argv[i], "--telemetry-bin") == 0 && hasValue) {
+            binPath = argv[++i];
+        } else if (strcmp(argv[i], "--layout") == 0 && hasValue) {
+            layout = ParseGridLayout(argv[++i]);
+            if (layout < 0) {
+                printf("ERROR: Unknown grid layout '%s'\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--size") == 0 && hasValue) {
+            if (sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width < 3 || height < 3) {
+                printf("ERROR: Invalid world size '%s', expected WxH\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--generate") == 0) {
+            generate = true;
+        } else if (strcmp(argv[i], "--generate-threads") == 0 && hasValue) {
+            generateThreads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--lod-focus") == 0 && hasValue) {
+            if (sscanf(argv[++i], "%d,%d,%d,%d", &focus[0], &focus[1], &focus[2], &focus[3]) != 4 ||
+                focus[2] <= 0 || focus[3] <= 0) {
+                printf("ERROR: Invalid focus region '%s', expected x,y,width,height\n", argv[i]);
+                return 1;
+            }
+            hasFocus = true;
+        } else if (strcmp(argv[i], "--lod-interval") == 0 && hasValue) {
+            lodInterval = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seek") == 0 && hasValue) {
+            seekTick = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--frames") == 0 && hasValue) {
+            frameOptions.directory = argv[++i];
+            exportFrames = true;
+        } else if (strcmp(argv[i], "--publish") == 0 && hasValue) {
+            publishName = argv[++i];
+        } else if (strcmp(argv[i], "--publish-every") == 0 && hasValue) {
+            publishEvery = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--frame-every") == 0 && hasValue) {
+            frameOptions.every = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--frame-scale") == 0 && hasValue) {
+            frameOptions.scale = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--frame-threads") == 0 && hasValue) {
+            frameOptions.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--frame-queue") == 0 && hasValue) {
+            frameOptions.queueSize = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--frame-format") == 0 && hasValue) {
+            if (!ParseFrameFormat(argv[++i], &frameOptions)) {
+                printf("ERROR: Unknown frame format '%s', expected ppm or qoi\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--frame-crop") == 0 && hasValue) {
+            if (!ParseFrameCrop(argv[++i], &frameOptions)) {
+                printf("ERROR: Invalid frame region '%s', expected x,y,width,height\n", argv[i]);
+                return 1;
+            }
+        }
+    }
+
+    FILE* csvFile = NULL;
+    FILE* binFile = NULL;
+    if (csvPath) {
+        csvFile = fopen(csvPath, "w");
+        if (!csvFile) {
+            printf("ERROR: Failed to open telemetry file %s\n", csvPath);
+            return 1;
+        }
+        WriteTelemetryCSVHeader(csvFile);
+    }
+    if (binPath) {
+        binFile = fopen(binPath, "wb");
+        if (!binFile) {
+            printf("ERROR: Failed to open telemetry file %s\n", binPath);
+            if (csvFile) fclose(csvFile);
+            return 1;
+        }
+        WriteTelemetryBinaryHeader(binFile);
+    }
+
+    World world;
+    if (!InitWorldWithLayout(&world, width, height, (unsigned int)seed, layout)) {
+        if (csvFile) fclose(csvFile);
+        if (binFile) fclose(binFile);
+        return 1;
+    }
+    SetTelemetryInterval(&world, interval);
+    if (generate) {
+        WorldGenOptions genOptions = DefaultWorldGenOptions((unsigned int)seed);
+        genOptions.threads = generateThreads;
+        WorldGenStats genStats;
+        if (!GenerateWorld(&world, &genOptions, &genStats)) {
+            if (csvFile) fclose(csvFile);
+            if (binFile) fclose(binFile);
+            CleanupWorld(&world);
+            return 1;
+        }
+        printf("Generated %dx%d world in %.1f ms on %d threads (%d chunks): %d water, %d soil, %d rock cells\n",
+               width, height, genStats.seconds * 1000.0, genStats.threads, genStats.chunks,
+               genStats.cells[CELL_TYPE_WATER], genStats.cells[CELL_TYPE_SOIL], genStats.cells[CELL_TYPE_ROCK]);
+    } else {
+        SeedDemoScene(&world);
+    }
+    int startMoisture = CalculateTotalMoisture(&world);
+    if (hasFocus) {
+        SetSimulationFocus(&world, focus[0], focus[1], focus[0] + focus[2], focus[1] + focus[3], 0, lodInterval);
+    }
+
+    // With --seek, record the run and jump back to a tick at the end
+    RewindBuffer rewind;
+    bool rewinding = (seekTick >= 0) && InitRewind(&rewind, &world, REWIND_DEFAULT_INTERVAL, REWIND_DEFAULT_BUDGET);
+    int seekMoisture = (seekTick == 0) ? CalculateTotalMoisture(&world) : -1;
+
+    // Frames are encoded on background threads while the simulation keeps running
+    FrameExporter* exporter = NULL;
+    if (exportFrames) {
+        exporter = StartFrameExport(&world, &frameOptions);
+        if (!exporter) {
+            if (rewinding) CleanupRewind(&rewind);
+            if (csvFile) fclose(csvFile);
+            if (binFile) fclose(binFile);
+            CleanupWorld(&world);
+            return 1;
+        }
+        ExportFrame(exporter, &world);
+    }
+
+    // Live frames for --viewer processes, written into shared memory on this thread
+    FramePublisher* publisher = NULL;
+    if (publishName) {
+        publisher = StartFramePublish(&world, publishName, publishEvery);
+        if (!publisher) {
+            FinishFrameExport(exporter, NULL);
+            if (rewinding) CleanupRewind(&rewind);
+            if (csvFile) fclose(csvFile);
+            if (binFile) fclose(binFile);
+            CleanupWorld(&world);
+            return 1;
+        }
+    }
+
+    // Stream each sample as soon as it is recorded so long runs never overflow the ring
+    int written = 0;
+    long long dirtyTiles = 0;
+    long long dirtyRects = 0;
+    long long dirtyBytes = 0;
+    DirtyRect rects[PYRAMID_MAX_RECTS];
+    ClearDirtyTiles(&world);
+    for (int tick = 0; tick < ticks; tick++) {
+        if (rewinding) RecordRewindTick(&rewind, &world);
+        UpdateGrid(&world);
+        if (world.tick == seekTick) seekMoisture = CalculateTotalMoisture(&world);
+        ExportFrame(exporter, &world);
+        PublishFrame(publisher, &world);
+
+        // What the renderer would re-upload after this tick (same rectangle budget)
+        int rectCount = CollectDirtyRects(&world, rects, PYRAMID_MAX_RECTS);
+        for (int r = 0; r < rectCount; r++) {
+            dirtyBytes += (long long)(rects[r].x1 - rects[r].x0) * (rects[r].y1 - rects[r].y0) * sizeof(Color);
+        }
+        dirtyTiles += CountDirtyTiles(&world);
+        dirtyRects += rectCount;
+        ClearDirtyTiles(&world);
+
+        if (GetTelemetryTotal(&world) != written) {
+            const TelemetrySample* sample = GetLatestTelemetrySample(&world);
+            if (csvFile) WriteTelemetryCSVRow(csvFile, sample);
+            if (binFile) WriteTelemetryBinaryRow(binFile, sample);
+            written = GetTelemetryTotal(&world);
+        }
+    }
+
+    const TelemetrySample* last = GetLatestTelemetrySample(&world);
+    printf("Headless run: %d ticks, %d samples, total moisture %d\n", ticks, written, CalculateTotalMoisture(&world));
+    if (world.lod.interval > 1) {
+        printf("Reduced rate: every %d ticks outside [%d,%d)x[%d,%d), total moisture %d at the start\n",
+               world.lod.interval, world.lod.x0, world.lod.x1, world.lod.y0, world.lod.y1, startMoisture);
+    }
+    if (ticks > 0) {
+        printf("Dirty tiles: %.1f per tick in %.1f rects, %.1f KB upload per tick (full grid %d KB)\n",
+               (double)dirtyTiles / ticks, (double)dirtyRects / ticks, dirtyBytes / 1024.0 / ticks,
+               (int)(world.width * world.height * sizeof(Color) / 1024));
+    }
+    if (last) {
+        printf("Last sample: tick %d, water cells %d, active cells %d\n",
+               last->tick, last->cellCounts[CELL_TYPE_WATER], last->activeCells);
+    }
+
+    if (exporter) {
+        FrameExportStats stats;
+        FinishFrameExport(exporter, &stats);
+        printf("Frames: %d written, %d dropped, %d failed, %.3f ms per capture on the simulation thread\n",
+               stats.written, stats.dropped, stats.failed,
+               stats.captured ? stats.captureSeconds * 1000.0 / stats.captured : 0.0);
+    }
+
+    if (publisher) {
+        FramePublishStats stats;
+        StopFramePublish(publisher, &stats);
+        printf("Published frames: %d, %.3f ms per frame on the simulation thread\n",
+               stats.published, stats.published ? stats.publishSeconds * 1000.0 / stats.published : 0.0);
+    }
+
+    if (rewinding) {
+        double start = Now();
+        if (SeekRewind(&rewind, &world, seekTick)) {
+            // The replayed state must match the one reached during the run
+            printf("Seek to tick %d: %.1f ms, total moisture %d (%d during the run)\n",
+                   seekTick, (Now() - start) * 1000.0, CalculateTotalMoisture(&world), seekMoisture);
+            printf("Rewind: %d keyframes every %d ticks, %.1f MB\n", GetRewindKeyframes(&rewind),
+                   rewind.interval, GetRewindBytes(&rewind) / (1024.0 * 1024.0));
+        } else {
+            printf("Seek to tick %d failed: ticks %d to %d are retained\n",
+                   seekTick, GetRewindOldestTick(&rewind), GetRewindNewestTick(&rewind));
+        }
+        CleanupRewind(&rewind);
+    }
+
+    if (csvFile) fclose(csvFile);
+    if (binFile) fclose(binFile);
+    CleanupWorld(&world);
+    return 0;
+}
@@ -0,0 +1,22 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include "grid.h"
+
+// Build the reproducible demo scene used by headless and batch runs
+void SeedDemoScene(World* world);
+
+// Run the simulation without a window and export telemetry.
+// Options: --ticks N, --seed N, --interval N, --telemetry file.csv, --telemetry-bin file.bin,
+// --layout rows|tiles|morton (grid storage order), --size WxH,
+// --generate (procedural scene from the seed instead of the demo scene, see world_gen.h)
+// with --generate-threads N,
+// --seek N (rewind to tick N after the run and report the seek time),
+// --frames dir (image sequence, see frame_export.h) with --frame-every N, --frame-scale N,
+// --frame-crop x,y,w,h, --frame-format ppm|qoi, --frame-threads N, --frame-queue N,
+// --publish name (live frames for --viewer, see frame_publish.h) with --publish-every N,
+// --lod-focus x,y,w,h (update only this region every tick, see sim_lod.h) with --lod-interval N
+// Returns the process exit code.
+int RunHeadless(int argc, char** argv);
+
+#endif // HEADLESS_H
@@ -0,0 +1,282 @@
+#include "history.h"
+#include "organisms.h"
+#include "fluid.h"
+#include "dirty_tiles.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+static size_t EntryBytes(const HistoryEntry* entry) {
+    return (size_t)entry->chunkCount * (HISTORY_CHUNK_CELLS * (sizeof(GridCell) + sizeof(int)) + sizeof(int));
+}
+
+static void FreeEntry(HistoryEntry* entry) {
+    free(entry->chunks);
+    free(entry->cells);
+    free(entry->expected);
+    memset(entry, 0, sizeof(HistoryEntry));
+}
+
+bool InitUndoHistory(UndoHistory* history, int width, int height, size_t budget) {
+    memset(history, 0, sizeof(UndoHistory));
+    history->width = width;
+    history->height = height;
+    history->chunksX = (width + HISTORY_CHUNK_SIZE - 1) / HISTORY_CHUNK_SIZE;
+    history->chunksY = (height + HISTORY_CHUNK_SIZE - 1) / HISTORY_CHUNK_SIZE;
+    history->budget = budget;
+
+    history->captured = (unsigned int*)calloc(history->chunksX * history->chunksY, sizeof(unsigned int));
+    history->slots = (int*)calloc(history->chunksX * history->chunksY, sizeof(int));
+    if (!history->captured || !history->slots) {
+        printf("ERROR: Failed to allocate memory for undo history\n");
+        free(history->captured);
+        free(history->slots);
+        history->captured = NULL;
+        history->slots = NULL;
+        return false;
+    }
+    return true;
+}
+
+void CleanupUndoHistory(UndoHistory* history) {
+    ClearUndoHistory(history);
+    free(history->entries);
+    free(history->captured);
+    free(history->slots);
+    memset(history, 0, sizeof(UndoHistory));
+}
+
+void ClearUndoHistory(UndoHistory* history) {
+    for (int i = 0; i < history->entryCount; i++) {
+        FreeEntry(&history->entries[i]);
+    }
+    FreeEntry(&history->current);
+    history->undoCount = 0;
+    history->entryCount = 0;
+    history->bytesUsed = 0;
+    history->recording = false;
+}
+
+// Drop the oldest undo entries until the history fits its budget
+static void EvictOldest(UndoHistory* history) {
+    int drop = 0;
+    while (history->bytesUsed > history->budget && drop < history->undoCount) {
+        history->bytesUsed -= EntryBytes(&history->entries[drop]);
+        FreeEntry(&history->entries[drop]);
+        drop++;
+    }
+    if (drop == 0) return;
+
+    memmove(history->entries, history->entries + drop, (history->entryCount - drop) * sizeof(HistoryEntry));
+    history->undoCount -= drop;
+    history->entryCount -= drop;
+    history->evicted += drop;
+}
+
+void SetHistoryBudget(UndoHistory* history, size_t budget) {
+    history->budget = budget;
+    EvictOldest(history);
+}
+
+void BeginHistoryEntry(UndoHistory* history, const World* world) {
+    if (!history->captured) return;
+    EndHistoryEntry(history, world);
+
+    // A new stamp marks every chunk as not yet copied by this entry
+    if (++history->stamp == 0) {
+        memset(history->captured, 0, history->chunksX * history->chunksY * sizeof(unsigned int));
+        history->stamp = 1;
+    }
+    history->current.chunkCount = 0;
+    history->recording = true;
+}
+
+// Cell range of a chunk, clipped to the grid
+static void ChunkBounds(const UndoHistory* history, int chunk, int* x0, int* y0, int* x1, int* y1) {
+    *x0 = (chunk % history->chunksX) * HISTORY_CHUNK_SIZE;
+    *y0 = (chunk / history->chunksX) * HISTORY_CHUNK_SIZE;
+    *x1 = *x0 + HISTORY_CHUNK_SIZE;
+    *y1 = *y0 + HISTORY_CHUNK_SIZE;
+    if (*x1 > history->width) *x1 = history->width;
+    if (*y1 > history->height) *y1 = history->height;
+}
+
+// Settle what each painted cell must hold for undo to apply: the type the
+// stroke left there, or nothing when the stroke did not change its type.
+// Return the number of cells the entry can restore.
+static int SettleExpectedTypes(UndoHistory* history, HistoryEntry* entry, const World* world) {
+    int restorable = 0;
+    for (int c = 0; c < entry->chunkCount; c++) {
+        int x0, y0, x1, y1;
+        ChunkBounds(history, entry->chunks[c], &x0, &y0, &x1, &y1);
+        GridCell* copy = entry->cells + (size_t)c * HISTORY_CHUNK_CELLS;
+        int* expected = entry->expected + (size_t)c * HISTORY_CHUNK_CELLS;
+
+        for (int y = y0; y < y1; y++) {
+            for (int x = x0; x < x1; x++) {
+                int i = (y - y0) * HISTORY_CHUNK_SIZE + (x - x0);
+                if (expected[i] != HISTORY_CELL_PAINTED) continue;
+
+                int type = GetCell(world, x, y)->type;
+                expected[i] = (type == copy[i].type) ? HISTORY_CELL_NONE : type;
+                if (expected[i] != HISTORY_CELL_NONE) restorable++;
+            }
+        }
+    }
+    return restorable;
+}
+
+void EndHistoryEntry(UndoHistory* history, const World* world) {
+    if (!history->recording) return;
+    history->recording = false;
+    if (history->current.chunkCount == 0) return;
+    if (world->width != history->width || world->height != history->height ||
+        SettleExpectedTypes(history, &history->current, world) == 0) {
+        history->current.chunkCount = 0;
+        return;
+    }
+
+    // A new edit makes the undone ones unreachable
+    for (int i = history->undoCount; i < history->entryCount; i++) {
+        history->bytesUsed -= EntryBytes(&history->entries[i]);
+        FreeEntry(&history->entries[i]);
+    }
+    history->entryCount = history->undoCount;
+
+    if (history->entryCount == history->capacity) {
+        int capacity = history->capacity ? history->capacity * 2 : 64;
+        HistoryEntry* entries = (HistoryEntry*)realloc(history->entries, capacity * sizeof(HistoryEntry));
+        if (!entries) {
+            printf("ERROR: Failed to grow undo history to %d entries\n", capacity);
+            FreeEntry(&history->current);
+            return;
+        }
+        history->entries = entries;
+        history->capacity = capacity;
+    }
+
+    // The entry takes over the recorded buffers
+    history->entries[history->entryCount++] = history->current;
+    history->undoCount = history->entryCount;
+    history->bytesUsed += EntryBytes(&history->current);
+    memset(&history->current, 0, sizeof(HistoryEntry));
+
+    EvictOldest(history);
+}
+
+// Add an empty chunk to the current entry and return its index, or -1 when
+// the entry could not grow
+static int CaptureChunk(UndoHistory* history, int chunk) {
+    HistoryEntry* entry = &history->current;
+    if (entry->chunkCount == entry->chunkCapacity) {
+        // The capacity only moves once all three buffers have grown
+        int capacity = entry->chunkCapacity ? entry->chunkCapacity * 2 : 16;
+        int* chunks = (int*)realloc(entry->chunks, capacity * sizeof(int));
+        if (chunks) entry->chunks = chunks;
+        GridCell* cells = chunks ? (GridCell*)realloc(entry->cells, (size_t)capacity * HISTORY_CHUNK_CELLS * sizeof(GridCell)) : NULL;
+        if (cells) entry->cells = cells;
+        int* expected = cells ? (int*)realloc(entry->expected, (size_t)capacity * HISTORY_CHUNK_CELLS * sizeof(int)) : NULL;
+        if (!expected) {
+            printf("ERROR: Failed to allocate memory for undo history\n");
+            return -1;
+        }
+        entry->expected = expected;
+        entry->chunkCapacity = capacity;
+    }
+
+    int* expected = entry->expected + (size_t)entry->chunkCount * HISTORY_CHUNK_CELLS;
+    for (int i = 0; i < HISTORY_CHUNK_CELLS; i++) {
+        expected[i] = HISTORY_CELL_NONE;
+    }
+    entry->chunks[entry->chunkCount] = chunk;
+    return entry->chunkCount++;
+}
+
+void RecordHistoryCells(UndoHistory* history, const World* world, const int* cells, int count) {
+    if (!history->recording || world->width != history->width || world->height != history->height) return;
+
+    HistoryEntry* entry = &history->current;
+    for (int i = 0; i < count; i++) {
+        int x = cells[i] % history->width;
+        int y = cells[i] / history->width;
+        int chunk = (y >> HISTORY_CHUNK_SHIFT) * history->chunksX + (x >> HISTORY_CHUNK_SHIFT);
+        if (history->captured[chunk] != history->stamp) {
+            int slot = CaptureChunk(history, chunk);
+            if (slot < 0) continue;
+            history->captured[chunk] = history->stamp;
+            history->slots[chunk] = slot;
+        }
+
+        // Copy the cell the first time the stroke reaches it, so the copy is
+        // from just before the brush wrote it even while the simulation runs
+        size_t index = (size_t)history->slots[chunk] * HISTORY_CHUNK_CELLS +
+                       (y & (HISTORY_CHUNK_SIZE - 1)) * HISTORY_CHUNK_SIZE + (x & (HISTORY_CHUNK_SIZE - 1));
+        if (entry->expected[index] == HISTORY_CELL_PAINTED) continue;
+        entry->cells[index] = *GetCell(world, x, y);
+        entry->expected[index] = HISTORY_CELL_PAINTED;
+    }
+}
+
+// Exchange an entry's cell copies with the grid where the grid still holds the
+// expected type, then bring the world's bookkeeping (renderer tiles, fluid
+// solver, organisms) in line with the cells. Cells the simulation has changed
+// since are kept and dropped from the entry.
+static void SwapEntry(UndoHistory* history, HistoryEntry* entry, World* world) {
+    for (int c = 0; c < entry->chunkCount; c++) {
+        int x0, y0, x1, y1;
+        ChunkBounds(history, entry->chunks[c], &x0, &y0, &x1, &y1);
+        GridCell* copy = entry->cells + (size_t)c * HISTORY_CHUNK_CELLS;
+        int* expected = entry->expected + (size_t)c * HISTORY_CHUNK_CELLS;
+        bool swapped = false;
+
+        for (int y = y0; y < y1; y++) {
+            for (int x = x0; x < x1; x++) {
+                int i = (y - y0) * HISTORY_CHUNK_SIZE + (x - x0);
+                if (expected[i] == HISTORY_CELL_NONE) continue;
+
+                GridCell* cell = GetCell(world, x, y);
+                if (cell->type != expected[i]) {
+                    expected[i] = HISTORY_CELL_NONE;
+                    continue;
+                }
+                GridCell temp = *cell;
+                *cell = copy[i];
+                copy[i] = temp;
+                expected[i] = cell->type;
+                swapped = true;
+            }
+        }
+        if (!swapped) continue;
+
+        for (int y = y0; y < y1; y++) {
+            for (int x = x0; x < x1; x++) {
+                int i = (y - y0) * HISTORY_CHUNK_SIZE + (x - x0);
+                int type = expected[i];
+                if (type == CELL_TYPE_PLANT || type == CELL_TYPE_MOSS) {
+                    ReattachOrganismCell(world, x, y);
+                }
+            }
+        }
+
+        MarkRectDirty(world, x0, y0, x1, y1);
+        WakeFluidRect(world, x0 - 1, y0 - 1, x1 + 1, y1 + 1);
+    }
+}
+
+bool UndoEdit(UndoHistory* history, World* world) {
+    if (history->recording || history->undoCount == 0) return false;
+    if (world->width != history->width || world->height != history->height) return false;
+
+    history->undoCount--;
+    SwapEntry(history, &history->entries[history->undoCount], world);
+    return true;
+}
+
+bool RedoEdit(UndoHistory* history, World* world) {
+    if (history->recording || history->undoCount == history->entryCount) return false;
+    if (world->width != history->width || world->height != history->height) return false;
+
+    SwapEntry(history, &history->entries[history->undoCount], world);
+    history->undoCount++;
+    return true;
+}
@@ -0,0 +1,73 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "grid.h"
+#include <stddef.h>
+#include <stdbool.h>
+
+// Undo/redo for edits made with the brush. An entry keeps, for the chunks an
+// edit touched, a copy of each painted cell taken just before the brush wrote it.
+// Undo and redo swap those copies with the grid, so one copy serves both ways.
+// The simulation keeps running between edits, so a cell is only swapped while it
+// still holds the type the last swap (or the stroke) left there; cells the
+// simulation has since changed are left alone and drop out of the entry.
+#define HISTORY_CHUNK_SHIFT 4
+#define HISTORY_CHUNK_SIZE (1 << HISTORY_CHUNK_SHIFT)      // cells per side of a chunk
+#define HISTORY_CHUNK_CELLS (HISTORY_CHUNK_SIZE * HISTORY_CHUNK_SIZE)
+#define HISTORY_DEFAULT_BUDGET ((size_t)64 * 1024 * 1024)  // bytes of chunk copies kept
+#define HISTORY_CELL_NONE -2     // expected type of a cell the entry does not restore
+#define HISTORY_CELL_PAINTED -3  // cell copied by the edit being recorded
+
+typedef struct {
+    int* chunks;        // chunk indices (chunkY * chunksX + chunkX)
+    GridCell* cells;    // HISTORY_CHUNK_CELLS cells per chunk, row-major within the chunk
+    int* expected;      // per cell: type the grid must hold for the next swap, or HISTORY_CELL_NONE
+    int chunkCount;
+    int chunkCapacity;
+} HistoryEntry;
+
+typedef struct {
+    HistoryEntry* entries;  // [0, undoCount) can be undone, [undoCount, entryCount) redone
+    int undoCount;
+    int entryCount;
+    int capacity;
+
+    HistoryEntry current;   // the edit being recorded
+    bool recording;
+    unsigned int* captured; // per chunk: stamp of the last entry that copied it
+    int* slots;             // per chunk: its index in the current entry, valid when captured
+    unsigned int stamp;
+
+    int width;
+    int height;
+    int chunksX;
+    int chunksY;
+    size_t budget;          // oldest entries are evicted above this many bytes
+    size_t bytesUsed;
+    int evicted;            // entries dropped to stay within the budget
+} UndoHistory;
+
+bool InitUndoHistory(UndoHistory* history, int width, int height, size_t budget);
+void CleanupUndoHistory(UndoHistory* history);
+
+// Change the memory budget, evicting the oldest entries if needed
+void SetHistoryBudget(UndoHistory* history, size_t budget);
+
+// Drop every entry, including the one being recorded
+void ClearUndoHistory(UndoHistory* history);
+
+// Start and finish recording one edit (a brush stroke). Edits that left every
+// cell with the type it had before are dropped.
+void BeginHistoryEntry(UndoHistory* history, const World* world);
+void EndHistoryEntry(UndoHistory* history, const World* world);
+
+// Copy these cells (indices y * width + x) before they change. Cells already
+// copied by the current entry are skipped.
+void RecordHistoryCells(UndoHistory* history, const World* world, const int* cells, int count);
+
+// Swap the cells of the last undone / next redone edit back into the grid.
+// Return false when there is nothing to undo or redo.
+bool UndoEdit(UndoHistory* history, World* world);
+bool RedoEdit(UndoHistory* history, World* world);
+
+#endif // HISTORY_H
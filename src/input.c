@@ -3,149 +3,167 @@
 #include "grid.h"
 #include "cell_actions.h"
 #include "cell_types.h"
-
-// External variables needed for input handling
-extern int brushRadius;
-extern float lastSeedTime;
-extern const float SEED_DELAY;
-extern int currentSelectedType;  
-extern bool simulationRunning;
-extern bool simulationPaused;
-extern int gameWidth;
-extern int uiPanelWidth;
-
-// Include viewportX and cellSize as external variables
-extern int viewportX;
-extern int viewportY;
-extern int cellSize;
-
-// Define viewportContentOffsetX and viewportContentOffsetY here
-int viewportContentOffsetX = 0;
-int viewportContentOffsetY = 0;
-
-// Track if mouse was initially pressed in UI area
-static bool mouseStartedInUI = false;
+#include "update_water.h"
+#include "rendering.h"
+#include "brush_stroke.h"
+#include "history.h"
+#include "rewind.h"
 
 // Handle user input (mouse and keyboard)
-void HandleInput(void) {
+void HandleInput(AppState* app, World* world) {
+    Viewport* view = &app->view;
+
     // Handle simulation controls (space to start/pause)
     if (IsKeyPressed(KEY_SPACE)) {
-        if (!simulationRunning) {
-            simulationRunning = true;
-            simulationPaused = false;
+        if (!app->simulationRunning) {
+            app->simulationRunning = true;
+            app->simulationPaused = false;
         } else {
-            simulationPaused = !simulationPaused;
+            app->simulationPaused = !app->simulationPaused;
         }
     }
     
-    // Handle brush size changes with mouse wheel
-    float wheelMove = GetMouseWheelMove();
-    if(wheelMove != 0) {
-        brushRadius += (int)wheelMove;
-        // Clamp brush radius between 1 and 32
-        brushRadius = (brushRadius < 1) ? 1 : ((brushRadius > 32) ? 32 : brushRadius);
+    // Toggle between cellular and pressure-based water
+    if (IsKeyPressed(KEY_P)) {
+        SetWaterModel(world, world->waterModel == WATER_MODEL_PRESSURE ? WATER_MODEL_CELLULAR : WATER_MODEL_PRESSURE);
+        MarkRewindEdited(&app->rewind, world);
     }
     
-    // Handle viewport panning with arrow keys
-    int panSpeed = 10; // Speed of panning in pixels
-
-    // Update viewport panning logic to use separate content offset
-    if (IsKeyDown(KEY_RIGHT)) {
-        viewportContentOffsetX += panSpeed;
-        if (viewportContentOffsetX > GRID_WIDTH * cellSize - gameWidth) {
-            viewportContentOffsetX = GRID_WIDTH * cellSize - gameWidth; // Prevent scrolling outside the gamefield
+    // Undo with Ctrl+Z, redo with Ctrl+Y or Ctrl+Shift+Z (not in the middle of a stroke).
+    // Cells the simulation has changed since the edit keep their current contents.
+    bool ctrlHeld = IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL);
+    bool shiftHeld = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
+    if (ctrlHeld && !app->stroke.active) {
+        bool changed = false;
+        if (IsKeyPressed(KEY_Z) && !shiftHeld) {
+            changed = UndoEdit(&app->history, world);
+        } else if (IsKeyPressed(KEY_Y) || (IsKeyPressed(KEY_Z) && shiftHeld)) {
+            changed = RedoEdit(&app->history, world);
         }
-    }
-    if (IsKeyDown(KEY_LEFT)) {
-        viewportContentOffsetX -= panSpeed;
-        if (viewportContentOffsetX < 0) {
-            viewportContentOffsetX = 0; // Prevent scrolling outside the gamefield
+        if (changed) {
+            MarkRewindEdited(&app->rewind, world);
         }
     }
 
-    // Adjust the calculation for the viewport height to include all visible cells
-    int viewportHeight = GetRenderHeight() - 80; // Subtract 80 pixels for UI
-    int totalVisibleCells = viewportHeight / cellSize;
-
-    // Ensure the grid height accounts for all visible cells
-    if (GRID_HEIGHT < totalVisibleCells) {
-        GRID_HEIGHT = totalVisibleCells;
+    // Scrub through recorded ticks: , and . step one tick (with Shift one keyframe
+    // interval), Home and End jump to the oldest and newest retained tick
+    if (!app->stroke.active) {
+        int step = shiftHeld ? app->rewind.interval : 1;
+        int target = world->tick;
+        if (IsKeyPressed(KEY_COMMA)) target -= step;
+        if (IsKeyPressed(KEY_PERIOD)) target += step;
+        if (IsKeyPressed(KEY_HOME)) target = GetRewindOldestTick(&app->rewind);
+        if (IsKeyPressed(KEY_END)) target = GetRewindNewestTick(&app->rewind);
+
+        if (target != world->tick) {
+            int oldest = GetRewindOldestTick(&app->rewind);
+            int newest = GetRewindNewestTick(&app->rewind);
+            target = (target < oldest) ? oldest : ((target > newest) ? newest : target);
+            if (SeekRewind(&app->rewind, world, target)) {
+                app->simulationPaused = true; // Stay on the tick that was sought
+                ClearUndoHistory(&app->history); // Its chunks belong to another point in time
+            }
+        }
+    }
+    
+    // Toggle the minimap
+    if (IsKeyPressed(KEY_M)) {
+        app->showMinimap = !app->showMinimap;
     }
 
-    // Lock vertical scrolling
-    viewportContentOffsetY = 0;
+    // Toggle reduced-rate updates away from the view (applied with the next tick)
+    if (IsKeyPressed(KEY_L)) {
+        app->reducedRateOffscreen = !app->reducedRateOffscreen;
+    }
     
     Vector2 mousePos = GetMousePosition();
 
-    // Correct the calculation for determining if the cursor is in the game area
-    bool isInGameArea = mousePos.x >= viewportX && mousePos.x < viewportX + gameWidth &&
-                        mousePos.y >= viewportY && mousePos.y < viewportY + viewportHeight;
-
-    // Correct the calculation for determining if the cursor is over the UI panel
-    int uiStartX = GetScreenWidth() - uiPanelWidth; // Correctly calculate the UI panel's starting X position
+    // Handle brush size changes with mouse wheel (Ctrl+wheel zooms around the cursor)
+    float wheelMove = GetMouseWheelMove();
+    if (wheelMove != 0 && ctrlHeld) {
+        ZoomViewport(view, (wheelMove > 0) ? VIEWPORT_ZOOM_STEP : 1.0f / VIEWPORT_ZOOM_STEP,
+                     mousePos, world->width, world->height);
+    } else if(wheelMove != 0) {
+        app->brushRadius += (int)wheelMove;
+        // Clamp brush radius between 1 and 32
+        app->brushRadius = (app->brushRadius < 1) ? 1 : ((app->brushRadius > 32) ? 32 : app->brushRadius);
+    }
 
-    // Check if the cursor is over the UI panel
-    if (mousePos.x >= uiStartX && mousePos.x < GetScreenWidth()) {
-        mouseStartedInUI = true;
-    } else {
-        mouseStartedInUI = false;
+    // Zoom around the middle of the viewport with +/-
+    Vector2 viewCenter = { view->x + view->width / 2.0f, view->y + view->height / 2.0f };
+    if (IsKeyPressed(KEY_EQUAL)) {
+        ZoomViewport(view, VIEWPORT_ZOOM_STEP, viewCenter, world->width, world->height);
+    }
+    if (IsKeyPressed(KEY_MINUS)) {
+        ZoomViewport(view, 1.0f / VIEWPORT_ZOOM_STEP, viewCenter, world->width, world->height);
     }
     
-    // Handle UI interaction
-    if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && !isInGameArea) {
-        // UI area click handling
-        
-        // Calculate UI button positions - must match DrawUIOnRight
-        int buttonSize = 64;
-        int padding = 10;
-        int startX = 1640; // Set startX to the correct position for the first button
-        int startY = 90;
-        
-        // Correct the calculation for buttons per row
-        int buttonsPerRow = 3; // Set to the actual number of buttons per row being drawn
+    // Handle viewport panning with arrow keys
+    int panSpeed = 10; // Speed of panning in pixels
 
-        // Check each material button
-        for (int i = 0; i <= CELL_TYPE_MOSS; i++) {
-            int row = i / buttonsPerRow;
-            int col = i % buttonsPerRow;
+    if (IsKeyDown(KEY_RIGHT)) PanViewport(view, panSpeed, 0, world->width, world->height);
+    if (IsKeyDown(KEY_LEFT)) PanViewport(view, -panSpeed, 0, world->width, world->height);
+    if (IsKeyDown(KEY_DOWN)) PanViewport(view, 0, panSpeed, world->width, world->height);
+    if (IsKeyDown(KEY_UP)) PanViewport(view, 0, -panSpeed, world->width, world->height);
+    
 
-            // Adjust button positions to match actual screen coordinates
-            Vector2 dpiScale = GetWindowScaleDPI();
-            float dpiScaleFactor = dpiScale.x;
+    // Correct the calculation for determining if the cursor is in the game area
+    int gridX, gridY;
+    bool isInGameArea = ScreenToCell(view, mousePos, &gridX, &gridY);
 
-            int posX = startX + col * (buttonSize + padding) * dpiScaleFactor;
-            int posY = startY + row * (buttonSize + padding) * dpiScaleFactor;
+    // Check if the cursor is over the UI panel
+    const PanelLayout* layout = &app->panel.layout;
+    app->mouseStartedInUI = CheckCollisionPointRec(mousePos, layout->panel);
 
-            // Adjust button size and padding to match the UI rendering with scaling
-            if (mousePos.x >= posX && mousePos.x < posX + buttonSize * dpiScaleFactor &&
-                mousePos.y >= posY && mousePos.y < posY + buttonSize * dpiScaleFactor) {
-                currentSelectedType = i;
-                break;
-            }
+    // Handle UI interaction
+    if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && !isInGameArea) {
+        // Material buttons share their rectangles with the panel drawing
+        int button = PanelButtonAt(layout, mousePos);
+        if (button >= 0) {
+            app->currentSelectedType = button;
         }
         
         return; // Skip game area handling
     }
-    
+
+    // Dragging on the minimap moves the camera instead of painting
+    if (isInGameArea && app->showMinimap && !app->mouseStartedInUI) {
+        Rectangle minimap = GetMinimapRect(app, world);
+        if (mousePos.x >= minimap.x && mousePos.x < minimap.x + minimap.width &&
+            mousePos.y >= minimap.y && mousePos.y < minimap.y + minimap.height) {
+            if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
+                float scale = world->width / minimap.width;
+                CenterViewport(view, (mousePos.x - minimap.x) * scale, (mousePos.y - minimap.y) * scale,
+                               world->width, world->height);
+            }
+            return;
+        }
+    }
+
     // Handle game area interaction only if in game area
-    if (isInGameArea) {
-        // Only allow drawing if mouse didn't start in UI area
-        if (!mouseStartedInUI) {
-            // Handle cell placement
-            // Adjust mouse position for scrolling offset
-            int gridX = (int)((mousePos.x - viewportX + viewportContentOffsetX) / cellSize);
-            int gridY = (int)((mousePos.y - viewportY + viewportContentOffsetY) / cellSize);
+    bool leftDown = IsMouseButtonDown(MOUSE_LEFT_BUTTON);
+    bool rightDown = IsMouseButtonDown(MOUSE_RIGHT_BUTTON);
+    if (isInGameArea && !app->mouseStartedInUI && (leftDown || rightDown)) {
+        // Only paint while the cursor is on an interior cell (the view may be zoomed out)
+        if (gridX > 0 && gridX < world->width - 1 &&
+            gridY > 0 && gridY < world->height - 1) {
+            // Left paints the selected material, right erases to air; switching starts a new stroke
+            int cellType = leftDown ? app->currentSelectedType : CELL_TYPE_AIR;
+            if (!app->stroke.active || app->stroke.cellType != cellType) {
+                BeginHistoryEntry(&app->history, world);
+                BeginBrushStroke(&app->stroke, cellType, app->brushRadius, gridX, gridY);
+            } else {
+                ContinueBrushStroke(&app->stroke, app->brushRadius, gridX, gridY);
+            }
 
-            // Ensure the grid coordinates are clamped within the viewport bounds
-            if (gridX > 0 && gridX < (viewportX + gameWidth) / cellSize &&
-                gridY > 0 && gridY < (viewportY + viewportHeight) / cellSize) {
-                // Handle cell placement logic here
-                if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
-                    PlaceCircularPattern(gridX, gridY, currentSelectedType, brushRadius);
-                } else if (IsMouseButtonDown(MOUSE_RIGHT_BUTTON)) {
-                    PlaceCircularPattern(gridX, gridY, CELL_TYPE_AIR, brushRadius);
-                }
+            // Each stroke is one undo step; save the chunks it is about to change
+            RecordHistoryCells(&app->history, world, app->stroke.pending, app->stroke.pendingCount);
+            if (ApplyBrushStroke(&app->stroke, world) > 0) {
+                MarkRewindEdited(&app->rewind, world);
             }
         }
+    } else if (!leftDown && !rightDown) {
+        EndBrushStroke(&app->stroke);
+        EndHistoryEntry(&app->history, world);
     }
 }
@@ -1,7 +1,10 @@
 #ifndef INPUT_H
 #define INPUT_H
 
+#include "app_state.h"
+#include "grid.h"
+
 // Input handling
-void HandleInput(void);
+void HandleInput(AppState* app, World* world);
 
 #endif // INPUT_H
@@ -0,0 +1,370 @@
+#include "organisms.h"
+#include "cell_defaults.h"
+#include "cell_actions.h"
+#include "fluid.h"
+#include "telemetry.h"
+#include "dirty_tiles.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+// Allocate an empty organism table
+void InitOrganisms(World* world) {
+    CleanupOrganisms(world);
+
+    OrganismTable* t = (OrganismTable*)calloc(1, sizeof(OrganismTable));
+    if (!t) {
+        printf("ERROR: Failed to allocate memory for organism table\n");
+        return;
+    }
+    t->freeList = -1;
+    for (int i = 0; i < ORGANISM_WHEEL_SLOTS; i++) {
+        t->wheel[i] = -1;
+    }
+    world->organisms = t;
+}
+
+void CleanupOrganisms(World* world) {
+    if (!world->organisms) return;
+
+    free(world->organisms->pool);
+    free(world->organisms);
+    world->organisms = NULL;
+}
+
+bool CopyOrganisms(World* dst, const World* src) {
+    OrganismTable* to = dst->organisms;
+    const OrganismTable* from = src->organisms;
+    if (!to || !from) return true;
+
+    if (to->capacity != from->capacity) {
+        Organism* pool = (Organism*)realloc(to->pool, from->capacity * sizeof(Organism));
+        if (!pool && from->capacity > 0) {
+            printf("ERROR: Failed to grow organism table to %d entries\n", from->capacity);
+            return false;
+        }
+        to->pool = pool;
+    }
+
+    Organism* pool = to->pool;
+    *to = *from;
+    to->pool = pool;
+    if (from->capacity > 0) {
+        memcpy(to->pool, from->pool, from->capacity * sizeof(Organism));
+    }
+    return true;
+}
+
+int GetOrganismCount(const World* world) {
+    return world->organisms ? world->organisms->liveCount : 0;
+}
+
+static int ActInterval(int type) {
+    return (type == CELL_TYPE_PLANT) ? PLANT_ACT_INTERVAL : MOSS_ACT_INTERVAL;
+}
+
+// Look up a living organism by the id stored in its cells
+static Organism* GetOrganism(World* world, int id) {
+    OrganismTable* t = world->organisms;
+    if (!t || id < 1 || id > t->capacity) return NULL;
+
+    Organism* o = &t->pool[id - 1];
+    return (o->id == id) ? o : NULL;
+}
+
+// Put an organism in the wheel slot of its next update
+static void Schedule(OrganismTable* t, Organism* o) {
+    int slot = o->nextTick % ORGANISM_WHEEL_SLOTS;
+    o->next = t->wheel[slot];
+    t->wheel[slot] = o->id - 1;
+}
+
+// Double the pool; new slots go on the free list
+static bool GrowPool(OrganismTable* t) {
+    int capacity = t->capacity ? t->capacity * 2 : 64;
+    Organism* pool = (Organism*)realloc(t->pool, capacity * sizeof(Organism));
+    if (!pool) {
+        printf("ERROR: Failed to grow organism table to %d entries\n", capacity);
+        return false;
+    }
+
+    for (int i = t->capacity; i < capacity; i++) {
+        pool[i].id = 0;
+        pool[i].next = (i + 1 < capacity) ? i + 1 : t->freeList;
+    }
+    t->freeList = t->capacity;
+    t->pool = pool;
+    t->capacity = capacity;
+    return true;
+}
+
+static Organism* CreateOrganism(World* world, int type, int maxAge, int x, int y) {
+    OrganismTable* t = world->organisms;
+    if (!t || (t->freeList < 0 && !GrowPool(t))) return NULL;
+
+    int slot = t->freeList;
+    Organism* o = &t->pool[slot];
+    t->freeList = o->next;
+
+    int interval = ActInterval(type);
+    o->id = slot + 1;
+    o->type = type;
+    o->birthTick = world->tick;
+    o->maxAge = maxAge * interval;
+    o->energy = 0;
+    o->water = 0;
+    o->cellCount = 0;
+    o->nextTick = world->tick + 1 + CellRandom(world, x, y, RANDOM_ORGANISM_SCHEDULE, 0, interval - 1); // Spread updates over the interval
+    Schedule(t, o);
+    t->liveCount++;
+    return o;
+}
+
+static void FreeOrganism(OrganismTable* t, Organism* o) {
+    int slot = o->id - 1;
+    o->id = 0;
+    o->next = t->freeList;
+    t->freeList = slot;
+    t->liveCount--;
+}
+
+static bool OwnsCell(const Organism* o, int index) {
+    for (int i = 0; i < o->cellCount; i++) {
+        if (o->cells[i] == index) return true;
+    }
+    return false;
+}
+
+int AddOrganismCell(World* world, int x, int y) {
+    GridCell* cell = GetCell(world, x, y);
+    int index = y * world->width + x;
+
+    // Join a neighbouring organism of the same type that still has room
+    const int dx[4] = { 0, -1, 1, 0 };
+    const int dy[4] = { 1, 0, 0, -1 };
+    for (int d = 0; d < 4; d++) {
+        const GridCell* neighbour = GetCell(world, x + dx[d], y + dy[d]);
+        if (neighbour->type != cell->type || neighbour->objectID == 0) continue;
+
+        Organism* o = GetOrganism(world, neighbour->objectID);
+        if (!o || o->type != cell->type || o->cellCount >= ORGANISM_MAX_CELLS) continue;
+
+        if (!OwnsCell(o, index)) {
+            o->cells[o->cellCount++] = index;
+        }
+        o->energy += cell->Energy;
+        cell->Energy = 0;
+        cell->objectID = o->id;
+        return o->id;
+    }
+
+    // Otherwise found a new one
+    Organism* o = CreateOrganism(world, cell->type, cell->maxage, x, y);
+    if (!o) return 0;
+
+    o->cells[o->cellCount++] = index;
+    o->energy = cell->Energy;
+    cell->Energy = 0;
+    cell->objectID = o->id;
+    return o->id;
+}
+
+void ReattachOrganismCell(World* world, int x, int y) {
+    GridCell* cell = GetCell(world, x, y);
+    Organism* o = GetOrganism(world, cell->objectID);
+    if (o && o->type == cell->type && OwnsCell(o, y * world->width + x)) return;
+
+    cell->objectID = 0;
+    AddOrganismCell(world, x, y);
+}
+
+void OrganismCellMoved(World* world, int id, int fromX, int fromY, int toX, int toY) {
+    Organism* o = GetOrganism(world, id);
+    if (!o) return;
+
+    int from = fromY * world->width + fromX;
+    for (int i = 0; i < o->cellCount; i++) {
+        if (o->cells[i] == from) {
+            o->cells[i] = toY * world->width + toX;
+            return;
+        }
+    }
+}
+
+// Counter-based random number for an organism, keyed on its first cell (unique
+// among live organisms) so organisms can be updated in any order
+static int OrganismRandom(const World* world, const Organism* o, int purpose, int min, int max) {
+    return CellRandom(world, o->cells[0] % world->width, o->cells[0] / world->width, purpose, min, max);
+}
+
+// Draw moisture from the soil or water around one random cell (moved, never created)
+static void AbsorbWater(World* world, Organism* o) {
+    int index = o->cells[OrganismRandom(world, o, RANDOM_ORGANISM_ABSORB, 0, o->cellCount - 1)];
+    int x = index % world->width;
+    int y = index / world->width;
+    GridCell* cell = GetCell(world, x, y);
+
+    // Roots first, then the sides
+    const int dx[4] = { 0, -1, 1, 0 };
+    const int dy[4] = { 1, 0, 0, -1 };
+    for (int d = 0; d < 4 && cell->moisture < 100; d++) {
+        GridCell* source = GetCell(world, x + dx[d], y + dy[d]);
+        if (source->type != CELL_TYPE_SOIL && source->type != CELL_TYPE_WATER) continue;
+        if (source->moisture <= ORGANISM_ABSORB_AMOUNT) continue;
+
+        int amount = ORGANISM_ABSORB_AMOUNT;
+        if (amount > 100 - cell->moisture) amount = 100 - cell->moisture;
+        source->moisture -= amount;
+        cell->moisture += amount;
+        o->water += amount;
+        MarkCellDirty(world, x, y);
+        MarkCellDirty(world, x + dx[d], y + dy[d]);
+
+        if (source->type == CELL_TYPE_WATER) {
+            WakeFluidAt(world, x + dx[d], y + dy[d]);
+        }
+    }
+}
+
+// Can a cell of this organism type grow into (x, y)?
+static bool CanGrowInto(const World* world, int type, int x, int y) {
+    if (IsBorderTile(world, x, y) || GetCell(world, x, y)->type != CELL_TYPE_AIR) return false;
+    if (type == CELL_TYPE_PLANT) return true;
+
+    // Moss only spreads over soil
+    return GetCell(world, x, y + 1)->type == CELL_TYPE_SOIL ||
+           GetCell(world, x - 1, y)->type == CELL_TYPE_SOIL ||
+           GetCell(world, x + 1, y)->type == CELL_TYPE_SOIL;
+}
+
+// Grow one new cell next to a random cell, splitting the parent's moisture with it
+static void Grow(World* world, Organism* o) {
+    // Plants grow upwards, moss creeps sideways and down over the ground
+    static const int plantDx[3] = { 0, -1, 1 };
+    static const int plantDy[3] = { -1, -1, -1 };
+    static const int mossDx[5] = { -1, 1, -1, 1, 0 };
+    static const int mossDy[5] = { 0, 0, 1, 1, -1 };
+    bool isPlant = (o->type == CELL_TYPE_PLANT);
+    const int* dx = isPlant ? plantDx : mossDx;
+    const int* dy = isPlant ? plantDy : mossDy;
+    int directions = isPlant ? 3 : 5;
+
+    int parentIndex = o->cells[OrganismRandom(world, o, RANDOM_ORGANISM_GROW, 0, o->cellCount - 1)];
+    int px = parentIndex % world->width;
+    int py = parentIndex / world->width;
+    GridCell* parent = GetCell(world, px, py);
+    if (parent->moisture < ORGANISM_MIN_GROW_WATER) return;
+
+    int first = OrganismRandom(world, o, RANDOM_ORGANISM_DIRECTION, 0, directions - 1);
+    for (int i = 0; i < directions; i++) {
+        int d = (first + i) % directions;
+        int x = px + dx[d];
+        int y = py + dy[d];
+        if (!CanGrowInto(world, o->type, x, y)) continue;
+
+        GridCell* cell = GetCell(world, x, y);
+        int vapour = cell->moisture;
+        int share = parent->moisture / 2;
+        parent->moisture -= share;
+
+        InitializeCellDefaults(cell, o->type);
+        cell->moisture = share + vapour; // The air's vapour becomes part of the new cell
+        cell->variation = RandomColorVariation(world, x, y);
+        cell->Energy = 0;
+        cell->birthTick = world->tick;
+        cell->objectID = o->id;
+
+        o->cells[o->cellCount++] = y * world->width + x;
+        o->energy -= ORGANISM_GROW_COST;
+        WakeFluidAt(world, x, y);
+        MarkCellDirty(world, px, py);
+        MarkCellDirty(world, x, y);
+        CountActiveCells(world, 1);
+        return;
+    }
+}
+
+// Dead organisms decay into soil that keeps their moisture
+static void Wither(World* world, Organism* o) {
+    for (int i = 0; i < o->cellCount; i++) {
+        int x = o->cells[i] % world->width;
+        int y = o->cells[i] / world->width;
+        GridCell* cell = GetCell(world, x, y);
+
+        int moisture = cell->moisture;
+        InitializeCellDefaults(cell, CELL_TYPE_SOIL);
+        cell->moisture = moisture;
+        cell->birthTick = world->tick;
+
+        MarkCellDirty(world, x, y);
+    }
+    CountActiveCells(world, o->cellCount);
+}
+
+// One organism update; returns false when the organism has died
+static bool UpdateOrganism(World* world, Organism* o) {
+    // Drop cells that were overwritten since the last update and gather light and water
+    int lit = 0;
+    o->water = 0;
+    for (int i = 0; i < o->cellCount; ) {
+        int x = o->cells[i] % world->width;
+        int y = o->cells[i] / world->width;
+        const GridCell* cell = GetCell(world, x, y);
+        if (cell->objectID != o->id || cell->type != o->type) {
+            o->cells[i] = o->cells[--o->cellCount];
+            continue;
+        }
+
+        o->water += cell->moisture;
+        if (GetCell(world, x, y - 1)->type == CELL_TYPE_AIR) lit++;
+        i++;
+    }
+    if (o->cellCount == 0) return false;
+
+    if (world->tick - o->birthTick > o->maxAge) {
+        Wither(world, o);
+        return false;
+    }
+
+    o->energy += lit;
+    if (o->energy > ORGANISM_MAX_CELLS * ORGANISM_GROW_COST) {
+        o->energy = ORGANISM_MAX_CELLS * ORGANISM_GROW_COST;
+    }
+
+    AbsorbWater(world, o);
+    if (o->energy >= ORGANISM_GROW_COST && o->cellCount < ORGANISM_MAX_CELLS) {
+        Grow(world, o);
+    }
+
+    o->nextTick = world->tick + ActInterval(o->type);
+    return true;
+}
+
+// Only the organisms in this tick's wheel slot are visited, so the cost
+// scales with the organisms that act rather than with the grid or the pool
+void UpdateOrganisms(World* world) {
+    OrganismTable* t = world->organisms;
+    if (!t) return;
+
+    int slot = world->tick % ORGANISM_WHEEL_SLOTS;
+    int index = t->wheel[slot];
+    t->wheel[slot] = -1;
+    t->actedLastTick = 0;
+
+    while (index >= 0) {
+        Organism* o = &t->pool[index];
+        int next = o->next;
+
+        if (o->nextTick > world->tick) {
+            Schedule(t, o); // Due on a later lap of the wheel
+        } else {
+            t->actedLastTick++;
+            if (UpdateOrganism(world, o)) {
+                Schedule(t, o);
+            } else {
+                FreeOrganism(t, o);
+            }
+        }
+        index = next;
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef ORGANISMS_H
+#define ORGANISMS_H
+
+#include "grid.h"
+
+// Organism limits and scheduling
+#define ORGANISM_MAX_CELLS 64       // cells one organism can own
+#define ORGANISM_WHEEL_SLOTS 64     // timing wheel size, every delay must be shorter
+#define PLANT_ACT_INTERVAL 8        // ticks between plant updates
+#define MOSS_ACT_INTERVAL 16        // ticks between moss updates
+#define ORGANISM_GROW_COST 6        // energy spent per new cell
+#define ORGANISM_MIN_GROW_WATER 20  // moisture a cell needs before it can grow a new one
+#define ORGANISM_ABSORB_AMOUNT 4    // moisture drawn from one neighbour per update
+
+// One plant or moss colony. Its cells carry its id in GridCell.objectID.
+typedef struct {
+    int id;            // objectID shared by the organism's cells, 0 when the slot is free
+    int type;          // CELL_TYPE_PLANT or CELL_TYPE_MOSS
+    int birthTick;     // world tick the organism was created on
+    int maxAge;        // lifetime in ticks
+    int energy;        // gathered from light, spent on growth
+    int water;         // moisture held by the organism's cells at its last update
+    int nextTick;      // tick of its next update
+    int next;          // next organism in the same wheel slot or in the free list (-1 = none)
+    int cellCount;
+    int cells[ORGANISM_MAX_CELLS]; // grid indices (y * width + x)
+} Organism;
+
+// Pooled organism table with a timing wheel of pending updates
+typedef struct OrganismTable {
+    Organism* pool;     // slot i holds the organism with id i + 1
+    int capacity;
+    int freeList;       // first free slot (-1 = none)
+    int liveCount;
+    int actedLastTick;  // organisms updated by the last UpdateOrganisms call
+    int wheel[ORGANISM_WHEEL_SLOTS]; // first organism due in each slot (-1 = none)
+} OrganismTable;
+
+// Allocate and release the organism table (called from InitWorld/CleanupWorld)
+void InitOrganisms(World* world);
+void CleanupOrganisms(World* world);
+
+// Copy the table of another world; returns false when the pool cannot grow
+bool CopyOrganisms(World* dst, const World* src);
+
+// Register a freshly placed plant or moss cell. It joins a neighbouring organism
+// of the same type when that one has room, otherwise it founds a new organism.
+// Returns the organism id stored in the cell's objectID.
+int AddOrganismCell(World* world, int x, int y);
+
+// Re-register a plant or moss cell whose contents were restored (undo/redo).
+// Nothing changes when its organism still owns it; otherwise it joins or founds one.
+void ReattachOrganismCell(World* world, int x, int y);
+
+// Keep an organism's cell list in sync when MoveCell swaps one of its cells
+void OrganismCellMoved(World* world, int id, int fromX, int fromY, int toX, int toY);
+
+// Update the organisms due this tick
+void UpdateOrganisms(World* world);
+
+// Number of living organisms
+int GetOrganismCount(const World* world);
+
+#endif // ORGANISMS_H
@@ -0,0 +1,145 @@
+#include "palette.h"
+#include "fluid.h"
+#include <stdbool.h>
+#include <stdlib.h>
+
+static Color palette[PALETTE_SIZE];
+static bool paletteBuilt = false;
+
+// Every type's colors packed into words and sorted, for IsPaletteColor
+#define PALETTE_TYPE_ENTRIES (PALETTE_MOISTURE_BUCKETS * PALETTE_VARIATIONS)
+static uint32_t sortedColors[PALETTE_TYPES][PALETTE_TYPE_ENTRIES];
+
+static uint32_t PackColor(Color color) {
+    return (uint32_t)color.r | ((uint32_t)color.g << 8) | ((uint32_t)color.b << 16) | ((uint32_t)color.a << 24);
+}
+
+static int CompareWords(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Moisture that maps to the last bucket, per type (index = type + 1)
+static const int moistureRange[PALETTE_TYPES] = {
+    1,                // border
+    100,              // air
+    100,              // soil
+    WATER_MAX_MASS,   // water
+    100,              // plant
+    1,                // rock
+    100,              // moss
+};
+
+// 16.16 fixed-point factors turning moisture into a bucket without a division
+static int32_t bucketScale[PALETTE_TYPES];
+
+// Small fixed-seed generator so every build of the table is identical
+static uint32_t paletteRng = 0x2545F491u;
+static int PaletteRandom(int min, int max) {
+    paletteRng ^= paletteRng << 13;
+    paletteRng ^= paletteRng >> 17;
+    paletteRng ^= paletteRng << 5;
+    return min + (int)(paletteRng % (uint32_t)(max - min + 1));
+}
+
+// Color of one palette entry; 'level' is the bucket's moisture as a fraction of the range
+static Color EntryColor(int type, float level, const int variation[3]) {
+    switch (type) {
+        case CELL_TYPE_BORDER:
+            return DARKGRAY;
+
+        case CELL_TYPE_AIR: {
+            // Invisible until nearly saturated, then increasingly white
+            int moisture = (int)(level * 100.0f + 0.5f);
+            if (moisture <= 75) return BLACK;
+            int brightness = (moisture - 75) * (255 / 25);
+            return (Color){ brightness, brightness, brightness, 255 };
+        }
+
+        case CELL_TYPE_SOIL:
+            // Darker brown when wet
+            return (Color){ 127 - (level * 51), 106 - (level * 43), 79 - (level * 32), 255 };
+
+        case CELL_TYPE_WATER:
+            // Paler when it holds little water
+            return (Color){ 0 + (int)(200 * (1.0f - level)), 120 + (int)(135 * (1.0f - level)), 255, 255 };
+
+        case CELL_TYPE_PLANT:
+            return (Color){ 20 + variation[0] * 30 / 40 + 15, 150 + variation[1], 40 + variation[2], 255 };
+
+        case CELL_TYPE_ROCK: {
+            int gray = 128 + variation[0] * 15 / 20;
+            return (Color){ gray, gray, gray, 255 };
+        }
+
+        case CELL_TYPE_MOSS:
+            return (Color){ 10 + variation[0] / 4 + 5, 80 + variation[1] / 2, 30 + variation[2] / 2, 255 };
+    }
+    return BLACK;
+}
+
+void BuildPalette(void) {
+    if (paletteBuilt) return;
+
+    for (int t = 0; t < PALETTE_TYPES; t++) {
+        bucketScale[t] = (int32_t)(((int64_t)(PALETTE_MOISTURE_BUCKETS - 1) << 16) / moistureRange[t]);
+    }
+
+    for (int v = 0; v < PALETTE_VARIATIONS; v++) {
+        // One random offset per channel in [-20, 20], shared by every type and bucket
+        int variation[3] = { PaletteRandom(-20, 20), PaletteRandom(-20, 20), PaletteRandom(-20, 20) };
+
+        for (int t = 0; t < PALETTE_TYPES; t++) {
+            for (int b = 0; b < PALETTE_MOISTURE_BUCKETS; b++) {
+                float level = (float)b / (PALETTE_MOISTURE_BUCKETS - 1);
+                palette[(t * PALETTE_MOISTURE_BUCKETS + b) * PALETTE_VARIATIONS + v] = EntryColor(t - 1, level, variation);
+            }
+        }
+    }
+
+    for (int t = 0; t < PALETTE_TYPES; t++) {
+        for (int i = 0; i < PALETTE_TYPE_ENTRIES; i++) {
+            sortedColors[t][i] = PackColor(palette[t * PALETTE_TYPE_ENTRIES + i]);
+        }
+        qsort(sortedColors[t], PALETTE_TYPE_ENTRIES, sizeof(uint32_t), CompareWords);
+    }
+    paletteBuilt = true;
+}
+
+// Table index of a cell; moisture outside the type's range is clamped
+static inline int PaletteIndex(const GridCell* cell) {
+    int t = cell->type + 1;
+    int bucket = (int)(((int64_t)cell->moisture * bucketScale[t]) >> 16);
+    if (bucket < 0) bucket = 0;
+    if (bucket > PALETTE_MOISTURE_BUCKETS - 1) bucket = PALETTE_MOISTURE_BUCKETS - 1;
+    return (t * PALETTE_MOISTURE_BUCKETS + bucket) * PALETTE_VARIATIONS + (cell->variation & (PALETTE_VARIATIONS - 1));
+}
+
+Color CellColor(const GridCell* cell) {
+    return palette[PaletteIndex(cell)];
+}
+
+// Branch-free table lookups, one per cell. The index math is done in a first
+// pass over the row so the gather loop is a plain load/store the compiler can unroll.
+void FillCellColors(const World* world, int x0, int y, Color* out, int count) {
+    uint16_t index[256];
+    const GridCell* cells = world->cells + world->rowOffset[y];
+    const int* colOffset = world->colOffset + x0;
+
+    for (int start = 0; start < count; start += 256) {
+        int n = (count - start < 256) ? count - start : 256;
+        for (int i = 0; i < n; i++) {
+            index[i] = (uint16_t)PaletteIndex(&cells[colOffset[start + i]]);
+        }
+        for (int i = 0; i < n; i++) {
+            out[start + i] = palette[index[i]];
+        }
+    }
+}
+
+bool IsPaletteColor(int type, Color color) {
+    if (type < CELL_TYPE_BORDER || type > CELL_TYPE_MOSS) return false;
+    uint32_t word = PackColor(color);
+    return bsearch(&word, sortedColors[type + 1], PALETTE_TYPE_ENTRIES, sizeof(uint32_t), CompareWords) != NULL;
+}
@@ -0,0 +1,27 @@
+#ifndef PALETTE_H
+#define PALETTE_H
+
+#include "cell_types.h"
+#include "grid.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+// Cell colors are looked up at render time from (type, moisture bucket, variation)
+#define PALETTE_TYPES (CELL_TYPE_MOSS + 2)   // border plus every cell type
+#define PALETTE_MOISTURE_BUCKETS 128
+#define PALETTE_VARIATIONS 16                // per-cell color variation seeds (GridCell.variation)
+#define PALETTE_SIZE (PALETTE_TYPES * PALETTE_MOISTURE_BUCKETS * PALETTE_VARIATIONS)
+
+// Build the lookup table (shared by all worlds, safe to call more than once)
+void BuildPalette(void);
+
+// Color of a single cell
+Color CellColor(const GridCell* cell);
+
+// Colors of 'count' cells of row y, starting at column x0
+void FillCellColors(const World* world, int x0, int y, Color* out, int count);
+
+// True when some cell of the given type can be drawn in this color (after BuildPalette)
+bool IsPaletteColor(int type, Color color);
+
+#endif // PALETTE_H
@@ -0,0 +1,64 @@
+#include "random_tick.h"
+#include "simulation.h"
+#include "chunk_summary.h"
+#include "sim_lod.h"
+
+typedef struct {
+    RandomTickProcess process;
+    RandomTickFilter mayChange;
+} RandomTickEntry;
+
+// Slow processes driven by random ticks. Plant and moss growth and aging
+// are scheduled per organism instead (see organisms.c).
+static const RandomTickEntry randomTickProcesses[] = {
+    { EvaporateCell, MayEvaporateIn },
+};
+
+#define RANDOM_TICK_PROCESS_COUNT ((int)(sizeof(randomTickProcesses) / sizeof(randomTickProcesses[0])))
+
+void UpdateRandomTicks(World* world) {
+    // The filters read the chunk summaries
+    RefreshChunkSummaries(world);
+
+    // Interior cells only, the border never changes
+    for (int y0 = 1; y0 < world->height - 1; y0 += RANDOM_TICK_CHUNK_SIZE) {
+        int y1 = y0 + RANDOM_TICK_CHUNK_SIZE;
+        if (y1 > world->height - 1) y1 = world->height - 1;
+
+        for (int x0 = 1; x0 < world->width - 1; x0 += RANDOM_TICK_CHUNK_SIZE) {
+            int x1 = x0 + RANDOM_TICK_CHUNK_SIZE;
+            if (x1 > world->width - 1) x1 = world->width - 1;
+
+            // Chunks updated at a reduced rate make up for the ticks they sit out
+            if (!TileIsDue(world, x0, y0)) continue;
+
+            // Chunks where no process can change anything draw no samples
+            bool active[RANDOM_TICK_PROCESS_COUNT];
+            bool anyActive = false;
+            for (int p = 0; p < RANDOM_TICK_PROCESS_COUNT; p++) {
+                active[p] = randomTickProcesses[p].mayChange(world, x0, y0, x1, y1);
+                anyActive |= active[p];
+            }
+            if (!anyActive) continue;
+
+            // Each sample stands in for its share of the chunk's cells. Chunks that
+            // make up for skipped ticks draw that many times the samples, so a sample
+            // never stands in for more cells than at the full rate.
+            int cells = (x1 - x0) * (y1 - y0);
+            int span = TileTickSpan(world, x0, y0);
+            int samples = (cells < RANDOM_TICKS_PER_CHUNK * span) ? cells : RANDOM_TICKS_PER_CHUNK * span;
+            int scale = cells * span / samples;
+
+            for (int i = 0; i < samples; i++) {
+                // Keyed on the chunk and sample, so chunks can be sampled in any order
+                int keyX = x0 + i % RANDOM_TICK_CHUNK_SIZE;
+                int keyY = y0 + i / RANDOM_TICK_CHUNK_SIZE;
+                int x = CellRandom(world, keyX, keyY, RANDOM_TICK_X, x0, x1 - 1);
+                int y = CellRandom(world, keyX, keyY, RANDOM_TICK_Y, y0, y1 - 1);
+                for (int p = 0; p < RANDOM_TICK_PROCESS_COUNT; p++) {
+                    if (active[p]) randomTickProcesses[p].process(world, x, y, scale);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef RANDOM_TICK_H
+#define RANDOM_TICK_H
+
+#include "grid.h"
+
+// Random-tick sampling: instead of visiting every cell, slow processes run on
+// RANDOM_TICKS_PER_CHUNK random cells of each chunk per tick. Each process is
+// told how many cells the sample stands for and scales its effect to match.
+#define RANDOM_TICK_CHUNK_SIZE 16
+#define RANDOM_TICKS_PER_CHUNK 4
+
+// A slow process applied to one sampled cell
+typedef void (*RandomTickProcess)(World* world, int x, int y, int scale);
+
+// False when the process cannot change any cell in [x0, x1) x [y0, y1), so the
+// chunk's samples can skip it. The answer must hold while the chunk is processed.
+typedef bool (*RandomTickFilter)(const World* world, int x0, int y0, int x1, int y1);
+
+// Run every registered slow process on this tick's sampled cells
+void UpdateRandomTicks(World* world);
+
+#endif // RANDOM_TICK_H
@@ -0,0 +1,297 @@
+#include "reference_sim.h"
+#include "grid.h"
+#include "cell_types.h"
+#include "update_water.h"
+#include "fluid.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+static bool IsInterior(const World* world, int x, int y) {
+    return x > 0 && x < world->width - 1 && y > 0 && y < world->height - 1;
+}
+
+void RefMoveCell(World* world, int x1, int y1, int x2, int y2) {
+    if (!IsInterior(world, x1, y1) || !IsInterior(world, x2, y2)) {
+        return;
+    }
+
+    GridCell* a = GetCell(world, x1, y1);
+    GridCell* b = GetCell(world, x2, y2);
+    GridCell temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+//----------------------------------------------------------------------------------
+// Cellular water
+//----------------------------------------------------------------------------------
+
+static bool IsEmpty(const World* world, int x, int y) {
+    return GetCell(world, x, y)->type == CELL_TYPE_AIR;
+}
+
+static bool IsLiquid(const World* world, int x, int y) {
+    return GetCell(world, x, y)->type == CELL_TYPE_WATER;
+}
+
+// Solids and the border: anything that is neither air nor water
+static bool IsSolidOrFixed(const World* world, int x, int y) {
+    return !IsEmpty(world, x, y) && !IsLiquid(world, x, y);
+}
+
+// Decide where the water cell at (x, y) goes. Returns false when it stays put.
+static bool PickWaterMove(World* world, int x, int y, int* dx, int* dy, bool* falls) {
+    *falls = true;
+
+    // Fall straight down into air
+    if (IsEmpty(world, x, y + 1)) {
+        *dx = 0;
+        *dy = 1;
+        return true;
+    }
+
+    // Fall diagonally, picking a random side when both are open
+    bool downLeft = IsEmpty(world, x - 1, y + 1);
+    bool downRight = IsEmpty(world, x + 1, y + 1);
+    if (downLeft && downRight) {
+        *dx = (CellRandom(world, x, y, RANDOM_WATER_CHOICE, 0, 100) >= world->params.waterDiagonalChance) ? 1 : -1;
+        *dy = 1;
+        return true;
+    }
+    if (downLeft || downRight) {
+        *dx = downLeft ? -1 : 1;
+        *dy = 1;
+        return true;
+    }
+
+    // Sink below solids (moves into the border are refused by RefMoveCell)
+    if (IsSolidOrFixed(world, x, y + 1)) {
+        *dx = 0;
+        *dy = 1;
+        return true;
+    }
+
+    // Stay together with neighbouring water
+    *falls = false;
+    *dy = 0;
+    bool left = IsLiquid(world, x - 1, y);
+    bool right = IsLiquid(world, x + 1, y);
+    if (left && right) {
+        *dx = (CellRandom(world, x, y, RANDOM_WATER_CHOICE, 0, 100) >= world->params.waterSpreadChance) ? 1 : -1;
+        return true;
+    }
+    if (left || right) {
+        *dx = left ? -1 : 1;
+        return true;
+    }
+    return false;
+}
+
+static void RefUpdateWaterCellular(World* world) {
+    bool processRightToLeft = CellRandom(world, 0, 0, RANDOM_WATER_SCAN, 0, 1);
+    int startX = processRightToLeft ? world->width - 2 : 1;
+    int endX = processRightToLeft ? 0 : world->width - 1;
+    int stepX = processRightToLeft ? -1 : 1;
+
+    for (int y = world->height - 2; y >= 1; y--) {
+        for (int x = startX; x != endX; x += stepX) {
+            if (GetCell(world, x, y)->type != CELL_TYPE_WATER) continue;
+
+            int dx, dy;
+            bool falls;
+            bool hasMoved = false;
+            GetCell(world, x, y)->is_falling = false;
+            if (PickWaterMove(world, x, y, &dx, &dy, &falls)) {
+                RefMoveCell(world, x, y, x + dx, y + dy);
+                hasMoved = falls;
+            }
+
+            // Cells next to the border are never flagged as falling
+            if (x == 1 || x == world->width - 2 || y == 1 || y == world->height - 2) {
+                hasMoved = false;
+            }
+
+            // The flag lands on whatever now occupies (x, y)
+            GetCell(world, x, y)->is_falling = hasMoved;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------
+// Pressure water
+//----------------------------------------------------------------------------------
+
+static int LiquidMassAt(const World* world, int x, int y) {
+    return IsLiquid(world, x, y) ? GetCell(world, x, y)->moisture : 0;
+}
+
+static bool HoldsLiquid(const World* world, int x, int y) {
+    return IsEmpty(world, x, y) || IsLiquid(world, x, y);
+}
+
+static int StableMass(int total) {
+    if (total <= WATER_MAX_MASS) return total;
+    if (total < 2 * WATER_MAX_MASS + WATER_MAX_COMPRESS) {
+        return (WATER_MAX_MASS * WATER_MAX_MASS + total * WATER_MAX_COMPRESS) /
+               (WATER_MAX_MASS + WATER_MAX_COMPRESS);
+    }
+    return (total + WATER_MAX_COMPRESS) / 2;
+}
+
+static int ClampFlow(const World* world, int flow, int remaining, int tx, int ty, bool damp) {
+    if (flow >= remaining) return remaining;
+    if (flow < WATER_SETTLE_FLOW) return 0;
+    if (damp && flow > WATER_MIN_FLOW) flow /= 2;
+    if (IsEmpty(world, tx, ty) && flow < WATER_MIN_MASS) return 0;
+    return flow;
+}
+
+static void RefUpdateWaterPressure(World* world) {
+    int width = world->width;
+    int height = world->height;
+    int* delta = (int*)calloc((size_t)width * height, sizeof(int));
+    if (!delta) {
+        printf("ERROR: Failed to allocate reference water buffer\n");
+        return;
+    }
+
+    // Every interior water cell sends mass down, then sideways, then up
+    for (int y = 1; y < height - 1; y++) {
+        for (int x = 1; x < width - 1; x++) {
+            if (!IsLiquid(world, x, y) || GetCell(world, x, y)->moisture <= 0) continue;
+
+            int mass = GetCell(world, x, y)->moisture;
+            int remaining = mass;
+            int index = y * width + x;
+
+            if (HoldsLiquid(world, x, y + 1)) {
+                int below = LiquidMassAt(world, x, y + 1);
+                int flow = ClampFlow(world, StableMass(remaining + below) - below, remaining, x, y + 1, false);
+                if (flow > 0) {
+                    delta[index] -= flow;
+                    delta[index + width] += flow;
+                    remaining -= flow;
+                }
+            }
+
+            for (int side = -1; side <= 1 && remaining > 0; side += 2) {
+                if (!HoldsLiquid(world, x + side, y)) continue;
+                int flow = ClampFlow(world, (mass - LiquidMassAt(world, x + side, y)) / 4, remaining, x + side, y, true);
+                if (flow > 0) {
+                    delta[index] -= flow;
+                    delta[index + side] += flow;
+                    remaining -= flow;
+                }
+            }
+
+            if (remaining > 0 && HoldsLiquid(world, x, y - 1)) {
+                int flow = ClampFlow(world, remaining - StableMass(remaining + LiquidMassAt(world, x, y - 1)),
+                                     remaining, x, y - 1, true);
+                if (flow > 0) {
+                    delta[index] -= flow;
+                    delta[index - width] += flow;
+                }
+            }
+        }
+    }
+
+    // Apply the flows, turning air into water and drained water into air
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int d = delta[y * width + x];
+            if (d == 0) continue;
+
+            GridCell* cell = GetCell(world, x, y);
+            cell->moisture += d;
+            cell->is_falling = false;
+            if (cell->type != CELL_TYPE_AIR && cell->moisture <= 0) {
+                cell->type = CELL_TYPE_AIR;
+                cell->volume = 1;
+            } else {
+                cell->type = CELL_TYPE_WATER;
+                int volume = 1 + (cell->moisture * 9) / WATER_MAX_MASS;
+                cell->volume = (volume > 10) ? 10 : volume;
+            }
+        }
+    }
+
+    free(delta);
+}
+
+void RefUpdateWater(World* world) {
+    if (world->waterModel == WATER_MODEL_PRESSURE) {
+        RefUpdateWaterPressure(world);
+    } else {
+        RefUpdateWaterCellular(world);
+    }
+}
+
+//----------------------------------------------------------------------------------
+// Air
+//----------------------------------------------------------------------------------
+
+void RefMergeAirMoisture(World* world, int x, int y) {
+    if (GetCell(world, x, y)->type != CELL_TYPE_AIR) return;
+
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            int nx = x + dx;
+            int ny = y + dy;
+            if ((dx == 0 && dy == 0) || nx < 0 || nx >= world->width || ny < 0 || ny >= world->height) {
+                continue;
+            }
+
+            GridCell* source = GetCell(world, nx, ny);
+            GridCell* target = GetCell(world, x, y);
+            if (source->type == CELL_TYPE_AIR && source->moisture > target->moisture + 5) {
+                int transfer = (source->moisture - target->moisture) / 4;
+                source->moisture -= transfer;
+                target->moisture += transfer;
+            }
+        }
+    }
+}
+
+void RefUpdateAir(World* world) {
+    // Moist air rises into drier air
+    for (int y = 1; y < world->height - 1; y++) {
+        for (int x = 1; x < world->width - 1; x++) {
+            GridCell* cell = GetCell(world, x, y);
+            if (cell->type == CELL_TYPE_AIR && cell->moisture > 30 &&
+                GetCell(world, x, y - 1)->type == CELL_TYPE_AIR &&
+                GetCell(world, x, y - 1)->moisture < cell->moisture - 10) {
+                RefMoveCell(world, x, y, x, y - 1);
+            }
+        }
+    }
+
+    // Clouds in the top rows: merge, condense into droplets, or drift diagonally upward
+    for (int y = 1; y < 10 && y < world->height - 1; y++) {
+        for (int x = 1; x < world->width - 1; x++) {
+            if (GetCell(world, x, y)->type != CELL_TYPE_AIR) continue;
+
+            float saturationLimit = world->params.saturationBase +
+                                    (GetRowTemperature(world, y) * world->params.saturationPerDegree);
+            RefMergeAirMoisture(world, x, y);
+
+            GridCell* cell = GetCell(world, x, y);
+            int excess = cell->moisture - saturationLimit;
+            if (excess > 20 || cell->moisture > 100) {
+                cell->type = CELL_TYPE_WATER;
+                cell->is_falling = true;
+                continue;
+            }
+
+            bool upLeft = GetCell(world, x - 1, y - 1)->type == CELL_TYPE_AIR &&
+                          GetCell(world, x - 1, y - 1)->moisture < cell->moisture;
+            bool upRight = GetCell(world, x + 1, y - 1)->type == CELL_TYPE_AIR &&
+                           GetCell(world, x + 1, y - 1)->moisture < cell->moisture;
+            if (upLeft && upRight) {
+                int dx = (CellRandom(world, x, y, RANDOM_AIR_DIAGONAL, 0, 1) == 0) ? -1 : 1;
+                RefMoveCell(world, x, y, x + dx, y - 1);
+            } else if (upLeft || upRight) {
+                RefMoveCell(world, x, y, upLeft ? x - 1 : x + 1, y - 1);
+            }
+        }
+    }
+}
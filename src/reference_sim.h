@@ -0,0 +1,28 @@
+#ifndef REFERENCE_SIM_H
+#define REFERENCE_SIM_H
+
+#include "grid.h"
+
+// Frozen, deliberately plain versions of the simulation passes. They define the
+// expected behaviour of the optimized passes (UpdateWater, UpdateAir,
+// MergeAirMoisture, MoveCell) and are only used by the --verify harness, so
+// they must not be optimized or changed together with the code they check.
+//
+// The reference passes consume the world's random stream in the same order as
+// the optimized ones. They only touch the grid: no dirty tiles, fluid wake-ups,
+// activity counters or organism bookkeeping.
+
+// Swap two cells, unless either is out of bounds or on the border
+void RefMoveCell(World* world, int x1, int y1, int x2, int y2);
+
+// Water movement for the current water model. The pressure model is solved over
+// the whole grid every tick, without putting settled chunks to sleep.
+void RefUpdateWater(World* world);
+
+// Moist air rising and clouds forming in the top rows
+void RefUpdateAir(World* world);
+
+// Pull moisture into an air cell from moister neighbouring air
+void RefMergeAirMoisture(World* world, int x, int y);
+
+#endif // REFERENCE_SIM_H
@@ -0,0 +1,227 @@
+#include "region_stats.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TILE_CELLS (DIRTY_TILE_SIZE * DIRTY_TILE_SIZE)
+
+struct RegionStats {
+    int tilesX;
+    int tilesY;
+    uint32_t epoch;             // tile epoch the tables are up to date with
+    int32_t* moisture;          // per tile, inclusive prefix sums over its cells
+    uint16_t* counts;           // per tile and material, inclusive prefix sums
+    long long* tileMoisture;    // summed-area table over tile totals, (tilesX + 1) x (tilesY + 1)
+    int* tileCounts;            // the same per material
+};
+
+bool InitRegionStats(World* world) {
+    CleanupRegionStats(world);
+
+    RegionStats* stats = (RegionStats*)calloc(1, sizeof(RegionStats));
+    if (!stats) {
+        printf("ERROR: Failed to allocate region statistics\n");
+        return false;
+    }
+    stats->tilesX = (world->width + DIRTY_TILE_SIZE - 1) / DIRTY_TILE_SIZE;
+    stats->tilesY = (world->height + DIRTY_TILE_SIZE - 1) / DIRTY_TILE_SIZE;
+
+    size_t tiles = (size_t)stats->tilesX * stats->tilesY;
+    size_t corners = (size_t)(stats->tilesX + 1) * (stats->tilesY + 1);
+    stats->moisture = (int32_t*)malloc(tiles * TILE_CELLS * sizeof(int32_t));
+    stats->counts = (uint16_t*)malloc(tiles * REGION_MATERIALS * TILE_CELLS * sizeof(uint16_t));
+    stats->tileMoisture = (long long*)calloc(corners, sizeof(long long));
+    stats->tileCounts = (int*)calloc(corners * REGION_MATERIALS, sizeof(int));
+    if (!stats->moisture || !stats->counts || !stats->tileMoisture || !stats->tileCounts) {
+        printf("ERROR: Failed to allocate region statistics\n");
+        free(stats->moisture);
+        free(stats->counts);
+        free(stats->tileMoisture);
+        free(stats->tileCounts);
+        free(stats);
+        return false;
+    }
+
+    // Epoch 0 is older than every tile, so the first refresh builds everything
+    stats->epoch = 0;
+    world->regionStats = stats;
+    return true;
+}
+
+void CleanupRegionStats(World* world) {
+    RegionStats* stats = world->regionStats;
+    if (!stats) return;
+
+    free(stats->moisture);
+    free(stats->counts);
+    free(stats->tileMoisture);
+    free(stats->tileCounts);
+    free(stats);
+    world->regionStats = NULL;
+}
+
+// Prefix sums of one tile; cells past the edge of the grid count as empty
+static void BuildTileTables(RegionStats* stats, const World* world, int tx, int ty) {
+    int tile = ty * stats->tilesX + tx;
+    int32_t* moisture = stats->moisture + (size_t)tile * TILE_CELLS;
+    uint16_t* counts = stats->counts + (size_t)tile * REGION_MATERIALS * TILE_CELLS;
+    int x0 = tx * DIRTY_TILE_SIZE;
+    int y0 = ty * DIRTY_TILE_SIZE;
+
+    for (int ly = 0; ly < DIRTY_TILE_SIZE; ly++) {
+        int y = y0 + ly;
+        int32_t rowMoisture = 0;
+        uint16_t rowCounts[REGION_MATERIALS] = { 0 };
+
+        for (int lx = 0; lx < DIRTY_TILE_SIZE; lx++) {
+            int x = x0 + lx;
+            if (x < world->width && y < world->height) {
+                const GridCell* cell = GetCell(world, x, y);
+                rowMoisture += cell->moisture;
+                if (cell->type >= 0 && cell->type < REGION_MATERIALS) rowCounts[cell->type]++;
+            }
+
+            int i = ly * DIRTY_TILE_SIZE + lx;
+            moisture[i] = rowMoisture + (ly ? moisture[i - DIRTY_TILE_SIZE] : 0);
+            for (int m = 0; m < REGION_MATERIALS; m++) {
+                uint16_t* table = counts + m * TILE_CELLS;
+                table[i] = rowCounts[m] + (ly ? table[i - DIRTY_TILE_SIZE] : 0);
+            }
+        }
+    }
+}
+
+// Summed-area table over the tile totals (the last entry of each tile's tables)
+static void BuildTileLevelTables(RegionStats* stats) {
+    int stride = stats->tilesX + 1;
+    size_t corners = (size_t)stride * (stats->tilesY + 1);
+
+    for (int ty = 0; ty < stats->tilesY; ty++) {
+        long long rowMoisture = 0;
+        int rowCounts[REGION_MATERIALS] = { 0 };
+        for (int tx = 0; tx < stats->tilesX; tx++) {
+            size_t tile = (size_t)ty * stats->tilesX + tx;
+            rowMoisture += stats->moisture[tile * TILE_CELLS + TILE_CELLS - 1];
+
+            size_t at = (size_t)(ty + 1) * stride + tx + 1;
+            stats->tileMoisture[at] = rowMoisture + stats->tileMoisture[at - stride];
+            for (int m = 0; m < REGION_MATERIALS; m++) {
+                rowCounts[m] += stats->counts[(tile * REGION_MATERIALS + m) * TILE_CELLS + TILE_CELLS - 1];
+                int* table = stats->tileCounts + m * corners;
+                table[at] = rowCounts[m] + table[at - stride];
+            }
+        }
+    }
+}
+
+void RefreshRegionStats(const World* world) {
+    RegionStats* stats = world->regionStats;
+    if (!stats) return;
+
+    uint32_t epoch = AdvanceTileEpoch(world);
+    bool changed = false;
+    for (int ty = 0; ty < stats->tilesY; ty++) {
+        for (int tx = 0; tx < stats->tilesX; tx++) {
+            if (TileChangedSince(world, ty * stats->tilesX + tx, stats->epoch)) {
+                BuildTileTables(stats, world, tx, ty);
+                changed = true;
+            }
+        }
+    }
+    if (changed) BuildTileLevelTables(stats);
+    stats->epoch = epoch;
+}
+
+// Add the cells [lx0, lx1] x [ly0, ly1] (inclusive, tile-local) of one tile
+static void AddTileRect(const RegionStats* stats, int tile, int lx0, int ly0, int lx1, int ly1, RegionSummary* sum) {
+    int a = ly1 * DIRTY_TILE_SIZE + lx1;
+    int b = (ly0 > 0) ? (ly0 - 1) * DIRTY_TILE_SIZE + lx1 : -1;
+    int c = (lx0 > 0) ? ly1 * DIRTY_TILE_SIZE + lx0 - 1 : -1;
+    int d = (ly0 > 0 && lx0 > 0) ? (ly0 - 1) * DIRTY_TILE_SIZE + lx0 - 1 : -1;
+
+    const int32_t* moisture = stats->moisture + (size_t)tile * TILE_CELLS;
+    sum->moisture += moisture[a] - (b >= 0 ? moisture[b] : 0) - (c >= 0 ? moisture[c] : 0) + (d >= 0 ? moisture[d] : 0);
+    for (int m = 0; m < REGION_MATERIALS; m++) {
+        const uint16_t* table = stats->counts + ((size_t)tile * REGION_MATERIALS + m) * TILE_CELLS;
+        sum->counts[m] += table[a] - (b >= 0 ? table[b] : 0) - (c >= 0 ? table[c] : 0) + (d >= 0 ? table[d] : 0);
+    }
+}
+
+// Add the tiles [tx0, tx1) x [ty0, ty1) from the tile-level tables
+static void AddTileBlock(const RegionStats* stats, int tx0, int ty0, int tx1, int ty1, RegionSummary* sum) {
+    int stride = stats->tilesX + 1;
+    size_t corners = (size_t)stride * (stats->tilesY + 1);
+    size_t a = (size_t)ty1 * stride + tx1;
+    size_t b = (size_t)ty0 * stride + tx1;
+    size_t c = (size_t)ty1 * stride + tx0;
+    size_t d = (size_t)ty0 * stride + tx0;
+
+    sum->moisture += stats->tileMoisture[a] - stats->tileMoisture[b] - stats->tileMoisture[c] + stats->tileMoisture[d];
+    for (int m = 0; m < REGION_MATERIALS; m++) {
+        const int* table = stats->tileCounts + m * corners;
+        sum->counts[m] += table[a] - table[b] - table[c] + table[d];
+    }
+}
+
+// Without tables, visit the cells
+static void ScanRegion(const World* world, int x0, int y0, int x1, int y1, RegionSummary* sum) {
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
+            const GridCell* cell = GetCell(world, x, y);
+            sum->moisture += cell->moisture;
+            if (cell->type >= 0 && cell->type < REGION_MATERIALS) sum->counts[cell->type]++;
+        }
+    }
+}
+
+RegionSummary QueryRegion(const World* world, int x0, int y0, int x1, int y1) {
+    RegionSummary sum;
+    memset(&sum, 0, sizeof(sum));
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > world->width) x1 = world->width;
+    if (y1 > world->height) y1 = world->height;
+    if (x0 >= x1 || y0 >= y1) return sum;
+    sum.cells = (x1 - x0) * (y1 - y0);
+
+    const RegionStats* stats = world->regionStats;
+    if (!stats) {
+        ScanRegion(world, x0, y0, x1, y1, &sum);
+        return sum;
+    }
+    RefreshRegionStats(world);
+
+    // Tiles touched by the rectangle, and the block of those it covers completely.
+    // The grid's last row and column of tiles may be partial, which counts as
+    // covered when the rectangle reaches the grid's edge.
+    int tx0 = x0 >> DIRTY_TILE_SHIFT;
+    int ty0 = y0 >> DIRTY_TILE_SHIFT;
+    int tx1 = (x1 - 1) >> DIRTY_TILE_SHIFT;
+    int ty1 = (y1 - 1) >> DIRTY_TILE_SHIFT;
+    int ix0 = (x0 + DIRTY_TILE_SIZE - 1) >> DIRTY_TILE_SHIFT;
+    int iy0 = (y0 + DIRTY_TILE_SIZE - 1) >> DIRTY_TILE_SHIFT;
+    int ix1 = (x1 == world->width) ? stats->tilesX : x1 >> DIRTY_TILE_SHIFT;
+    int iy1 = (y1 == world->height) ? stats->tilesY : y1 >> DIRTY_TILE_SHIFT;
+    bool hasBlock = ix0 < ix1 && iy0 < iy1;
+    if (hasBlock) {
+        AddTileBlock(stats, ix0, iy0, ix1, iy1, &sum);
+    }
+
+    // The remaining tiles along the rectangle's edges
+    for (int ty = ty0; ty <= ty1; ty++) {
+        int ly0 = (ty == ty0) ? y0 - ty * DIRTY_TILE_SIZE : 0;
+        int ly1 = (ty == ty1) ? y1 - 1 - ty * DIRTY_TILE_SIZE : DIRTY_TILE_SIZE - 1;
+        bool blockRow = hasBlock && ty >= iy0 && ty < iy1;
+
+        for (int tx = tx0; tx <= tx1; tx++) {
+            if (blockRow && tx == ix0) {
+                tx = ix1 - 1;
+                continue;
+            }
+            int lx0 = (tx == tx0) ? x0 - tx * DIRTY_TILE_SIZE : 0;
+            int lx1 = (tx == tx1) ? x1 - 1 - tx * DIRTY_TILE_SIZE : DIRTY_TILE_SIZE - 1;
+            AddTileRect(stats, ty * stats->tilesX + tx, lx0, ly0, lx1, ly1, &sum);
+        }
+    }
+    return sum;
+}
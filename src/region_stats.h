@@ -0,0 +1,34 @@
+#ifndef REGION_STATS_H
+#define REGION_STATS_H
+
+#include "grid.h"
+#include "dirty_tiles.h"
+
+// Totals over rectangles of the grid without visiting its cells. Every dirty
+// tile (DIRTY_TILE_SIZE square) keeps summed-area tables of moisture and of the
+// count of each material, and a table over the tile totals covers the tiles a
+// rectangle contains completely. A query reads four entries per table for the
+// inner block and per tile on the rectangle's edge, so its cost depends on the
+// rectangle's perimeter in tiles, not its area. Tables of tiles that changed
+// are rebuilt on the next query.
+#define REGION_MATERIALS (CELL_TYPE_MOSS + 1)
+
+typedef struct RegionStats RegionStats;
+
+typedef struct {
+    long long moisture;               // all cells, as CalculateTotalMoisture
+    int cells;                        // cells in the rectangle after clipping
+    int counts[REGION_MATERIALS];     // cells per material (border cells are not counted)
+} RegionSummary;
+
+// Allocate the world's tables (optional: queries scan the cells without them)
+bool InitRegionStats(World* world);
+void CleanupRegionStats(World* world);
+
+// Rebuild the tables of tiles changed since the last refresh
+void RefreshRegionStats(const World* world);
+
+// Totals over [x0, x1) x [y0, y1), clipped to the grid
+RegionSummary QueryRegion(const World* world, int x0, int y0, int x1, int y1);
+
+#endif // REGION_STATS_H
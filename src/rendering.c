@@ -2,384 +2,441 @@
 #include "raylib.h"
 #include "grid.h"
 #include "cell_types.h"
+#include "update_water.h"
+#include "telemetry.h"
+#include "region_stats.h"
+#include "sim_lod.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
-// External variables needed for UI rendering
-extern int brushRadius;
-extern int currentSelectedType;
+// Upload a rectangle of a pyramid level, copied row by row into the staging buffer
+static void UploadLevelRect(AppState* app, int n, int x0, int y0, int x1, int y1) {
+    const PyramidLevel* level = &app->pyramid.level[n];
+    Color* staging = app->textures.staging;
+    int width = x1 - x0;
 
-// Declare viewportX, viewportY, and cellSize as global variables
-int viewportX = 0;
-int viewportY = 0;
-int cellSize = 8; // Default value, will be updated dynamically in DrawGameGrid
+    for (int y = y0; y < y1; y++) {
+        memcpy(&staging[(y - y0) * width], &level->pixels[y * level->width + x0], width * sizeof(Color));
+    }
+    UpdateTextureRec(app->textures.level[n], (Rectangle){ x0, y0, width, y1 - y0 }, staging);
 
-// Declare viewportContentOffsetX and viewportContentOffsetY as external variables
-extern int viewportContentOffsetX;
-extern int viewportContentOffsetY;
+    app->textures.uploadedBytes += width * (y1 - y0) * (int)sizeof(Color);
+    app->textures.uploadedRects++;
+}
 
-// Update the viewport and cell size dynamically based on the window resolution
-void DrawGameGrid(void) {
-    // Get the current render dimensions
-    int screenWidth = GetRenderWidth();
-    int screenHeight = GetRenderHeight();
+// Texture holding a pyramid level, brought up to date with the level
+static Texture2D GetLevelTexture(AppState* app, int n) {
+    const PyramidLevel* level = &app->pyramid.level[n];
+    Texture2D* texture = &app->textures.level[n];
+    int levelBytes = level->width * level->height * (int)sizeof(Color);
+
+    if (texture->id == 0) {
+        Image image = { level->pixels, level->width, level->height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+        *texture = LoadTextureFromImage(image);
+        SetTextureFilter(*texture, TEXTURE_FILTER_POINT);
+        app->textures.version[n] = level->version;
+        app->textures.uploadedBytes += levelBytes;
+        app->textures.uploadedRects++;
+    } else if (app->textures.version[n] + 1 == level->version && app->textures.staging) {
+        // Only the rectangles changed by the last refresh, in this level's texels
+        for (int r = 0; r < app->pyramid.rectCount; r++) {
+            const DirtyRect* rect = &app->pyramid.rects[r];
+            UploadLevelRect(app, n, rect->x0 >> n, rect->y0 >> n,
+                            ((rect->x1 - 1) >> n) + 1, ((rect->y1 - 1) >> n) + 1);
+        }
+        app->textures.version[n] = level->version;
+    } else if (app->textures.version[n] != level->version) {
+        // Missed more than one refresh (the level was not drawn), send it all
+        UpdateTexture(*texture, level->pixels);
+        app->textures.version[n] = level->version;
+        app->textures.uploadedBytes += levelBytes;
+        app->textures.uploadedRects++;
+    }
+    return *texture;
+}
 
-    // Calculate DPI scaling factor
-    Vector2 dpiScale = GetWindowScaleDPI(); // Adjust viewport size based on DPI
+void UnloadGridTextures(AppState* app) {
+    for (int n = 0; n < PYRAMID_MAX_LEVELS; n++) {
+        if (app->textures.level[n].id != 0) {
+            UnloadTexture(app->textures.level[n]);
+        }
+    }
+    free(app->textures.staging);
+    app->textures = (GridTextures){ 0 };
+}
 
-    // Use the horizontal DPI scaling factor for calculations
-    float dpiScaleFactor = dpiScale.x;
+// Screen rectangle of the minimap, in the bottom-right corner of the viewport
+Rectangle GetMinimapRect(const AppState* app, const World* world) {
+    const Viewport* view = &app->view;
+    float scale = (float)MINIMAP_SIZE / ((world->width > world->height) ? world->width : world->height);
+    float width = world->width * scale;
+    float height = world->height * scale;
+    return (Rectangle){ view->x + view->width - width - 10, view->y + view->height - height - 10, width, height };
+}
 
-    // Calculate UI scaling and viewport dimensions
-    float uiScale = (screenWidth >= 3840 && screenHeight >= 2160) ? 1.5f : 1.0f;
-    int uiWidth = 300 * uiScale * dpiScaleFactor; // UI panel width scales with resolution and DPI
-    int viewportWidth = screenWidth - uiWidth * 2; // Subtract UI width from total screen width
+// Draw the whole world from a small pyramid level, with the visible area outlined
+static void DrawMinimap(AppState* app, const World* world) {
+    const Viewport* view = &app->view;
+    Rectangle bounds = GetMinimapRect(app, world);
+
+    int n = PyramidLevelForSize(&app->pyramid, (int)bounds.width, (int)bounds.height);
+    Texture2D texture = GetLevelTexture(app, n);
+
+    DrawRectangleRec(bounds, BLACK);
+    DrawTexturePro(texture, (Rectangle){ 0, 0, texture.width, texture.height }, bounds, (Vector2){ 0, 0 }, 0.0f, WHITE);
+    DrawRectangleLinesEx(bounds, 1.0f, GRAY);
+
+    // Outline the part of the world in the viewport
+    float scale = bounds.width / world->width;
+    Rectangle visible = {
+        bounds.x + view->cameraX * scale,
+        bounds.y + view->cameraY * scale,
+        view->width / view->zoom * scale,
+        view->height / view->zoom * scale
+    };
+    DrawRectangleLinesEx(visible, 1.0f, WHITE);
+}
 
-    // Correct the calculation for the viewport height to ensure it matches the visible area
-    int viewportHeight = GetRenderHeight() - 80; // Subtract 80 pixels for UI
+// Draw the visible part of the world from the pyramid level that matches the zoom,
+// so the cost is bounded by the viewport's pixels rather than the world's cells
+void DrawGameGrid(AppState* app, World* world) {
+    Viewport* view = &app->view;
 
-    // Adjust the endRow calculation to ensure it fits within the viewport
-    int endRow = (viewportContentOffsetY + viewportHeight) / cellSize;
-    if ((viewportContentOffsetY + viewportHeight) % cellSize != 0) {
-        endRow += 1; // Include partially visible rows
-    }
-    if (endRow > GRID_HEIGHT) {
-        endRow = GRID_HEIGHT; // Clamp to grid height
-    }
+    // The viewport rectangle comes from the shared layout (see UpdatePanelLayout)
+    ClampViewport(view, world->width, world->height);
 
-    // Ensure the grid height matches the viewport height
-    int totalVisibleCells = viewportHeight / cellSize;
-    if (GRID_HEIGHT > totalVisibleCells) {
-        GRID_HEIGHT = totalVisibleCells;
+    // Bring the color pyramid up to date with the tiles the simulation changed
+    RefreshColorPyramid(&app->pyramid, world);
+    if (app->pyramid.levelCount == 0) return;
+
+    // Staging space for partial uploads, large enough for all of level 0
+    if (!app->textures.staging) {
+        app->textures.staging = (Color*)malloc((size_t)world->width * world->height * sizeof(Color));
     }
+    app->textures.uploadedBytes = 0;
+    app->textures.uploadedRects = 0;
 
-    // Adjust rendering logic to use viewportContentOffsetX and viewportContentOffsetY
-    int startRow = viewportContentOffsetY / cellSize;
+    int n = PyramidLevelForZoom(&app->pyramid, view->zoom);
+    Texture2D texture = GetLevelTexture(app, n);
+    float texelSize = (float)(1 << n); // cells per texel
 
-    int startCol = viewportContentOffsetX / cellSize;
-    int endCol = (viewportContentOffsetX + viewportWidth) / cellSize;
-    if (endCol > GRID_WIDTH) {
-        endCol = GRID_WIDTH;
-    }
+    // Visible cell range, clipped to the world
+    float left = (view->cameraX > 0.0f) ? view->cameraX : 0.0f;
+    float top = (view->cameraY > 0.0f) ? view->cameraY : 0.0f;
+    float right = view->cameraX + view->width / view->zoom;
+    float bottom = view->cameraY + view->height / view->zoom;
+    if (right > world->width) right = world->width;
+    if (bottom > world->height) bottom = world->height;
+
+    Rectangle source = { left / texelSize, top / texelSize, (right - left) / texelSize, (bottom - top) / texelSize };
+    Vector2 topLeft = CellToScreen(view, left, top);
+    Rectangle dest = { topLeft.x, topLeft.y, (right - left) * view->zoom, (bottom - top) * view->zoom };
 
     // Begin the scissor mode to restrict drawing to the viewport
-    BeginScissorMode(viewportX, viewportY, viewportWidth, viewportHeight);
-
-    // Draw only the cells within the viewport, adjusted for content offset
-    for (int i = startRow; i < endRow; i++) {
-        for (int j = startCol; j < endCol; j++) {
-            if (i >= 0 && i < GRID_HEIGHT && j >= 0 && j < GRID_WIDTH) {
-                Color cellColor = grid[i][j].baseColor;
-                DrawRectangle(
-                    (j - startCol) * cellSize, // Adjust for content offset
-                    (i - startRow) * cellSize,
-                    cellSize, // Use dynamic cell size for width
-                    cellSize, // Use dynamic cell size for height
-                    cellColor
-                );
-            }
-<<<<<<< HEAD
-            // Fix for pink, purple or undefined colors for other cell types
-            else if((cellColor.r > 200 && cellColor.g < 100 && cellColor.b > 200) || 
-                    (cellColor.r > 200 && cellColor.g < 100 && cellColor.b > 100)) {
-                // This is detecting pink/purple-ish colors
-                switch(grid[i][j].type) {
-                    case CELL_TYPE_SOIL: // Soil
-                        {
-                            // Re-calculate soil color based on proper moisture range
-                            float intensityPct = (float)grid[i][j].moisture / 100.0f;
-                            cellColor = (Color){
-                                127 - (intensityPct * 51),
-                                106 - (intensityPct * 43),
-                                79 - (intensityPct * 32),
-                                255
-                            };
-                        }
-                        break;
-                    case CELL_TYPE_WATER: // Water
-                        {
-                            // Re-calculate water color based on proper moisture range
-                            float intensityPct = (float)grid[i][j].moisture / 1000.0f;
-                            cellColor = (Color){
-                                0 + (int)(200 * (1.0f - intensityPct)),
-                                120 + (int)(135 * (1.0f - intensityPct)),
-                                255,
-                                255
-                            };
-                        }
-                        break;
-                    case CELL_TYPE_PLANT: // Plant
-                        cellColor = GREEN;
-                        break;
-                    default:
-                        cellColor = BLACK; // Default fallback
-                        break;
-                }
-                
-                // Update the stored color
-                grid[i][j].baseColor = cellColor;
-            }
-            
-            DrawRectangle(
-                j * CELL_SIZE,
-                i * CELL_SIZE,
-                CELL_SIZE - 1,
-                CELL_SIZE - 1,
-                cellColor
-            );
-=======
->>>>>>> 830d381957084d1f958f8e1e434dff1cc3f303a7
-        }
+    BeginScissorMode(view->x, view->y, view->width, view->height);
+
+    DrawTexturePro(texture, source, dest, (Vector2){ 0, 0 }, 0.0f, WHITE);
+
+    if (app->showMinimap) {
+        DrawMinimap(app, world);
     }
 
     // End the scissor mode
     EndScissorMode();
 }
 
-// Draw UI elements
-void DrawUI(void) {
-    // Draw cell type selection UI
-    const int buttonSize = 64;
-    const int padding = 10;
-    const int startX = 10;
-    const int startY = 10;
-    
-    // Cell type labels for UI
-    const char* typeLabels[] = {
-        "Air", "Soil", "Water", "Plant", "Rock", "Moss"
-    };
-    
-    // Cell type colors for UI
-    Color typeColors[] = {
-        WHITE,                          // Air
-        (Color){127, 106, 79, 255},     // Soil
-        BLUE,                           // Water
-        GREEN,                          // Plant 
-        DARKGRAY,                       // Rock
-        DARKGREEN                       // Moss
-    };
-    
-    // Draw cell type buttons
-    for (int i = 0; i <= CELL_TYPE_MOSS; i++) {
-        int posX = startX + (buttonSize + padding) * i;
-        
-        // Draw button background (highlight if selected)
-        DrawRectangle(posX, startY, buttonSize, buttonSize, 
-                     (i == currentSelectedType) ? LIGHTGRAY : DARKGRAY);
-        
-        // Draw cell type color preview
-        DrawRectangle(posX + 5, startY + 5, buttonSize - 10, buttonSize - 25, typeColors[i]);
-        
-        // Draw type name
-        DrawText(typeLabels[i], posX + 5, startY + buttonSize - 18, 16, WHITE);
+// Series that can be plotted from the telemetry ring buffer
+enum {
+    SERIES_AIR_MOISTURE,
+    SERIES_WATER_MOISTURE,
+    SERIES_SOIL_MOISTURE,
+    SERIES_ACTIVE_CELLS,
+    SERIES_COUNT
+};
+
+static float TelemetryValue(const TelemetrySample* sample, int series) {
+    switch (series) {
+        case SERIES_AIR_MOISTURE: return (float)sample->airMoisture;
+        case SERIES_WATER_MOISTURE: return (float)sample->waterMoisture;
+        case SERIES_SOIL_MOISTURE: return (float)sample->soilMoisture;
+        case SERIES_ACTIVE_CELLS: return (float)sample->activeCells;
+    }
+    return 0.0f;
+}
+
+// Draw one telemetry series as a sparkline scaled to its own range
+static void DrawSparkline(UIPanel* panel, const World* world, int x, int y, int width, int height, int series, Color color) {
+    int count = GetTelemetryCount(world);
+    if (count > width) count = width; // One sample per pixel at most
+    if (count < 2) return;
+
+    int first = GetTelemetryCount(world) - count;
+    float minValue = TelemetryValue(GetTelemetrySample(world, first), series);
+    float maxValue = minValue;
+    for (int i = 1; i < count; i++) {
+        float value = TelemetryValue(GetTelemetrySample(world, first + i), series);
+        if (value < minValue) minValue = value;
+        if (value > maxValue) maxValue = value;
+    }
+    float range = (maxValue > minValue) ? (maxValue - minValue) : 1.0f;
+
+    Vector2 previous = { 0 };
+    for (int i = 0; i < count; i++) {
+        float value = TelemetryValue(GetTelemetrySample(world, first + i), series);
+        Vector2 point = {
+            x + (float)i * (width - 1) / (count - 1),
+            y + height - 1 - (value - minValue) / range * (height - 1)
+        };
+        if (i > 0) {
+            DrawLineV(previous, point, color);
+            panel->drawCalls++;
+        }
+        previous = point;
+    }
+}
+
+// Draw the recent history of world statistics
+static void DrawTelemetryGraph(UIPanel* panel, const World* world, int x, int y, int width) {
+    const char* labels[SERIES_COUNT] = { "Air moisture", "Water moisture", "Soil moisture", "Active cells" };
+    const Color colors[SERIES_COUNT] = { SKYBLUE, BLUE, BROWN, YELLOW };
+    const int graphHeight = 24;
+
+    DrawText("Telemetry:", x, y, 20, WHITE);
+    panel->drawCalls++;
+    y += 25;
+
+    const TelemetrySample* latest = GetLatestTelemetrySample(world);
+    for (int series = 0; series < SERIES_COUNT; series++) {
+        char label[50];
+        if (latest) {
+            snprintf(label, sizeof(label), "%s: %.0f", labels[series], TelemetryValue(latest, series));
+        } else {
+            snprintf(label, sizeof(label), "%s: N/A", labels[series]);
+        }
+        DrawText(label, x, y, 16, colors[series]);
+        DrawRectangleLines(x, y + 18, width, graphHeight, GRAY);
+        DrawSparkline(panel, world, x, y + 18, width, graphHeight, series, colors[series]);
+        panel->drawCalls += 2;
+        y += graphHeight + 26;
+    }
+
+    if (latest) {
+        char tempText[50];
+        snprintf(tempText, sizeof(tempText), "Mean Temp: %.1f", latest->meanTemperature);
+        DrawText(tempText, x, y, 16, WHITE);
+        panel->drawCalls++;
     }
-    
-    // Draw brush size indicator
-    char brushText[32];
-    snprintf(brushText, sizeof(brushText), "Brush: %d", brushRadius);
-    DrawText(brushText, startX, startY + buttonSize + 10, 20, WHITE);
-    
-    // Draw the brush size indicator in top-right corner
-    int margin = 20;
-    int indicatorRadius = brushRadius * 4; // Scale up for better visibility
-    int centerX = GetScreenWidth() - margin - indicatorRadius;
-    int centerY = margin + indicatorRadius;
-    
-    // Draw outer circle (border)
-    DrawCircleLines(centerX, centerY, indicatorRadius, WHITE);
-    
-    // Draw inner filled circle with semi-transparency
-    DrawCircle(centerX, centerY, indicatorRadius - 2, Fade(DARKGRAY, 0.7f));
-    
-    // Draw text showing the actual brush radius
-    char radiusText[10];
-    snprintf(radiusText, sizeof(radiusText), "R: %d", brushRadius);
-    DrawText(radiusText, centerX - 20, centerY - 10, 20, WHITE);
-    
-    // Draw current brush at mouse position
-
-    // Scale mouse position to account for DPI
-    Vector2 dpiScale = GetWindowScaleDPI();
-
-    // Refine the logic to correctly map mouse position to grid cells
-
-    // Calculate the cell under the mouse
-    int cellX = (int)((GetMousePosition().x + viewportContentOffsetX) / cellSize);
-    int cellY = (int)((GetMousePosition().y + viewportContentOffsetY) / cellSize);
-
-    // Ensure the cell coordinates are clamped within the grid bounds
-    cellX = (cellX < 0) ? 0 : (cellX >= GRID_WIDTH ? GRID_WIDTH - 1 : cellX);
-    cellY = (cellY < 0) ? 0 : (cellY >= GRID_HEIGHT ? GRID_HEIGHT - 1 : cellY);
-
-    // Correct scaling for mouse position to grid cell mapping
-    float cellSizeX = 1615.0f / 230.0f; // Calculate cell size based on given mouse and cell coordinates
-    float cellSizeY = 978.0f / 139.0f;
-
-    // Use the average cell size for consistent scaling
-    cellSize = (int)((cellSizeX + cellSizeY) / 2.0f);
-
-    // Update the adjusted mouse position for drawing
-    int adjustedMouseX = cellX * cellSize + cellSize / 2 + viewportX;
-    int adjustedMouseY = cellY * cellSize + cellSize / 2 + viewportY;
-
-    // Draw current brush at adjusted mouse position
-    DrawCircleLines(adjustedMouseX, adjustedMouseY, brushRadius * CELL_SIZE, WHITE);
-    
-    // Draw other UI elements
-    DrawFPS(10, 10);
-    
-    // Draw UI instructions
-    DrawText("Left Click: Place plant", 10, 30, 20, WHITE);
-    DrawText("Right Click: Place Soil", 10, 50, 20, WHITE);
-    DrawText("Middle Click: Place Water", 10, 70, 20, WHITE);
-    DrawText("Mouse Wheel: Adjust brush size", 10, 90, 20, WHITE);
-    
-
-    
-   
-    
-   
 }
 
-// Draw UI panel on the right side of the game area
-void DrawUIOnRight(int height, int width) {
-    // Dynamically calculate the UI panel width based on the intended fixed width of 300 pixels
-    int screenWidth = GetScreenWidth();
-    Vector2 dpiScale = GetWindowScaleDPI();
-    float dpiScaleFactor = dpiScale.x;
-    int uiWidth = 300 * dpiScaleFactor; // Scale the fixed width by the DPI factor
-
-    // Ensure the UI width does not exceed a reasonable percentage of the screen width
-    if (uiWidth > screenWidth * 0.3) {
-        uiWidth = screenWidth * 0.3; // Cap the UI width at 30% of the screen width
+// Material names and preview colors for the panel buttons and cell readout
+static const char* typeLabels[CELL_TYPE_MOSS + 1] = {
+    "Air", "Soil", "Water", "Plant", "Rock", "Moss"
+};
+static const Color typeColors[CELL_TYPE_MOSS + 1] = {
+    { 255, 255, 255, 255 },   // Air
+    { 127, 106, 79, 255 },    // Soil
+    { 0, 121, 241, 255 },     // Water
+    { 0, 228, 48, 255 },      // Plant
+    { 80, 80, 80, 255 },      // Rock
+    { 0, 117, 44, 255 },      // Moss
+};
+
+// Bring every widget's text up to date; only changed values are formatted again
+static void UpdatePanelWidgets(AppState* app, const World* world) {
+    UIPanel* panel = &app->panel;
+
+    SetWidgetText(panel, WIDGET_BRUSH, app->brushRadius, "Brush Size: %d", app->brushRadius);
+    SetWidgetText(panel, WIDGET_WATER_MODEL, world->waterModel,
+                  (world->waterModel == WATER_MODEL_PRESSURE) ? "P: Water model (Pressure)" : "P: Water model (Cellular)");
+    SetWidgetText(panel, WIDGET_LOD, app->reducedRateOffscreen,
+                  app->reducedRateOffscreen ? "L: Off-screen rate (1/%d)" : "L: Off-screen rate (full)",
+                  SIM_LOD_DEFAULT_INTERVAL);
+
+    // Region totals come from the summed-area tables, which only rebuild the
+    // tiles that changed, so they can follow every frame
+    RegionSummary all = QueryRegion(world, 0, 0, world->width, world->height);
+    SetWidgetText(panel, WIDGET_MOISTURE, all.moisture, "Total Moisture: %lld", all.moisture);
+
+    // Texture bandwidth of the last frame
+    SetWidgetText2(panel, WIDGET_UPLOAD, app->textures.uploadedBytes, app->textures.uploadedRects,
+                  "Upload: %d KB (%d rects)", app->textures.uploadedBytes / 1024, app->textures.uploadedRects);
+
+    // Current tick and the range the rewind buffer can seek to
+    int oldest = GetRewindOldestTick(&app->rewind);
+    int newest = GetRewindNewestTick(&app->rewind);
+    SetWidgetText2(panel, WIDGET_TICK, world->tick, ((long long)oldest << 32) | (unsigned int)newest,
+                  "Tick: %d (rewind %d-%d)", world->tick, oldest, newest);
+
+    Vector2 mousePos = GetMousePosition();
+    int mouseX = (int)mousePos.x;
+    int mouseY = (int)mousePos.y;
+    SetWidgetText(panel, WIDGET_MOUSE, ((long long)mouseX << 32) | (unsigned int)mouseY, "Mouse: (%d, %d)", mouseX, mouseY);
+
+    // Cell under the cursor, considering the camera
+    int cellX, cellY;
+    bool inView = world->cells != NULL && ScreenToCell(&app->view, mousePos, &cellX, &cellY) &&
+                  cellX > 0 && cellX < world->width && cellY > 0 && cellY < world->height;
+    if (inView) {
+        const GridCell* cell = GetCell(world, cellX, cellY);
+        long long index = (long long)cellY * world->width + cellX;
+        SetWidgetText(panel, WIDGET_CELL, index, "Cell: (%d, %d)", cellX, cellY);
+        SetWidgetText(panel, WIDGET_CELL_MOISTURE, (index << 32) | (unsigned int)cell->moisture, "Moisture: %d", cell->moisture);
+        SetWidgetText(panel, WIDGET_CELL_TYPE, (index << 8) | (cell->type + 1), "Type: %s",
+                      (cell->type >= 0 && cell->type <= CELL_TYPE_MOSS) ? typeLabels[cell->type] : "Border");
+
+        // The square the brush covers
+        int r = app->brushRadius;
+        RegionSummary area = QueryRegion(world, cellX - r, cellY - r, cellX + r + 1, cellY + r + 1);
+        int water = area.counts[CELL_TYPE_WATER];
+        SetWidgetText2(panel, WIDGET_BRUSH_AREA, area.moisture, ((long long)water << 32) | (unsigned int)area.cells,
+                      "Brush area: %lld moisture, %d water", area.moisture, water);
+    } else {
+        SetWidgetText(panel, WIDGET_CELL, -1, "Cell: N/A");
+        SetWidgetText(panel, WIDGET_CELL_MOISTURE, -1, "Moisture: N/A");
+        SetWidgetText(panel, WIDGET_CELL_TYPE, -1, "Type: N/A");
+        SetWidgetText(panel, WIDGET_BRUSH_AREA, -1, "Brush area: N/A");
     }
+}
 
-    // Get the starting X position for the UI panel (align to the top-right corner)
-    int uiStartX = screenWidth - (uiWidth*2); // Correctly position the UI panel based on its width
+// Draw text and count it
+static void PanelText(UIPanel* panel, const char* text, int x, int y, int fontSize) {
+    DrawText(text, x, y, fontSize, WHITE);
+    panel->drawCalls++;
+}
+
+// Draw the static part of the panel in panel-local coordinates (into the cached texture)
+static void DrawPanelContents(AppState* app) {
+    UIPanel* panel = &app->panel;
+    const PanelLayout* layout = &panel->layout;
+    int originX = (int)layout->panel.x;
+    int startX = layout->startX - originX;
 
     // Draw background for UI panel
-    DrawRectangle(uiStartX, 0, uiWidth, height, Fade(DARKGRAY, 0.8f));
-
-    // Draw title
-    DrawText("Sandbox Controls", uiStartX + 20, 20, 24, WHITE);
-
-    // Cell type selection UI
-    DrawText("Materials:", uiStartX + 20, 60, 20, WHITE);
-    
-    const int buttonSize = 64;
-    const int padding = 10;
-    const int startX = uiStartX + 20;
-    const int startY = 90;
-    
-    // Cell type labels for UI
-    const char* typeLabels[] = {
-        "Air", "Soil", "Water", "Plant", "Rock", "Moss"
-    };
-    
-    // Cell type colors for UI
-    Color typeColors[] = {
-        WHITE,                          // Air
-        (Color){127, 106, 79, 255},     // Soil
-        BLUE,                           // Water
-        GREEN,                          // Plant 
-        DARKGRAY,                       // Rock
-        DARKGREEN                       // Moss
-    };
-    
-    // Calculate buttons per row based on UI panel width
-    int buttonsPerRow = (uiWidth - 40) / (buttonSize + padding);
-    if (buttonsPerRow < 1) buttonsPerRow = 1;
-    
+    DrawRectangle(0, 0, layout->panel.width, layout->panel.height, Fade(DARKGRAY, 0.8f));
+    panel->drawCalls++;
+
+    PanelText(panel, "Sandbox Controls", startX, 20, 24);
+    PanelText(panel, "Materials:", startX, 60, 20);
+
     // Draw cell type buttons
     for (int i = 0; i <= CELL_TYPE_MOSS; i++) {
-        int row = i / buttonsPerRow;
-        int col = i % buttonsPerRow;
-        int posX = startX + col * (buttonSize + padding);
-        int posY = startY + row * (buttonSize + padding + 20);
-        
+        int posX = (int)layout->buttons[i].x - originX;
+        int posY = (int)layout->buttons[i].y;
+
         // Draw button background (highlight if selected)
-        DrawRectangle(posX, posY, buttonSize, buttonSize, 
-                     (i == currentSelectedType) ? LIGHTGRAY : DARKGRAY);
-        
+        DrawRectangle(posX, posY, PANEL_BUTTON_SIZE, PANEL_BUTTON_SIZE,
+                      (i == app->currentSelectedType) ? LIGHTGRAY : DARKGRAY);
+
         // Draw cell type color preview
-        DrawRectangle(posX + 5, posY + 5, buttonSize - 10, buttonSize - 25, typeColors[i]);
-        
-        // Draw type name
-        DrawText(typeLabels[i], posX + 5, posY + buttonSize - 18, 16, WHITE);
+        DrawRectangle(posX + 5, posY + 5, PANEL_BUTTON_SIZE - 10, PANEL_BUTTON_SIZE - 25, typeColors[i]);
+        panel->drawCalls += 2;
+
+        PanelText(panel, typeLabels[i], posX + 5, posY + PANEL_BUTTON_SIZE - 18, 16);
     }
-    
-    // Draw brush size controls
-    int controlsY = startY + ((CELL_TYPE_MOSS+1) / buttonsPerRow + 1) * (buttonSize + padding + 20);
-    
-    // Draw brush size text
-    char brushText[32];
-    snprintf(brushText, sizeof(brushText), "Brush Size: %d", brushRadius);
-    DrawText(brushText, startX, controlsY, 20, WHITE);
-    
-    // Draw brush preview
-    DrawCircleLines(startX + uiWidth/2, controlsY + 50, brushRadius * 3, WHITE);
-    
+
+    // Brush size and preview
+    PanelText(panel, panel->widgets[WIDGET_BRUSH].text, startX, layout->brushY, 20);
+    DrawCircleLines(startX + layout->contentWidth / 2, layout->brushY + 50, app->brushRadius * 3, WHITE);
+    panel->drawCalls++;
+
     // Draw simulation controls
-    int simControlsY = controlsY + 100;
-    DrawText("Simulation Controls:", startX, simControlsY, 20, WHITE);
-    
-    DrawText("Space: Start/Pause", startX, simControlsY + 30, 18, WHITE);
-    DrawText("Mouse Wheel: Adjust brush", startX, simControlsY + 55, 18, WHITE);
-     // Display cursor position and cell grid position in the info panel
-
-    // Draw moisture info
-    int moistureY = simControlsY + 90;
-    char moistureText[50];
-    snprintf(moistureText, sizeof(moistureText), "Total Moisture: %d", CalculateTotalMoisture());
-    DrawText(moistureText, startX, moistureY, 18, WHITE);
-
-    // Add current mouse position to the UI panel
-    char mousePosText[50];
-    snprintf(mousePosText, sizeof(mousePosText), "Mouse: (%.1f, %.1f)", GetMousePosition().x, GetMousePosition().y);
-    DrawText(mousePosText, startX, moistureY + 30, 18, WHITE);
-
-    // Initialize default values for the UI strings
-    static char cellMoistureText[50] = "Moisture: N/A";
-    static char cellTypeText[50] = "Type: N/A";
-
-    // Check if the cursor is over the play area
-
-    // Add the cell under cursor function back to the UI panel
-    static char cellUnderCursorText[50] = "Cell: N/A";
-
-    // Adjust the logic to ensure the entire viewport is recognized
-    if (grid != NULL) {
-        Vector2 mousePos = GetMousePosition();
-
-        // Calculate the cell under the mouse, considering viewport offsets
-        int cellX = (int)((mousePos.x - viewportX + viewportContentOffsetX) / cellSize);
-        int cellY = (int)((mousePos.y - viewportY + viewportContentOffsetY) / cellSize);
-
-        // Ensure the cell coordinates are clamped within the grid bounds
-        if (cellX > 0 && cellX < GRID_WIDTH && cellY > 0 && cellY < GRID_HEIGHT) {
-            snprintf(cellUnderCursorText, sizeof(cellUnderCursorText), "Cell: (%d, %d)", cellX, cellY);
-            snprintf(cellMoistureText, sizeof(cellMoistureText), "Moisture: %d", grid[cellY][cellX].moisture);
-            const char* cellTypeNames[] = {"Air", "Soil", "Water", "Plant", "Rock", "Moss"};
-            snprintf(cellTypeText, sizeof(cellTypeText), "Type: %s", cellTypeNames[grid[cellY][cellX].type]);
-        } else {
-            // Reset to default values if the cell is out of bounds
-            snprintf(cellUnderCursorText, sizeof(cellUnderCursorText), "Cell: N/A");
-            snprintf(cellMoistureText, sizeof(cellMoistureText), "Moisture: N/A");
-            snprintf(cellTypeText, sizeof(cellTypeText), "Type: N/A");
-        }
-    } else {
-        // Reset to default values if the grid is not initialized
-        snprintf(cellUnderCursorText, sizeof(cellUnderCursorText), "Cell: N/A");
-        snprintf(cellMoistureText, sizeof(cellMoistureText), "Moisture: N/A");
-        snprintf(cellTypeText, sizeof(cellTypeText), "Type: N/A");
+    int y = layout->simControlsY;
+    PanelText(panel, "Simulation Controls:", startX, y, 20);
+    PanelText(panel, "Space: Start/Pause", startX, y + 30, 18);
+    PanelText(panel, "Mouse Wheel: Adjust brush", startX, y + 55, 18);
+    PanelText(panel, panel->widgets[WIDGET_WATER_MODEL].text, startX, y + 80, 18);
+    PanelText(panel, "Ctrl+Wheel, +/-: Zoom  M: Minimap", startX, y + 105, 18);
+    PanelText(panel, "Ctrl+Z / Ctrl+Y: Undo / Redo", startX, y + 130, 18);
+    PanelText(panel, ", / .: Step ticks  Home/End: Rewind", startX, y + 155, 18);
+    PanelText(panel, panel->widgets[WIDGET_LOD].text, startX, y + 180, 18);
+}
+
+// Draw the live readouts straight to the screen, over the cached panel
+static void DrawPanelReadouts(UIPanel* panel) {
+    const PanelLayout* layout = &panel->layout;
+    int x = layout->startX;
+    int y = layout->infoY;
+    PanelText(panel, panel->widgets[WIDGET_MOISTURE].text, x, y, 18);
+    PanelText(panel, panel->widgets[WIDGET_MOUSE].text, x, y + 30, 18);
+    PanelText(panel, panel->widgets[WIDGET_CELL_MOISTURE].text, x, y + 70, 18);
+    PanelText(panel, panel->widgets[WIDGET_CELL_TYPE].text, x, y + 90, 18);
+    PanelText(panel, panel->widgets[WIDGET_CELL].text, x, y + 110, 18);
+    PanelText(panel, panel->widgets[WIDGET_BRUSH_AREA].text, x, y + 130, 18);
+    PanelText(panel, panel->widgets[WIDGET_UPLOAD].text, x, y + 150, 18);
+    PanelText(panel, panel->widgets[WIDGET_TICK].text, x, y + 170, 18);
+}
+
+// Make sure a cache texture has the given size; returns true when it was (re)created
+static bool EnsureCache(RenderTexture2D* cache, int width, int height) {
+    if (cache->id != 0 && cache->texture.width == width && cache->texture.height == height) return false;
+    if (cache->id != 0) UnloadRenderTexture(*cache);
+    *cache = LoadRenderTexture(width, height);
+    return true;
+}
+
+// Draw a cache texture at a screen rectangle; render textures are stored upside down
+static void DrawCache(const RenderTexture2D* cache, Rectangle bounds) {
+    DrawTexturePro(cache->texture, (Rectangle){ 0, 0, bounds.width, -bounds.height }, bounds,
+                   (Vector2){ 0, 0 }, 0.0f, WHITE);
+}
+
+// Draw the side panel. Its static part is kept in a texture that is only drawn
+// again when a control on it or the layout changed, and the telemetry graphs in
+// a second one that is redrawn when a sample is added. The readouts that change
+// with every tick or mouse move are drawn directly on top each frame.
+void DrawUIOnRight(AppState* app, const World* world) {
+    UIPanel* panel = &app->panel;
+    const PanelLayout* layout = &panel->layout;
+    panel->drawCalls = 0;
+    panel->textRebuilds = 0;
+
+    UpdatePanelWidgets(app, world);
+    if (panel->selectedType != app->currentSelectedType) {
+        panel->selectedType = app->currentSelectedType;
+        panel->dirty = true;
+    }
+
+    int width = (int)layout->panel.width;
+    int height = (int)layout->panel.height;
+    if (width <= 0 || height <= 0 || layout->contentWidth <= 0) return;
+    if (EnsureCache(&panel->cache, width, height)) panel->dirty = true;
+    if (EnsureCache(&panel->telemetryCache, layout->contentWidth, PANEL_TELEMETRY_HEIGHT)) panel->telemetryTotal = -1;
+
+    if (panel->dirty) {
+        BeginTextureMode(panel->cache);
+        ClearBackground(BLANK);
+        DrawPanelContents(app);
+        EndTextureMode();
+        panel->dirty = false;
+        panel->redraws++;
+    }
+    if (panel->telemetryTotal != GetTelemetryTotal(world)) {
+        BeginTextureMode(panel->telemetryCache);
+        ClearBackground(BLANK);
+        DrawTelemetryGraph(panel, world, 0, 0, layout->contentWidth);
+        EndTextureMode();
+        panel->telemetryTotal = GetTelemetryTotal(world);
+        panel->telemetryRedraws++;
     }
 
-    // Draw the cell under cursor text
-    DrawText(cellUnderCursorText, startX, moistureY + 110, 18, WHITE);
+    DrawCache(&panel->cache, layout->panel);
+    DrawCache(&panel->telemetryCache, (Rectangle){ layout->startX, layout->telemetryY,
+                                                   layout->contentWidth, PANEL_TELEMETRY_HEIGHT });
+    DrawPanelReadouts(panel);
 
-    // Draw the UI strings
-    DrawText(cellMoistureText, startX, moistureY + 70, 18, WHITE);
-    DrawText(cellTypeText, startX, moistureY + 90, 18, WHITE);
-    
     // Draw performance meter
-    DrawFPS(startX, height - 30);
+    DrawFPS(layout->startX, height - 30);
+    panel->drawCalls += 3;
+}
+
+void UnloadUIPanel(AppState* app) {
+    if (app->panel.cache.id != 0) {
+        UnloadRenderTexture(app->panel.cache);
+    }
+    if (app->panel.telemetryCache.id != 0) {
+        UnloadRenderTexture(app->panel.telemetryCache);
+    }
+    app->panel.cache = (RenderTexture2D){ 0 };
+    app->panel.telemetryCache = (RenderTexture2D){ 0 };
 }
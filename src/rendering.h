@@ -1,13 +1,24 @@
 #ifndef RENDERING_H
 #define RENDERING_H
 
+#include "app_state.h"
+#include "grid.h"
+
+#define MINIMAP_SIZE 192  // longest side of the minimap, in pixels
+
 // Function to draw the game grid
-void DrawGameGrid(void);
+void DrawGameGrid(AppState* app, World* world);
+
+// Release the textures holding the color pyramid
+void UnloadGridTextures(AppState* app);
+
+// Screen rectangle covered by the minimap
+Rectangle GetMinimapRect(const AppState* app, const World* world);
 
-// Function to draw the UI
-void DrawUI(void);
+// Function to draw the UI panel on the right side (retained, see ui_panel.h)
+void DrawUIOnRight(AppState* app, const World* world);
 
-// Function to draw the UI panel on the right side
-void DrawUIOnRight(int height, int width);
+// Release the panel's cached rendering
+void UnloadUIPanel(AppState* app);
 
 #endif // RENDERING_H
@@ -0,0 +1,419 @@
+#include "rewind.h"
+#include "simulation.h"
+#include "fluid.h"
+#include "organisms.h"
+#include "telemetry.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+// Elements compared at once while looking for changes; unchanged stretches of
+// the grid are skipped a block at a time
+#define REWIND_SCAN_BLOCK 32
+
+// World fields outside the grid and solvers that a keyframe restores
+typedef struct {
+    uint32_t rngState;
+    uint64_t randomKey;
+    int tick;
+    int waterModel;
+    SimParams params;
+    SimLOD lod;
+} RewindScalars;
+
+// Approximate size of one full keyframe of a world
+static size_t KeyframeBytes(const World* world) {
+    size_t cells = (size_t)world->width * world->height;
+    size_t bytes = GetGridBytes(world);
+    if (world->fluid) bytes += cells * 2 * sizeof(int);
+    if (world->organisms) bytes += world->organisms->capacity * sizeof(Organism);
+    return bytes;
+}
+
+bool InitRewind(RewindBuffer* rewind, const World* world, int interval, size_t budget) {
+    memset(rewind, 0, sizeof(RewindBuffer));
+    rewind->budget = budget;
+    rewind->keyframeBytes = KeyframeBytes(world);
+    rewind->latestTick = world->tick;
+    rewind->edited = true; // The first recorded tick needs a keyframe
+
+    // Seeks replay up to interval - 1 ticks, so large grids keep keyframes closer together
+    long long cells = (long long)world->width * world->height;
+    long long replayTicks = (cells > 0) ? REWIND_REPLAY_CELLS / cells : interval;
+    rewind->interval = (interval < 1) ? 1 : interval;
+    if (rewind->interval > replayTicks) rewind->interval = (replayTicks > 1) ? (int)replayTicks : 1;
+
+    if (rewind->keyframeBytes > budget) {
+        printf("Rewind disabled: a keyframe of this world takes %zu MB, over the %zu MB budget\n",
+               rewind->keyframeBytes >> 20, budget >> 20);
+        return true;
+    }
+    rewind->enabled = true;
+    return true;
+}
+
+static void FreeDelta(RewindDelta* delta) {
+    free(delta->data);
+    memset(delta, 0, sizeof(RewindDelta));
+}
+
+// Forget the oldest delta
+static void DropOldestDelta(RewindBuffer* rewind) {
+    rewind->deltaBytes -= rewind->deltas[0].capacity;
+    FreeDelta(&rewind->deltas[0]);
+    memmove(rewind->deltas, rewind->deltas + 1, (rewind->count - 1) * sizeof(RewindDelta));
+    rewind->count--;
+}
+
+// Forget the newest delta
+static void DropNewestDelta(RewindBuffer* rewind) {
+    rewind->count--;
+    rewind->deltaBytes -= rewind->deltas[rewind->count].capacity;
+    FreeDelta(&rewind->deltas[rewind->count]);
+}
+
+void CleanupRewind(RewindBuffer* rewind) {
+    while (rewind->count > 0) {
+        DropNewestDelta(rewind);
+    }
+    free(rewind->deltas);
+    if (rewind->headAllocated) CleanupWorld(&rewind->head);
+    memset(rewind, 0, sizeof(RewindBuffer));
+}
+
+//----------------------------------------------------------------------------------
+// Delta encoding
+//----------------------------------------------------------------------------------
+
+static bool DeltaWrite(RewindDelta* delta, const void* bytes, size_t size) {
+    if (delta->size + size > delta->capacity) {
+        size_t capacity = delta->capacity ? delta->capacity : 64 * 1024;
+        while (capacity < delta->size + size) capacity *= 2;
+        unsigned char* data = (unsigned char*)realloc(delta->data, capacity);
+        if (!data) return false;
+        delta->data = data;
+        delta->capacity = capacity;
+    }
+    memcpy(delta->data + delta->size, bytes, size);
+    delta->size += size;
+    return true;
+}
+
+// Append the runs of elements where 'older' differs from 'newer', with their
+// older contents, and bring 'older' up to date as it goes. A run of length 0
+// ends the list.
+static bool DiffArray(RewindDelta* delta, void* older, const void* newer, size_t count, size_t size) {
+    unsigned char* o = (unsigned char*)older;
+    const unsigned char* n = (const unsigned char*)newer;
+    size_t i = 0;
+
+    while (i < count) {
+        if (i + REWIND_SCAN_BLOCK <= count && memcmp(o + i * size, n + i * size, REWIND_SCAN_BLOCK * size) == 0) {
+            i += REWIND_SCAN_BLOCK;
+            continue;
+        }
+        if (memcmp(o + i * size, n + i * size, size) == 0) {
+            i++;
+            continue;
+        }
+
+        size_t start = i;
+        while (i < count && memcmp(o + i * size, n + i * size, size) != 0) {
+            i++;
+        }
+        int run[2] = { (int)start, (int)(i - start) };
+        if (!DeltaWrite(delta, run, sizeof(run)) || !DeltaWrite(delta, o + start * size, (i - start) * size)) {
+            return false;
+        }
+        memcpy(o + start * size, n + start * size, (i - start) * size);
+    }
+
+    int end[2] = { 0, 0 };
+    return DeltaWrite(delta, end, sizeof(end));
+}
+
+// Put back the older contents recorded by DiffArray ('array' may be NULL to skip
+// them); returns the read position after the list
+static const unsigned char* RestoreArray(const unsigned char* p, void* array, size_t size) {
+    for (;;) {
+        int run[2];
+        memcpy(run, p, sizeof(run));
+        p += sizeof(run);
+        if (run[1] == 0) return p;
+
+        if (array) memcpy((unsigned char*)array + (size_t)run[0] * size, p, (size_t)run[1] * size);
+        p += (size_t)run[1] * size;
+    }
+}
+
+// Resize an organism pool, keeping its first entries
+static bool ResizeOrganismPool(OrganismTable* table, int capacity) {
+    if (capacity == table->capacity) return true;
+    Organism* pool = (Organism*)realloc(table->pool, (capacity > 0 ? capacity : 1) * sizeof(Organism));
+    if (!pool) return false;
+    table->pool = pool;
+    return true;
+}
+
+// Record how to turn 'head' back into its current state and then make it a copy
+// of 'world'. On failure the head is left partly updated.
+static bool CaptureDelta(RewindDelta* delta, World* head, const World* world) {
+    RewindScalars scalars = { head->rngState, head->randomKey, head->tick, head->waterModel, head->params, head->lod };
+    if (!DeltaWrite(delta, &scalars, sizeof(scalars))) return false;
+    head->rngState = world->rngState;
+    head->randomKey = world->randomKey;
+    head->tick = world->tick;
+    head->waterModel = world->waterModel;
+    head->params = world->params;
+    head->lod = world->lod;
+
+    if (!DiffArray(delta, head->cells, world->cells, GetGridCellCount(world), sizeof(GridCell))) return false;
+
+    FluidState* hf = head->fluid;
+    const FluidState* wf = world->fluid;
+    unsigned char hasFluid = (hf && wf);
+    if (!DeltaWrite(delta, &hasFluid, 1)) return false;
+    if (hasFluid) {
+        int cells = wf->width * wf->height;
+        int chunks = wf->chunksX * wf->chunksY;
+        int fluidScalars[2] = { hf->awakeChunks, hf->tick };
+        if (!DeltaWrite(delta, fluidScalars, sizeof(fluidScalars)) ||
+            !DiffArray(delta, hf->delta, wf->delta, cells, sizeof(int)) ||
+            !DiffArray(delta, hf->snapshot, wf->snapshot, cells, sizeof(int)) ||
+            !DiffArray(delta, hf->chunkAwake, wf->chunkAwake, chunks, 1) ||
+            !DiffArray(delta, hf->chunkTouched, wf->chunkTouched, chunks, 1)) {
+            return false;
+        }
+        hf->awakeChunks = wf->awakeChunks;
+        hf->tick = wf->tick;
+    }
+
+    unsigned char hasTelemetry = (head->telemetry && world->telemetry);
+    if (!DeltaWrite(delta, &hasTelemetry, 1)) return false;
+    if (hasTelemetry && !DiffArray(delta, head->telemetry, world->telemetry, sizeof(TelemetryState) / sizeof(int), sizeof(int))) {
+        return false;
+    }
+
+    // The pool can grow or shrink between keyframes: common entries are diffed,
+    // entries only the older keyframe has are stored whole
+    OrganismTable* ho = head->organisms;
+    const OrganismTable* wo = world->organisms;
+    unsigned char hasOrganisms = (ho && wo);
+    if (!DeltaWrite(delta, &hasOrganisms, 1)) return false;
+    if (hasOrganisms) {
+        int common = (ho->capacity < wo->capacity) ? ho->capacity : wo->capacity;
+        int tail[2] = { common, ho->capacity - common };
+        if (!DeltaWrite(delta, ho, sizeof(OrganismTable)) ||
+            !DiffArray(delta, ho->pool, wo->pool, common, sizeof(Organism)) ||
+            !DeltaWrite(delta, tail, sizeof(tail)) ||
+            !DeltaWrite(delta, ho->pool + common, (size_t)tail[1] * sizeof(Organism)) ||
+            !ResizeOrganismPool(ho, wo->capacity)) {
+            return false;
+        }
+        Organism* pool = ho->pool;
+        *ho = *wo;
+        ho->pool = pool;
+        if (wo->capacity > common) {
+            memcpy(pool + common, wo->pool + common, (size_t)(wo->capacity - common) * sizeof(Organism));
+        }
+    }
+    return true;
+}
+
+// Turn a world holding the keyframe after 'delta' into the keyframe before it
+static bool RestoreDelta(const RewindDelta* delta, World* world) {
+    const unsigned char* p = delta->data;
+
+    RewindScalars scalars;
+    memcpy(&scalars, p, sizeof(scalars));
+    p += sizeof(scalars);
+    world->rngState = scalars.rngState;
+    world->randomKey = scalars.randomKey;
+    world->tick = scalars.tick;
+    world->waterModel = scalars.waterModel;
+    world->params = scalars.params;
+    world->lod = scalars.lod;
+
+    p = RestoreArray(p, world->cells, sizeof(GridCell));
+
+    FluidState* f = world->fluid;
+    if (*p++) {
+        int fluidScalars[2];
+        memcpy(fluidScalars, p, sizeof(fluidScalars));
+        p += sizeof(fluidScalars);
+        if (f) {
+            f->awakeChunks = fluidScalars[0];
+            f->tick = fluidScalars[1];
+        }
+        p = RestoreArray(p, f ? f->delta : NULL, sizeof(int));
+        p = RestoreArray(p, f ? f->snapshot : NULL, sizeof(int));
+        p = RestoreArray(p, f ? f->chunkAwake : NULL, 1);
+        p = RestoreArray(p, f ? f->chunkTouched : NULL, 1);
+    }
+
+    if (*p++) {
+        p = RestoreArray(p, world->telemetry, sizeof(int));
+    }
+
+    OrganismTable* o = world->organisms;
+    if (*p++ && o) {
+        OrganismTable older;
+        memcpy(&older, p, sizeof(older));
+        p += sizeof(older);
+        if (!ResizeOrganismPool(o, older.capacity)) return false;
+        p = RestoreArray(p, o->pool, sizeof(Organism));
+
+        int tail[2];
+        memcpy(tail, p, sizeof(tail));
+        p += sizeof(tail);
+        memcpy(o->pool + tail[0], p, (size_t)tail[1] * sizeof(Organism));
+
+        Organism* pool = o->pool;
+        *o = older;
+        o->pool = pool;
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------------
+// Keyframes
+//----------------------------------------------------------------------------------
+
+// Drop the oldest deltas until the keyframes fit the budget
+static void EvictOldest(RewindBuffer* rewind) {
+    while (rewind->count > 0 && rewind->keyframeBytes + rewind->deltaBytes > rewind->budget) {
+        DropOldestDelta(rewind);
+    }
+}
+
+// Make the world's current state the newest keyframe; the previous newest
+// becomes a delta against it
+static void CaptureKeyframe(RewindBuffer* rewind, const World* world) {
+    rewind->edited = false;
+
+    if (!rewind->headValid) {
+        bool copied = rewind->headAllocated ? CopyWorldState(&rewind->head, world) : CloneWorld(&rewind->head, world);
+        rewind->headAllocated = copied;
+        rewind->headValid = copied;
+        return;
+    }
+
+    if (rewind->count == rewind->deltaCapacity) {
+        int capacity = rewind->deltaCapacity ? rewind->deltaCapacity * 2 : 64;
+        RewindDelta* deltas = (RewindDelta*)realloc(rewind->deltas, capacity * sizeof(RewindDelta));
+        if (!deltas) {
+            printf("ERROR: Failed to grow rewind buffer to %d keyframes\n", capacity);
+            return;
+        }
+        rewind->deltas = deltas;
+        rewind->deltaCapacity = capacity;
+    }
+
+    RewindDelta delta = { rewind->head.tick, NULL, 0, 0 };
+    if (!CaptureDelta(&delta, &rewind->head, world)) {
+        // The head is half updated, so start over from a full copy
+        printf("ERROR: Failed to allocate memory for rewind keyframe\n");
+        FreeDelta(&delta);
+        while (rewind->count > 0) DropNewestDelta(rewind);
+        rewind->headValid = CopyWorldState(&rewind->head, world);
+        return;
+    }
+
+    // Give back the unused part of the buffer
+    unsigned char* data = (unsigned char*)realloc(delta.data, delta.size);
+    if (data) {
+        delta.data = data;
+        delta.capacity = delta.size;
+    }
+    rewind->deltas[rewind->count++] = delta;
+    rewind->deltaBytes += delta.capacity;
+    EvictOldest(rewind);
+}
+
+// Forget every keyframe after the given tick (at the tick too, when 'inclusive')
+static void DropKeyframesAfter(RewindBuffer* rewind, int tick, bool inclusive) {
+    while (rewind->headValid && (rewind->head.tick > tick || (rewind->head.tick == tick && inclusive))) {
+        if (rewind->count == 0) {
+            rewind->headValid = false;
+            break;
+        }
+        if (!RestoreDelta(&rewind->deltas[rewind->count - 1], &rewind->head)) {
+            rewind->headValid = false;
+            while (rewind->count > 0) DropNewestDelta(rewind);
+            break;
+        }
+        DropNewestDelta(rewind);
+    }
+}
+
+void RecordRewindTick(RewindBuffer* rewind, const World* world) {
+    if (!rewind->enabled) return;
+    if (world->tick > rewind->latestTick) rewind->latestTick = world->tick;
+
+    // Ticks that were already recorded (replayed after a seek) keep their keyframes
+    if (rewind->headValid && world->tick <= rewind->head.tick) return;
+
+    if (rewind->edited || world->tick % rewind->interval == 0) {
+        CaptureKeyframe(rewind, world);
+    }
+}
+
+void MarkRewindEdited(RewindBuffer* rewind, const World* world) {
+    if (!rewind->enabled) return;
+
+    // Later ticks no longer follow from this one, and a keyframe at this tick predates the edit
+    DropKeyframesAfter(rewind, world->tick, true);
+    rewind->latestTick = world->tick;
+    rewind->edited = true;
+}
+
+int GetRewindOldestTick(const RewindBuffer* rewind) {
+    if (rewind->count > 0) return rewind->deltas[0].tick;
+    return rewind->headValid ? rewind->head.tick : rewind->latestTick;
+}
+
+int GetRewindNewestTick(const RewindBuffer* rewind) {
+    return rewind->latestTick;
+}
+
+int GetRewindKeyframes(const RewindBuffer* rewind) {
+    return rewind->headValid ? rewind->count + 1 : 0;
+}
+
+size_t GetRewindBytes(const RewindBuffer* rewind) {
+    return (rewind->headAllocated ? rewind->keyframeBytes : 0) + rewind->deltaBytes;
+}
+
+bool SeekRewind(RewindBuffer* rewind, World* world, int tick) {
+    if (!rewind->enabled) return false;
+    if (world->tick > rewind->latestTick) rewind->latestTick = world->tick;
+
+    // Keep unrecorded edits reachable before leaving the current state
+    if (rewind->edited) {
+        CaptureKeyframe(rewind, world);
+    }
+    if (!rewind->headValid || tick < GetRewindOldestTick(rewind) || tick > rewind->latestTick) {
+        return false;
+    }
+
+    // Newest keyframe at or before the target: the head, or the oldest delta
+    // from 'index' on restores it
+    int index = rewind->count;
+    int keyframeTick = rewind->head.tick;
+    while (index > 0 && keyframeTick > tick) {
+        index--;
+        keyframeTick = rewind->deltas[index].tick;
+    }
+
+    // Continuing from the current state is cheaper when it lies between the keyframe and the target
+    if (world->tick < keyframeTick || world->tick > tick) {
+        if (!CopyWorldState(world, &rewind->head)) return false;
+        for (int i = rewind->count - 1; i >= index; i--) {
+            if (!RestoreDelta(&rewind->deltas[i], world)) return false;
+        }
+    }
+    while (world->tick < tick) {
+        UpdateGrid(world);
+    }
+    return true;
+}
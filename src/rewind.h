@@ -0,0 +1,72 @@
+#ifndef REWIND_H
+#define REWIND_H
+
+#include "grid.h"
+#include <stddef.h>
+#include <stdbool.h>
+
+// Time travel over recent simulation ticks. A keyframe of the world is kept
+// every 'interval' ticks. Only the newest is a full copy; each older one is a
+// reverse delta holding the runs of cells (and solver, telemetry and organism
+// state) that differ from the keyframe after it, so a keyframe costs about what
+// changed in 'interval' ticks. The deltas are bounded by a memory budget, the
+// oldest going first.
+//
+// The ticks in between are not stored: the simulation is deterministic, so a
+// seek rebuilds the nearest earlier keyframe and runs UpdateGrid up to the
+// target. The interval shrinks on large grids so that replay stays within
+// REWIND_REPLAY_CELLS cell updates. Edits made outside UpdateGrid (brush, undo)
+// break that replay, so they drop every later tick and the next recorded tick
+// starts with a fresh keyframe.
+#define REWIND_DEFAULT_INTERVAL 30
+#define REWIND_DEFAULT_BUDGET ((size_t)256 * 1024 * 1024)
+#define REWIND_REPLAY_CELLS (8 * 1024 * 1024)  // most cells a seek updates by replaying ticks
+
+// What turns one keyframe back into the keyframe before it
+typedef struct {
+    int tick;            // tick of the older keyframe
+    unsigned char* data; // changed runs with their older contents, in capture order
+    size_t size;
+    size_t capacity;
+} RewindDelta;
+
+typedef struct {
+    World head;          // newest keyframe, a full copy allocated on first use
+    bool headAllocated;
+    bool headValid;
+    RewindDelta* deltas; // older keyframes, oldest first, each relative to the next
+    int count;
+    int deltaCapacity;
+
+    bool enabled;        // false when not even one keyframe fits in the budget
+    int interval;        // ticks between keyframes
+    int latestTick;      // newest tick that can be reached by replay
+    bool edited;         // the world changed outside UpdateGrid since the last keyframe
+    size_t budget;
+    size_t keyframeBytes; // size of the full copy
+    size_t deltaBytes;    // memory held by the deltas
+} RewindBuffer;
+
+// Returns false when out of memory. A world whose keyframe alone exceeds the
+// budget gets a disabled buffer that retains nothing.
+bool InitRewind(RewindBuffer* rewind, const World* world, int interval, size_t budget);
+void CleanupRewind(RewindBuffer* rewind);
+
+// Call before every UpdateGrid; takes a keyframe when one is due
+void RecordRewindTick(RewindBuffer* rewind, const World* world);
+
+// Note an edit of the world at its current tick
+void MarkRewindEdited(RewindBuffer* rewind, const World* world);
+
+// Range of ticks a seek can reach
+int GetRewindOldestTick(const RewindBuffer* rewind);
+int GetRewindNewestTick(const RewindBuffer* rewind);
+
+// Keyframes retained and the memory they take
+int GetRewindKeyframes(const RewindBuffer* rewind);
+size_t GetRewindBytes(const RewindBuffer* rewind);
+
+// Bring the world to a retained tick. Returns false when the tick is out of range.
+bool SeekRewind(RewindBuffer* rewind, World* world, int tick);
+
+#endif // REWIND_H
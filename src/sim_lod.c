@@ -0,0 +1,36 @@
+#include "sim_lod.h"
+
+// Round down / up to a multiple of SIM_LOD_SNAP (v >= 0)
+static int SnapDown(int v) {
+    return v - v % SIM_LOD_SNAP;
+}
+
+static int SnapUp(int v) {
+    return SnapDown(v + SIM_LOD_SNAP - 1);
+}
+
+bool SetSimulationFocus(World* world, int x0, int y0, int x1, int y1, int margin, int interval) {
+    if (interval < 1) interval = 1;
+    if (interval > SIM_LOD_MAX_INTERVAL) interval = SIM_LOD_MAX_INTERVAL;
+
+    // Snapping keeps the focus (and so the rewind history) from changing with
+    // every small pan, and keeps its edges on tile boundaries
+    SimLOD lod = { 1, 0, 0, 0, 0 };
+    if (interval > 1) {
+        x0 -= margin;
+        y0 -= margin;
+        x1 += margin;
+        y1 += margin;
+        lod.interval = interval;
+        lod.x0 = SnapDown(x0 > 0 ? x0 : 0);
+        lod.y0 = SnapDown(y0 > 0 ? y0 : 0);
+        lod.x1 = SnapUp(x1 < world->width ? (x1 > 0 ? x1 : 0) : world->width);
+        lod.y1 = SnapUp(y1 < world->height ? (y1 > 0 ? y1 : 0) : world->height);
+    }
+
+    SimLOD* current = &world->lod;
+    bool changed = lod.interval != current->interval || lod.x0 != current->x0 || lod.y0 != current->y0 ||
+                   lod.x1 != current->x1 || lod.y1 != current->y1;
+    *current = lod;
+    return changed;
+}
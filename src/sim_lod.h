@@ -0,0 +1,44 @@
+#ifndef SIM_LOD_H
+#define SIM_LOD_H
+
+#include "grid.h"
+#include "dirty_tiles.h"
+
+// Simulation level of detail. Tiles (DIRTY_TILE_SIZE square) inside the focus,
+// normally the visible part of the world and a margin around it, update every
+// tick. The others update every 'interval' ticks, with phases staggered by tile
+// so each tick does an even share of their work. Random-tick processes draw
+// 'interval' times the samples there; movement (falling, flowing, rising) just
+// runs slower.
+//
+// Every exchange between two cells is made as a whole by the cell being updated,
+// whichever zone its neighbour is in, so moisture is conserved across zone
+// boundaries exactly as within a zone. The focus is part of what decides the
+// next tick: UpdateGrid with the same state and focus gives the same result.
+#define SIM_LOD_SNAP 64               // focus edges are rounded outward to multiples of this
+#define SIM_LOD_MARGIN 64             // cells around the view kept at the full rate
+#define SIM_LOD_DEFAULT_INTERVAL 4
+#define SIM_LOD_MAX_INTERVAL 8        // far water still moves within every fluid settle window
+
+// Update [x0, x1) x [y0, y1), grown by 'margin', every tick and the rest of the
+// world every 'interval' ticks (1 updates everything every tick). Returns true
+// when the level of detail changed.
+bool SetSimulationFocus(World* world, int x0, int y0, int x1, int y1, int margin, int interval);
+
+// Whether the tile containing (x, y) updates on the current tick
+static inline bool TileIsDue(const World* world, int x, int y) {
+    const SimLOD* lod = &world->lod;
+    if (lod->interval <= 1) return true;
+    if (x >= lod->x0 && x < lod->x1 && y >= lod->y0 && y < lod->y1) return true;
+    return ((unsigned)world->tick + (x >> DIRTY_TILE_SHIFT) + (y >> DIRTY_TILE_SHIFT)) % lod->interval == 0;
+}
+
+// Ticks the tile containing (x, y) stands for when it updates
+static inline int TileTickSpan(const World* world, int x, int y) {
+    const SimLOD* lod = &world->lod;
+    if (lod->interval <= 1) return 1;
+    if (x >= lod->x0 && x < lod->x1 && y >= lod->y0 && y < lod->y1) return 1;
+    return lod->interval;
+}
+
+#endif // SIM_LOD_H
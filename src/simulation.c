@@ -3,18 +3,25 @@
 #include "cell_types.h"
 #include "cell_actions.h"
 #include "update_water.h"
+#include "fluid.h"
+#include "telemetry.h"
+#include "organisms.h"
+#include "random_tick.h"
+#include "dirty_tiles.h"
+#include "chunk_summary.h"
+#include "sim_lod.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
 
+#define CLOUD_ROWS 10                // clouds form in rows 1 to CLOUD_ROWS - 1
+#define EVAPORATION_MIN_MOISTURE 30  // water at or below this never evaporates
+#define AIR_RISE_MOISTURE 30         // air at or below this does not rise
 
-<<<<<<< HEAD
-=======
-
-
-void AbsorbMoisture(int* sourceMoisture, int* targetMoisture) {
+void AbsorbMoisture(World* world, int* sourceMoisture, int* targetMoisture) {
     // Update moisture transfer logic to use integer-based calculations
-    int transferAmount = (*sourceMoisture > 4) ? 4 : *sourceMoisture; // Transfer up to 4 units of moisture
+    int cap = world->params.absorbCap;
+    int transferAmount = (*sourceMoisture > cap) ? cap : *sourceMoisture; // Transfer up to 'cap' units of moisture
 
     // Ensure we don't exceed 100 in the target
     int maxTransfer = 100 - (*targetMoisture);
@@ -31,9 +38,8 @@ void AbsorbMoisture(int* sourceMoisture, int* targetMoisture) {
 
 
 
->>>>>>> 830d381957084d1f958f8e1e434dff1cc3f303a7
 // Helper function to count neighboring water cells
-int CountWaterNeighbors(int x, int y) {
+int CountWaterNeighbors(World* world, int x, int y) {
     int count = 0;
     for (int dy = -1; dy <= 1; dy++) {
         for (int dx = -1; dx <= 1; dx++) {
@@ -41,7 +47,7 @@ int CountWaterNeighbors(int x, int y) {
 
             int nx = x + dx;
             int ny = y + dy;
-            if (!IsBorderTile(nx, ny) && grid[ny][nx].type == CELL_TYPE_WATER) {
+            if (!IsBorderTile(world, nx, ny) && GetCell(world, nx, ny)->type == CELL_TYPE_WATER) {
                 count++;
             }
         }
@@ -51,32 +57,53 @@ int CountWaterNeighbors(int x, int y) {
 
 
 // Main simulation update function
-void UpdateGrid(void) {
-    // Reset all falling states before processing movement
-    for (int y = 0; y < GRID_HEIGHT; y++) {
-        for (int x = 0; x < GRID_WIDTH; x++) {
-            grid[y][x].is_falling = false;
+void UpdateGrid(World* world) {
+    world->tick++;
+
+    // Telemetry is gathered during the falling-state sweep on sample ticks,
+    // so recording statistics never costs an extra pass over the grid
+    TelemetrySample sample;
+    bool sampling = BeginTelemetrySample(world, &sample);
+
+    // Reset the falling states of the tiles updating this tick. Other tiles are
+    // skipped unless the sample needs every cell.
+    for (int y = 0; y < world->height; y++) {
+        bool due = true;
+        for (int x = 0; x < world->width; x++) {
+            if ((x & (DIRTY_TILE_SIZE - 1)) == 0) {
+                due = TileIsDue(world, x, y);
+                if (!due && !sampling) {
+                    x = TileScanEnd(x, 1, world->width);
+                    continue;
+                }
+            }
+            GridCell* cell = GetCell(world, x, y);
+            if (due) cell->is_falling = false;
+            if (sampling) AccumulateTelemetry(&sample, cell, GetRowTemperature(world, y));
         }
     }
 
-    static int updateCount = 0;
-    updateCount++;
+    if (sampling) {
+        CommitTelemetrySample(world, &sample);
+    }
+    ResetActiveCells(world);
 
-    // Ensure all border cells are consistently initialized to DARKGRAY
-    for (int y = 0; y < GRID_HEIGHT; y++) {
-        for (int x = 0; x < GRID_WIDTH; x++) {
-            if (x == 0 || x == GRID_WIDTH - 1 || y == 0 || y == GRID_HEIGHT - 1) {
-                grid[y][x].type = CELL_TYPE_BORDER;
-                grid[y][x].baseColor = DARKGRAY; // Set all border cells to DARKGRAY
-            }
-        }
+    // Ensure all border cells stay border cells
+    for (int x = 0; x < world->width; x++) {
+        GetCell(world, x, 0)->type = CELL_TYPE_BORDER;
+        GetCell(world, x, world->height - 1)->type = CELL_TYPE_BORDER;
+    }
+    for (int y = 1; y < world->height - 1; y++) {
+        GetCell(world, 0, y)->type = CELL_TYPE_BORDER;
+        GetCell(world, world->width - 1, y)->type = CELL_TYPE_BORDER;
     }
 
     // Update all cell types in the right order
   //  UpdateSoil();         // Soil falls
-    UpdateWater();        // Water flows
-   // UpdateEvaporation();  // Water evaporates based on temperature
-    UpdateAir();          // Moist air rises, and clouds form in cool regions
+    UpdateWater(world);      // Water flows
+    UpdateAir(world);        // Moist air rises, and clouds form in cool regions
+    UpdateRandomTicks(world); // Slow processes (evaporation) on sampled cells
+    UpdateOrganisms(world);  // Plants and moss grow and age on their own schedule
 
     // Other update functions...
 }
@@ -88,156 +115,93 @@ void UpdateGrid(void) {
 //if it didn't fall, we check check if we can move down to the right or down to the left, if we can, we move there, and set the falling flag. skipping subsequent checks.
 
 
-void UpdateSoil(void) {
+void UpdateSoil(World* world) {
     // Randomly decide initial direction for this cycle
-    bool processRightToLeft = GetRandomValue(0, 1);
+    bool processRightToLeft = CellRandom(world, 0, 0, RANDOM_SOIL_SCAN, 0, 1);
 
     // Process soil from bottom to top, alternating left/right direction
-    for (int y = GRID_HEIGHT - 1; y >= 0; y--) {
+    for (int y = world->height - 1; y >= 0; y--) {
         // Alternate direction for each row
         processRightToLeft = !processRightToLeft;
 
         int startX, endX, stepX;
         if (processRightToLeft) {
             // Right to left
-            startX = GRID_WIDTH - 1;
+            startX = world->width - 1;
             endX = -1;
             stepX = -1;
         } else {
             // Left to right
             startX = 0;
-            endX = GRID_WIDTH;
+            endX = world->width;
             stepX = 1;
         }
 
         for (int x = startX; x != endX; x += stepX) {
-            if (grid[y][x].type == CELL_TYPE_SOIL) {
+            if (GetCell(world, x, y)->type == CELL_TYPE_SOIL) {
                 // Reset falling state before movement logic
-<<<<<<< HEAD
-              //  grid[y][x].is_falling = false;
-              //  bool hasMoved = false;
-                
-=======
-                grid[y][x].is_falling = false;
+                GetCell(world, x, y)->is_falling = false;
                 bool hasMoved = false;
 
->>>>>>> 830d381957084d1f958f8e1e434dff1cc3f303a7
                 // Track soil moisture
-                int* moisture = &grid[y][x].moisture;
-
-                // Update soil color based on moisture
-                float intensityPct = (float)*moisture / 100.0f;
-                grid[y][x].baseColor = (Color){
-                    127 - (intensityPct * 51),
-                    106 - (intensityPct * 43),
-                    79 - (intensityPct * 32),
-                    255
-                };
+                int* moisture = &GetCell(world, x, y)->moisture;
 
                 // Check if soil can fall straight down
-<<<<<<< HEAD
-                if(y < GRID_HEIGHT - 1) {
-                    if(grid[y+1][x].type == CELL_TYPE_AIR || grid[y+1][x].type == CELL_TYPE_WATER) {
-                        if (grid[y][x].type == CELL_TYPE_AIR) {
-                            //check if we are already full of moisture.
-                            if(*moisture < 100) {
-                                // Transfer moisture from soil to air
-                                int canabsorb = (100 - *moisture);
-                                int transferamount = grid[y+1][x].moisture - canabsorb;
-                                grid[y][x].moisture += transferamount;
-                                grid[y+1][x].moisture -= transferamount;
-                            }
-                        }
-                        MoveCell(x, y, x, y+1);
-                        grid[y+1][x].is_falling = true;
-                        
-=======
-                if (y < GRID_HEIGHT - 1) {
-                    if (grid[y + 1][x].type == CELL_TYPE_AIR || grid[y + 1][x].type == CELL_TYPE_WATER) {
+                if (y < world->height - 1) {
+                    if (GetCell(world, x, y + 1)->type == CELL_TYPE_AIR || GetCell(world, x, y + 1)->type == CELL_TYPE_WATER) {
                         // Transfer moisture if falling thru water
-                        if (*moisture < 100 && grid[y + 1][x].type == CELL_TYPE_WATER) {
-                            AbsorbMoisture(&grid[y + 1][x].moisture, moisture);
+                        if (*moisture < 100 && GetCell(world, x, y + 1)->type == CELL_TYPE_WATER) {
+                            AbsorbMoisture(world, &GetCell(world, x, y + 1)->moisture, moisture);
                         }
 
                         // Actually move the soil cell down
-                        MoveCell(x, y, x, y + 1);
-                        grid[y + 1][x].is_falling = true;
+                        MoveCell(world, x, y, x, y + 1);
+                        GetCell(world, x, y + 1)->is_falling = true;
                         hasMoved = true;
->>>>>>> 830d381957084d1f958f8e1e434dff1cc3f303a7
                         continue;  // Skip further checks, we've moved
                     }
                 }
 
                 // Check if soil can fall diagonally
-<<<<<<< HEAD
-                if(y < GRID_HEIGHT - 1) {
-                    bool canMoveLeft = (x > 0 && (grid[y+1][x-1].type == CELL_TYPE_AIR || 
-                                                 grid[y+1][x-1].type == CELL_TYPE_WATER));
-                    bool canMoveRight = (x < GRID_WIDTH-1 && (grid[y+1][x+1].type == CELL_TYPE_AIR || 
-                                                            grid[y+1][x+1].type == CELL_TYPE_WATER));
-                    
-=======
-                if (y < GRID_HEIGHT - 1 && !hasMoved) {
-                    bool canMoveLeft = (x > 0 && (grid[y + 1][x - 1].type == CELL_TYPE_AIR ||
-                                                  grid[y + 1][x - 1].type == CELL_TYPE_WATER));
-                    bool canMoveRight = (x < GRID_WIDTH - 1 && (grid[y + 1][x + 1].type == CELL_TYPE_AIR ||
-                                                                grid[y + 1][x + 1].type == CELL_TYPE_WATER));
-
->>>>>>> 830d381957084d1f958f8e1e434dff1cc3f303a7
+                if (y < world->height - 1 && !hasMoved) {
+                    bool canMoveLeft = (x > 0 && (GetCell(world, x - 1, y + 1)->type == CELL_TYPE_AIR ||
+                                                  GetCell(world, x - 1, y + 1)->type == CELL_TYPE_WATER));
+                    bool canMoveRight = (x < world->width - 1 && (GetCell(world, x + 1, y + 1)->type == CELL_TYPE_AIR ||
+                                                                GetCell(world, x + 1, y + 1)->type == CELL_TYPE_WATER));
+
                     // Choose direction based on scan direction or random if both possible
                     if (canMoveLeft && canMoveRight) {
                         int direction = processRightToLeft ? -1 : 1;
-<<<<<<< HEAD
-                        if(GetRandomValue(0, 100) < 50) direction *= -1;  // 50% chance to reverse
-                        
-                        if(direction == -1) {
-                          
-                            MoveCell(x, y, x+1, y+1);
-                        }
-                        grid[y][x].is_falling = true;
-                    } 
-                    else if(canMoveLeft) {
-                       
-                       
-                        MoveCell(x, y, x-1, y+1);
-                        grid[y][x].is_falling = true;
-                    }
-                    else if(canMoveRight) {
-                       
-                       
-                        MoveCell(x, y, x+1, y+1);
-=======
-                        if (GetRandomValue(0, 100) < 50) direction *= -1;  // 50% chance to reverse
+                        if (CellRandom(world, x, y, RANDOM_SOIL_DIAGONAL, 0, 100) < 50) direction *= -1;  // 50% chance to reverse
 
                         if (direction == -1) {
                             // Transfer moisture if falling thru water
-                            if (*moisture < 100 && grid[y + 1][x - 1].type == CELL_TYPE_WATER) {
-                                AbsorbMoisture(&grid[y + 1][x - 1].moisture, moisture);
+                            if (*moisture < 100 && GetCell(world, x - 1, y + 1)->type == CELL_TYPE_WATER) {
+                                AbsorbMoisture(world, &GetCell(world, x - 1, y + 1)->moisture, moisture);
                             }
-                            MoveCell(x, y, x - 1, y + 1);
+                            MoveCell(world, x, y, x - 1, y + 1);
                         } else {
                             // Transfer moisture if falling thru water
-                            if (*moisture < 100 && grid[y + 1][x + 1].type == CELL_TYPE_WATER) {
-                                AbsorbMoisture(&grid[y + 1][x + 1].moisture, moisture);
+                            if (*moisture < 100 && GetCell(world, x + 1, y + 1)->type == CELL_TYPE_WATER) {
+                                AbsorbMoisture(world, &GetCell(world, x + 1, y + 1)->moisture, moisture);
                             }
-                            MoveCell(x, y, x + 1, y + 1);
+                            MoveCell(world, x, y, x + 1, y + 1);
                         }
-                        grid[y][x].is_falling = true;
+                        GetCell(world, x, y)->is_falling = true;
                     } else if (canMoveLeft) {
                         // Transfer moisture if falling thru water
-                        if (*moisture < 100 && grid[y + 1][x - 1].type == CELL_TYPE_WATER) {
-                            AbsorbMoisture(&grid[y + 1][x - 1].moisture, moisture);
+                        if (*moisture < 100 && GetCell(world, x - 1, y + 1)->type == CELL_TYPE_WATER) {
+                            AbsorbMoisture(world, &GetCell(world, x - 1, y + 1)->moisture, moisture);
                         }
-                        MoveCell(x, y, x - 1, y + 1);
-                        grid[y][x].is_falling = true;
+                        MoveCell(world, x, y, x - 1, y + 1);
+                        GetCell(world, x, y)->is_falling = true;
                     } else if (canMoveRight) {
                         // Transfer moisture if falling thru water
-                        if (*moisture < 100 && grid[y + 1][x + 1].type == CELL_TYPE_WATER) {
-                            AbsorbMoisture(&grid[y + 1][x + 1].moisture, moisture);
+                        if (*moisture < 100 && GetCell(world, x + 1, y + 1)->type == CELL_TYPE_WATER) {
+                            AbsorbMoisture(world, &GetCell(world, x + 1, y + 1)->moisture, moisture);
                         }
-                        MoveCell(x, y, x + 1, y + 1);
->>>>>>> 830d381957084d1f958f8e1e434dff1cc3f303a7
-                        grid[y][x].is_falling = true;
+                        MoveCell(world, x, y, x + 1, y + 1);
+                        GetCell(world, x, y)->is_falling = true;
                     }
                 }
             }
@@ -245,326 +209,105 @@ void UpdateSoil(void) {
     }
 }
 
-<<<<<<< HEAD
-// Update water physics
-void UpdateWater(void) {
-    bool processRightToLeft = GetRandomValue(0, 1);
-    
-    // Process water from bottom to top for falling mechanics
-    for(int y = GRID_HEIGHT - 1; y >= 0; y--) {
-        // Alternate direction for each row
-        processRightToLeft = !processRightToLeft;
-        
-        int startX, endX, stepX;
-        if(processRightToLeft) {
-            startX = GRID_WIDTH - 1;
-            endX = -1;
-            stepX = -1;
-        } else {
-            startX = 0;
-            endX = GRID_WIDTH;
-            stepX = 1;
-        }
-        
-        for(int x = startX; x != endX; x += stepX) {
-            if(grid[y][x].type == CELL_TYPE_WATER) {
-                bool hasMoved = false;
-                grid[y][x].is_falling = false;
-                
-                bool isAtBottomEdge = (y == GRID_HEIGHT - 1);
-                
-                // Check for moisture absorption
-                if(grid[y][x].moisture < 1000) {
-                    if(!isAtBottomEdge && grid[y+1][x].type == CELL_TYPE_AIR) {
-                        int canabsorb =  (100 - grid[y][x].moisture);
-                        int leftover = grid[y+1][x].moisture - canabsorb;
-                        grid[y][x].moisture += leftover;
-                        grid[y+1][x].moisture -= leftover;
-                        MoveCell(x, y, x, y+1);
-                    }
-                }
-                
-                // Count neighboring water cells for cohesion
-                int waterNeighbors = 0;
-                
-                // Check horizontal neighbors
-                for(int i = x-1; i >= 0 && i >= x-3; i--) {
-                    if(grid[y][i].type == CELL_TYPE_WATER) {
-                        waterNeighbors++;
-                    } else {
-                        break;
-                    }
-                }
-                
-                for(int i = x+1; i < GRID_WIDTH && i <= x+3; i++) {
-                    if(grid[y][i].type == CELL_TYPE_WATER) {
-                        waterNeighbors++;
-                    } else {
-                        break;
-                    }
-                }
-                
-                // Check vertical neighbors
-                if(y > 0 && grid[y-1][x].type == CELL_TYPE_WATER) {
-                    waterNeighbors += 2;
-                }
-                
-                if(y < GRID_HEIGHT-1 && grid[y+1][x].type == CELL_TYPE_WATER) {
-                    waterNeighbors += 2;
-                }
-                
-                // Check if water has many neighbors (high cohesion)
-                bool hasHighCohesion = (waterNeighbors >= 3);
-                
-                // Check if water can fall
-                bool canFallDown = (!isAtBottomEdge && grid[y+1][x].type == CELL_TYPE_AIR);
-                bool canFallDiagonalLeft = (!isAtBottomEdge && x > 0 && grid[y+1][x-1].type == CELL_TYPE_AIR);
-                bool canFallDiagonalRight = (!isAtBottomEdge && x < GRID_WIDTH-1 && grid[y+1][x+1].type == CELL_TYPE_AIR);
-                bool canFallAnyDirection = canFallDown || canFallDiagonalLeft || canFallDiagonalRight;
-                
-                // If water can fall, apply cohesion rules for falling
-                if(canFallAnyDirection) {
-                    if(canFallDown) {
-                        // All water can fall straight down
-                        MoveCell(x, y, x, y+1);
-                        hasMoved = true;
-                    } 
-                    // Only water with low cohesion can fall diagonally
-                    else if(!hasHighCohesion) {
-                        if(canFallDiagonalLeft && canFallDiagonalRight) {
-                            int direction = (GetRandomValue(0, 100) < 50) ? -1 : 1;
-                            MoveCell(x, y, x+direction, y+1);
-                            hasMoved = true;
-                        } else if(canFallDiagonalLeft) {
-                            MoveCell(x, y, x-1, y+1);
-                            hasMoved = true;
-                        } else if(canFallDiagonalRight) {
-                            MoveCell(x, y, x+1, y+1);
-                            hasMoved = true;
-                        }
-                    }
-                }
-                // If water cannot fall, it tries to spread horizontally
-                else {
-                    bool canFlowLeft = (x > 0 && grid[y][x-1].type == CELL_TYPE_AIR);
-                    bool canFlowRight = (x < GRID_WIDTH-1 && grid[y][x+1].type == CELL_TYPE_AIR);
-                    
-                    // Horizontal spread is influenced by cohesion but still possible
-                    // More cohesion = lower chance to spread
-                    int spreadChance = hasHighCohesion ? 30 : 70;
-                    
-                    if(GetRandomValue(0, 100) < spreadChance) {
-                        if(canFlowLeft && canFlowRight) {
-                            int leftBias = processRightToLeft ? 60 : 40;
-                            int flowDir = (GetRandomValue(0, 100) < leftBias) ? -1 : 1;
-                            MoveCell(x, y, x+flowDir, y);
-                            hasMoved = true;
-                        } else if(canFlowLeft) {
-                            MoveCell(x, y, x-1, y);
-                            hasMoved = true;
-                        } else if(canFlowRight) {
-                            MoveCell(x, y, x+1, y);
-                            hasMoved = true;
-                        }
-                    }
-                }
-                
-                // Update falling state based on movement
-                grid[y][x].is_falling = hasMoved && canFallAnyDirection;
-            }
-        }
-    }
+
+// Whether any air cell in the cloud rows can condense this tick. Merging and
+// drifting never raise the highest moisture among the air cells of the rows
+// the cloud pass reads, so the bound taken before the pass holds for all of
+// it. Condensation is decided per cell after merging, which can carry
+// moisture along a whole row, so the bound covers the rows' full width.
+static bool CloudsMayCondense(World* world) {
+    RefreshChunkSummaries(world);
+    MaterialSummary air = SummarizeMaterial(world, CELL_TYPE_AIR, 0, 0, world->width, CLOUD_ROWS + 1);
+    if (air.count == 0) return false;
+    if (air.maxMoisture > 100) return true;
+
+    // The lowest saturation limit any of these cells can have
+    float temperature = (world->params.saturationPerDegree >= 0.0f) ? air.minTemperature : air.maxTemperature;
+    float saturationLimit = world->params.saturationBase + (temperature * world->params.saturationPerDegree);
+    int precipitationAmount = air.maxMoisture - saturationLimit;
+    return precipitationAmount > 20;
 }
 
 // Update air physics - makes moist air rise
-void UpdateAir(void) {
-    // Use alternating row processing like in soil and water
-    bool processRightToLeft = GetRandomValue(0, 1);
-    
-    for(int y = 1; y < GRID_HEIGHT - 1; y++) {
-        // Alternate direction for each row
-        processRightToLeft = !processRightToLeft;
-        
-        // Set iteration direction based on processRightToLeft
-        int startX, endX, stepX;
-        if(processRightToLeft) {
-            startX = GRID_WIDTH - 2;  // Skip border
-            endX = 0;
-            stepX = -1;
-        } else {
-            startX = 1;  // Skip border
-            endX = GRID_WIDTH - 1;
-            stepX = 1;
-        }
-        
-        for(int x = startX; x != endX; x += stepX) {
-            if(grid[y][x].type != CELL_TYPE_AIR || grid[y][x].type == CELL_TYPE_BORDER) {
+void UpdateAir(World* world) {
+    // First pass: move moist air upward. A cell's row is only written after the
+    // cell was visited, so tiles without moist air at the start can be stepped over.
+    RefreshChunkSummaries(world);
+    for (int y = 1; y < world->height - 1; y++) {
+        for (int x = 1; x < world->width - 1; x++) {
+            if ((x == 1 || (x & (DIRTY_TILE_SIZE - 1)) == 0) &&
+                (!TileIsDue(world, x, y) || TileLacks(world, x, y, CELL_TYPE_AIR, AIR_RISE_MOISTURE + 1))) {
+                x = TileScanEnd(x, 1, world->width - 1);
                 continue;
             }
-            
-            // get distance to next solid or border cell above
-            int distanceToSolid = 0;
-            for(int i = y-1; i >= 0; i--) {
-                if(grid[i][x].type == CELL_TYPE_BORDER || grid[i][x].type == CELL_TYPE_ROCK) {
-                    break;
-                }
-                distanceToSolid++;
-            }
-
-            // if we are 3-9 cells away from a solid cell and we have 100 moisture we can form a droplet
-            if(distanceToSolid > 3 && distanceToSolid < 9 && grid[y][x].moisture >= 100) {
-                grid[y][x].type = CELL_TYPE_WATER;
-                grid[y][x].baseColor = BLUE; // Set color to blue for water
-                
-                //gather moisture from any adjacent air cells
-                for(int dy = -1; dy <= 1; dy++) {
-                    for(int dx = -1; dx <= 1; dx++) {
-                        if((dx == 0 && dy == 0) || 
-                           y+dy < 0 || y+dy >= GRID_HEIGHT ||
-                           x+dx < 0 || x+dx >= GRID_WIDTH) {
-                            continue; // FIXED: Added continue statement
-                        }
-                            
-                        if(grid[y+dy][x+dx].type == CELL_TYPE_AIR && grid[y+dy][x+dx].moisture > 0) {
-                            int availableSpace = 1000 - grid[y][x].moisture;
-                            int takenAmount = grid[y+dy][x+dx].moisture;
-                            if(availableSpace > 0) {
-                                grid[y][x].moisture += takenAmount;
-                                grid[y+dy][x+dx].moisture -= takenAmount;
-                            }
-                        }
-                    }
-                }
-                
-                continue; // FIXED: Skip rest of processing since we're now water
-            } // FIXED: Properly closed the water formation if-block
-
-            // Rising behavior  
-            if(y > 0 && grid[y-1][x].type == CELL_TYPE_AIR) {
-                if(grid[y-1][x].moisture < grid[y][x].moisture) {
-                    MoveCell(x, y, x, y-1);
-                    continue;
-                }
-            } 
-           
-            // Horizontal movement - randomized direction
-            bool moveLeft = (GetRandomValue(0, 1) == 0);
-            if(moveLeft) {
-                if(x > 0 && grid[y][x-1].type == CELL_TYPE_AIR) {
-                    MoveCell(x, y, x-1, y);
-                    continue; // Skip further processing
-                }
-            } else {
-                if(x < GRID_WIDTH-1 && grid[y][x+1].type == CELL_TYPE_AIR) {
-                    MoveCell(x, y, x+1, y);
-                    continue; // Skip further processing
-=======
-
-// Update air physics - makes moist air rise
-void UpdateAir(void) {
-    // First pass: move moist air upward
-    for (int y = 1; y < GRID_HEIGHT - 1; y++) {
-        for (int x = 1; x < GRID_WIDTH - 1; x++) {
-            if (grid[y][x].type == CELL_TYPE_AIR) {
+            if (GetCell(world, x, y)->type == CELL_TYPE_AIR) {
                 // Higher moisture content makes air rise
-                if (grid[y][x].moisture > 30) {
-                    if (y > 0 && grid[y - 1][x].type == CELL_TYPE_AIR) {
-                        if (grid[y - 1][x].moisture < grid[y][x].moisture - 10) {
-                            MoveCell(x, y, x, y - 1);
+                if (GetCell(world, x, y)->moisture > AIR_RISE_MOISTURE) {
+                    if (y > 0 && GetCell(world, x, y - 1)->type == CELL_TYPE_AIR) {
+                        if (GetCell(world, x, y - 1)->moisture < GetCell(world, x, y)->moisture - 10) {
+                            MoveCell(world, x, y, x, y - 1);
                         }
                     }
                 }
-
-                // Update air color based on moisture
-                UpdateAirColor(x, y);
             }
         }
     }
 
-    // Ensure water droplets are formed only by redistributing existing moisture
-    for (int y = 0; y < 10; y++) {  // Top 10 rows for cloud formation
-        for (int x = 1; x < GRID_WIDTH - 1; x++) {
-            if (grid[y][x].type == CELL_TYPE_AIR) {
-                // Calculate air saturation based on temperature
-                float saturationLimit = 60.0f + (grid[y][x].temperature * 2.0f);
-
-                // Try to merge moisture with neighboring air cells
-                MergeAirMoisture(x, y);
-
-                // Ensure air can only hold up to 100 units of moisture
-                if (grid[y][x].moisture > 100) {
-                    grid[y][x].moisture = 100;
-                }
+    // Second pass: clouds form near the top; moisture is only redistributed, never created or lost
+    bool mayCondense = CloudsMayCondense(world);
+    for (int y = 1; y < CLOUD_ROWS && y < world->height - 1; y++) {
+        for (int x = 1; x < world->width - 1; x++) {
+            if ((x == 1 || (x & (DIRTY_TILE_SIZE - 1)) == 0) && !TileIsDue(world, x, y)) {
+                x = TileScanEnd(x, 1, world->width - 1);
+                continue;
+            }
+            if (GetCell(world, x, y)->type != CELL_TYPE_AIR) {
+                continue;
+            }
 
-                // Check if air is supersaturated - convert to water droplet
-                if (grid[y][x].moisture > saturationLimit) {
-                    int precipitationAmount = grid[y][x].moisture - saturationLimit;
-
-                    // Only precipitate if significant moisture is available
-                    if (precipitationAmount > 20) {
-                        grid[y][x].type = CELL_TYPE_WATER;
-                        grid[y][x].moisture = precipitationAmount;
-                        grid[y][x].is_falling = true;
-
-                        // Adjust color for new water droplet
-                        float intensityPct = (float)grid[y][x].moisture / 100.0f;
-                        grid[y][x].baseColor = (Color){
-                            0 + (int)(200 * (1.0f - intensityPct)),
-                            120 + (int)(135 * (1.0f - intensityPct)),
-                            255,
-                            255
-                        };
-                    }
->>>>>>> 830d381957084d1f958f8e1e434dff1cc3f303a7
+            // Try to merge moisture with neighboring air cells
+            MergeAirMoisture(world, x, y);
+
+            // Supersaturated air (or air past its 100 unit capacity) condenses into
+            // a droplet that keeps all of its moisture. Saturation depends on temperature.
+            if (mayCondense) {
+                float saturationLimit = world->params.saturationBase +
+                                        (GetRowTemperature(world, y) * world->params.saturationPerDegree);
+                int precipitationAmount = GetCell(world, x, y)->moisture - saturationLimit;
+                if (precipitationAmount > 20 || GetCell(world, x, y)->moisture > 100) {
+                    GetCell(world, x, y)->type = CELL_TYPE_WATER;
+                    GetCell(world, x, y)->is_falling = true;
+                    WakeFluidAt(world, x, y);
+                    MarkCellDirty(world, x, y);
+                    continue;
                 }
             }
-            
+
             // Diagonal movement - randomize left/right choice
-            bool canMoveUpLeft = (y > 0 && x > 0 && 
-                                grid[y-1][x-1].type == CELL_TYPE_AIR &&
-                                grid[y-1][x-1].moisture < grid[y][x].moisture);
-                                
-            bool canMoveUpRight = (y > 0 && x < GRID_WIDTH-1 && 
-                                 grid[y-1][x+1].type == CELL_TYPE_AIR &&
-                                 grid[y-1][x+1].moisture < grid[y][x].moisture);
-            
-            if(canMoveUpLeft && canMoveUpRight) {
+            bool canMoveUpLeft = (GetCell(world, x - 1, y - 1)->type == CELL_TYPE_AIR &&
+                                  GetCell(world, x - 1, y - 1)->moisture < GetCell(world, x, y)->moisture);
+            bool canMoveUpRight = (GetCell(world, x + 1, y - 1)->type == CELL_TYPE_AIR &&
+                                   GetCell(world, x + 1, y - 1)->moisture < GetCell(world, x, y)->moisture);
+
+            if (canMoveUpLeft && canMoveUpRight) {
                 // Both diagonals available - choose randomly
-                if(GetRandomValue(0, 1) == 0) {
-                    MoveCell(x, y, x-1, y-1);
+                if (CellRandom(world, x, y, RANDOM_AIR_DIAGONAL, 0, 1) == 0) {
+                    MoveCell(world, x, y, x - 1, y - 1);
                 } else {
-                    MoveCell(x, y, x+1, y-1);
+                    MoveCell(world, x, y, x + 1, y - 1);
                 }
-            } else if(canMoveUpLeft) {
-                MoveCell(x, y, x-1, y-1);
-            } else if(canMoveUpRight) {
-                MoveCell(x, y, x+1, y-1);
+            } else if (canMoveUpLeft) {
+                MoveCell(world, x, y, x - 1, y - 1);
+            } else if (canMoveUpRight) {
+                MoveCell(world, x, y, x + 1, y - 1);
             }
-            
-            // Update air color
-            UpdateAirColor(x, y);
         }
     }
 }
 
-// Helper function to update air cell color based on moisture
-void UpdateAirColor(int x, int y) {
-    if (grid[y][x].type == CELL_TYPE_AIR) {
-        if (grid[y][x].moisture > 75) {
-            int brightness = (grid[y][x].moisture - 75) * (255 / 25);
-            grid[y][x].baseColor = (Color){brightness, brightness, brightness, 255};
-        } else {
-            grid[y][x].baseColor = BLACK;  // Invisible air
-        }
-    }
-}
-
-<<<<<<< HEAD
-
-=======
 // Helper function to merge moisture between air cells
-void MergeAirMoisture(int x, int y) {
-    if (grid[y][x].type != CELL_TYPE_AIR)
+void MergeAirMoisture(World* world, int x, int y) {
+    if (GetCell(world, x, y)->type != CELL_TYPE_AIR)
         return;
 
     // Look at neighboring air cells
@@ -572,79 +315,152 @@ void MergeAirMoisture(int x, int y) {
         for (int dx = -1; dx <= 1; dx++) {
             // Skip center and out of bounds
             if ((dx == 0 && dy == 0) ||
-                y + dy < 0 || y + dy >= GRID_HEIGHT ||
-                x + dx < 0 || x + dx >= GRID_WIDTH)
+                y + dy < 0 || y + dy >= world->height ||
+                x + dx < 0 || x + dx >= world->width)
                 continue;
 
             // If neighbor is air with more moisture, equalize
-            if (grid[y + dy][x + dx].type == CELL_TYPE_AIR) {
-                if (grid[y + dy][x + dx].moisture > grid[y][x].moisture + 5) {
-                    int transferAmount = (grid[y + dy][x + dx].moisture - grid[y][x].moisture) / 4;
-                    grid[y + dy][x + dx].moisture -= transferAmount;
-                    grid[y][x].moisture += transferAmount;
+            if (GetCell(world, x + dx, y + dy)->type == CELL_TYPE_AIR) {
+                if (GetCell(world, x + dx, y + dy)->moisture > GetCell(world, x, y)->moisture + 5) {
+                    int transferAmount = (GetCell(world, x + dx, y + dy)->moisture - GetCell(world, x, y)->moisture) / 4;
+                    GetCell(world, x + dx, y + dy)->moisture -= transferAmount;
+                    GetCell(world, x, y)->moisture += transferAmount;
+                    MarkCellDirty(world, x + dx, y + dy);
+                    MarkCellDirty(world, x, y);
                 }
             }
         }
     }
 }
->>>>>>> 830d381957084d1f958f8e1e434dff1cc3f303a7
-
-// Update evaporation considering temperature
-void UpdateEvaporation(void) {
-    for (int y = 0; y < GRID_HEIGHT; y++) {
-        for (int x = 0; x < GRID_WIDTH; x++) {
-            if (grid[y][x].type == CELL_TYPE_WATER && grid[y][x].moisture > 30) {
-                // Evaporation rate increases with temperature
-                float evapRate = 0.5f + (grid[y][x].temperature - 10.0f) * 0.05f;
-                if (evapRate < 0.1f) evapRate = 0.1f;
-
-                // Basic chance for evaporation
-                if (GetRandomValue(0, 100) < evapRate * 100) {
-                    // Look for air cells to transfer moisture to
-                    for (int dy = -1; dy <= 1; dy++) {
-                        for (int dx = -1; dx <= 1; dx++) {
-                            if ((dx == 0 && dy == 0) ||
-                                y + dy < 0 || y + dy >= GRID_HEIGHT ||
-                                x + dx < 0 || x + dx >= GRID_WIDTH)
-                                continue;
-
-                            if (grid[y + dy][x + dx].type == CELL_TYPE_AIR && grid[y + dy][x + dx].moisture < 95) {
-                                int evapAmount = 1 + GetRandomValue(0, 2);
-
-                                // Adjust based on temperature difference
-                                float tempDiff = grid[y + dy][x + dx].temperature - grid[y][x].temperature;
-                                if (tempDiff < 0) evapAmount = (int)(evapAmount * (1.0f + tempDiff * 0.1f));
-
-                                if (evapAmount < 1) evapAmount = 1;
-
-                                if (grid[y][x].moisture - evapAmount >= 20) {
-                                    grid[y][x].moisture -= evapAmount;
-                                    grid[y + dy][x + dx].moisture += evapAmount;
-                                    UpdateAirColor(x + dx, y + dy);
-                                }
-
-                                break;  // Only evaporate to one cell per update
-                            }
-                        }
-                    }
-                }
+
+// Deal 'events' evaporation events from the water cell at (x, y) out over every
+// air neighbour that can take moisture, so that a single neighbour does not cap
+// the amount. Events a full neighbour cannot take move on to the next one.
+// Returns the events that found no room; a cell with no air around it has
+// nothing to evaporate into and returns none.
+static int EvaporateEvents(World* world, int x, int y, int events) {
+    GridCell* water = GetCell(world, x, y);
+    int targetDx[8];
+    int targetDy[8];
+    int targets = 0;
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            if ((dx == 0 && dy == 0) ||
+                y + dy < 0 || y + dy >= world->height ||
+                x + dx < 0 || x + dx >= world->width)
+                continue;
+
+            const GridCell* air = GetCell(world, x + dx, y + dy);
+            if (air->type == CELL_TYPE_AIR && air->moisture < 95) {
+                targetDx[targets] = dx;
+                targetDy[targets] = dy;
+                targets++;
+            }
+        }
+    }
+
+    int baseAmount = 1 + CellRandom(world, x, y, RANDOM_EVAPORATE_AMOUNT, 0, 2);
+    bool evaporated = false;
+    for (int i = 0; i < targets && events > 0; i++) {
+        GridCell* air = GetCell(world, x + targetDx[i], y + targetDy[i]);
+        int evapAmount = baseAmount;
+
+        // Adjust based on temperature difference
+        float tempDiff = GetRowTemperature(world, y + targetDy[i]) - GetRowTemperature(world, y);
+        if (tempDiff < 0) evapAmount = (int)(evapAmount * (1.0f + tempDiff * 0.1f));
+        if (evapAmount < 1) evapAmount = 1;
+
+        // An even share of the events left for the neighbours left
+        int share = (events + (targets - i) - 1) / (targets - i);
+        int amount = evapAmount * share;
+
+        // Never leave less than 20 in the water or push the air past 100
+        if (amount > water->moisture - 20) amount = water->moisture - 20;
+        if (amount > 100 - air->moisture) amount = 100 - air->moisture;
+        if (amount <= 0) continue;
+
+        water->moisture -= amount;
+        air->moisture += amount;
+        MarkCellDirty(world, x + targetDx[i], y + targetDy[i]);
+        events -= (amount + evapAmount - 1) / evapAmount;
+        evaporated = true;
+    }
+
+    if (evaporated) {
+        MarkCellDirty(world, x, y);
+        WakeFluidAt(world, x, y);
+    }
+    return (targets > 0 && events > 0) ? events : 0;
+}
+
+// Evaporate part of one water cell into the neighbouring air.
+// 'scale' is the number of cells (and ticks) this call stands in for under
+// random-tick sampling, each of which would evaporate with the chance below.
+// The call deals out the expected number of those events, with the roll
+// deciding the rounding, rather than all or none of them. Events the cell
+// cannot give off, being nearly drained or short of dry air, go to the water
+// cells around it. Where all of those are capped too, sampling falls a little
+// short of visiting every cell (--verify --statistical measures by how much).
+// With a scale of 1 it is the per-cell process: one event into the first air
+// neighbour.
+void EvaporateCell(World* world, int x, int y, int scale) {
+    if (GetCell(world, x, y)->type != CELL_TYPE_WATER || GetCell(world, x, y)->moisture <= EVAPORATION_MIN_MOISTURE) return;
+
+    // Evaporation rate increases with temperature
+    float evapRate = 0.5f + (GetRowTemperature(world, y) - 10.0f) * 0.05f;
+    if (evapRate < 0.1f) evapRate = 0.1f;
+
+    // Basic chance for evaporation: a roll in [0, 100] below evapRate * 100
+    int chances = (int)ceilf(evapRate * 100);
+    if (chances > 101) chances = 101;
+    int roll = CellRandom(world, x, y, RANDOM_EVAPORATE, 0, 100);
+    int events = (scale * chances + 100 - roll) / 101;
+    if (events == 0) return;
+
+    events = EvaporateEvents(world, x, y, events);
+    for (int dy = -1; dy <= 1 && events > 0; dy++) {
+        for (int dx = -1; dx <= 1 && events > 0; dx++) {
+            if ((dx == 0 && dy == 0) || IsBorderTile(world, x + dx, y + dy)) continue;
+
+            const GridCell* neighbour = GetCell(world, x + dx, y + dy);
+            if (neighbour->type == CELL_TYPE_WATER && neighbour->moisture > EVAPORATION_MIN_MOISTURE) {
+                events = EvaporateEvents(world, x + dx, y + dy, events);
+            }
+        }
+    }
+}
+
+bool MayEvaporateIn(const World* world, int x0, int y0, int x1, int y1) {
+    MaterialSummary water = SummarizeMaterial(world, CELL_TYPE_WATER, x0, y0, x1, y1);
+    return water.count > 0 && water.maxMoisture > EVAPORATION_MIN_MOISTURE;
+}
+
+// Update evaporation considering temperature, visiting every cell
+// (UpdateRandomTicks applies the same process to sampled cells only).
+// Evaporating only lowers the moisture of water, so tiles rejected up front
+// stay unable to evaporate for the whole pass.
+void UpdateEvaporation(World* world) {
+    RefreshChunkSummaries(world);
+    for (int y = 0; y < world->height; y++) {
+        for (int x0 = 0; x0 < world->width; x0 += DIRTY_TILE_SIZE) {
+            int x1 = (x0 + DIRTY_TILE_SIZE < world->width) ? x0 + DIRTY_TILE_SIZE : world->width;
+            if (!MayEvaporateIn(world, x0, y, x1, y + 1)) continue;
+            for (int x = x0; x < x1; x++) {
+                EvaporateCell(world, x, y, 1);
             }
         }
     }
 }
 
 // Initialize temperature gradient across the grid
-void InitializeTemperature(void) {
+void InitializeTemperature(World* world) {
     const float baseTemp = 18.0f;     // Bottom temperature in Celsius
     const float topTemp = 5.0f;       // Top temperature in Celsius
     const float tempRange = baseTemp - topTemp;
 
-    for (int y = 0; y < GRID_HEIGHT; y++) {
+    for (int y = 0; y < world->height; y++) {
         // Calculate temperature based on y position (cooler at top)
-        float tempAtHeight = baseTemp - (tempRange * (float)y / GRID_HEIGHT);
-
-        for (int x = 0; x < GRID_WIDTH; x++) {
-            grid[y][x].temperature = tempAtHeight;
-        }
+        float tempAtHeight = baseTemp - (tempRange * (float)y / world->height);
+        world->rowTemperature[y] = (int)tempAtHeight;
     }
 }
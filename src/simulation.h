@@ -5,20 +5,23 @@
 #include <stdbool.h>
 
 // Main grid update function
-void UpdateGrid(void);
+void UpdateGrid(World* world);
 
 // Cell-type specific update functions
-void UpdateSoil(void);
-void UpdateWater(void);
-void UpdateAir(void);
-void UpdateEvaporation(void);
+void UpdateSoil(World* world);
+void UpdateWater(World* world);
+void UpdateAir(World* world);
+void UpdateEvaporation(World* world);
+void EvaporateCell(World* world, int x, int y, int scale);
+
+// False when no cell in [x0, x1) x [y0, y1) can evaporate (from the chunk summaries)
+bool MayEvaporateIn(const World* world, int x0, int y0, int x1, int y1);
 
 // Helper functions
-void UpdateAirColor(int x, int y);
-void MergeAirMoisture(int x, int y);
-int CountWaterNeighbors(int x, int y);
+void MergeAirMoisture(World* world, int x, int y);
+int CountWaterNeighbors(World* world, int x, int y);
 
 // Temperature functions
-void InitializeTemperature(void);
+void InitializeTemperature(World* world);
 
 #endif // SIMULATION_H
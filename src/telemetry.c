@@ -0,0 +1,140 @@
+#include "telemetry.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Allocate the telemetry ring for a world
+void InitTelemetry(World* world) {
+    CleanupTelemetry(world);
+
+    world->telemetry = (TelemetryState*)malloc(sizeof(TelemetryState));
+    if (!world->telemetry) {
+        printf("ERROR: Failed to allocate memory for telemetry\n");
+        return;
+    }
+    world->telemetry->interval = TELEMETRY_DEFAULT_INTERVAL;
+    ResetTelemetry(world);
+}
+
+void CleanupTelemetry(World* world) {
+    free(world->telemetry);
+    world->telemetry = NULL;
+}
+
+void CopyTelemetry(World* dst, const World* src) {
+    if (!dst->telemetry || !src->telemetry) return;
+    *dst->telemetry = *src->telemetry;
+}
+
+// Clear all recorded samples
+void ResetTelemetry(World* world) {
+    TelemetryState* t = world->telemetry;
+    if (!t) return;
+
+    t->head = 0;
+    t->count = 0;
+    t->total = 0;
+    t->activeCells = 0;
+}
+
+void SetTelemetryInterval(World* world, int ticks) {
+    if (!world->telemetry) return;
+    world->telemetry->interval = (ticks < 1) ? 1 : ticks;
+}
+
+// Start a sample if this tick is due; returns false when nothing should be collected
+bool BeginTelemetrySample(World* world, TelemetrySample* sample) {
+    if (!world->telemetry || world->tick % world->telemetry->interval != 0) return false;
+
+    memset(sample, 0, sizeof(*sample));
+    sample->tick = world->tick;
+    return true;
+}
+
+// Add one cell to the sample being collected
+void AccumulateTelemetry(TelemetrySample* sample, const GridCell* cell, int temperature) {
+    if (cell->type < 0) return; // Border cells are not part of the world
+
+    sample->cellCounts[cell->type]++;
+    sample->meanTemperature += temperature;
+
+    switch (cell->type) {
+        case CELL_TYPE_AIR:
+            sample->airMoisture += cell->moisture;
+            break;
+        case CELL_TYPE_WATER:
+            sample->waterMoisture += cell->moisture;
+            break;
+        case CELL_TYPE_SOIL:
+            sample->soilMoisture += cell->moisture;
+            break;
+    }
+}
+
+// Finish a sample and push it into the ring buffer
+void CommitTelemetrySample(World* world, TelemetrySample* sample) {
+    TelemetryState* t = world->telemetry;
+    int cellCount = (world->width - 2) * (world->height - 2);
+
+    if (cellCount > 0) {
+        sample->meanTemperature /= cellCount;
+    }
+    sample->activeCells = t->activeCells;
+
+    t->samples[t->head] = *sample;
+    t->head = (t->head + 1) % TELEMETRY_CAPACITY;
+    if (t->count < TELEMETRY_CAPACITY) t->count++;
+    t->total++;
+}
+
+void CountActiveCells(World* world, int cells) {
+    if (world->telemetry) world->telemetry->activeCells += cells;
+}
+
+void ResetActiveCells(World* world) {
+    if (world->telemetry) world->telemetry->activeCells = 0;
+}
+
+int GetTelemetryCount(const World* world) {
+    return world->telemetry ? world->telemetry->count : 0;
+}
+
+int GetTelemetryTotal(const World* world) {
+    return world->telemetry ? world->telemetry->total : 0;
+}
+
+const TelemetrySample* GetTelemetrySample(const World* world, int index) {
+    const TelemetryState* t = world->telemetry;
+    if (!t || index < 0 || index >= t->count) return NULL;
+
+    int oldest = (t->head - t->count + TELEMETRY_CAPACITY) % TELEMETRY_CAPACITY;
+    return &t->samples[(oldest + index) % TELEMETRY_CAPACITY];
+}
+
+const TelemetrySample* GetLatestTelemetrySample(const World* world) {
+    return GetTelemetrySample(world, GetTelemetryCount(world) - 1);
+}
+
+void WriteTelemetryCSVHeader(FILE* file) {
+    fprintf(file, "tick,air,soil,water,plant,rock,moss,air_moisture,water_moisture,soil_moisture,mean_temperature,active_cells\n");
+}
+
+void WriteTelemetryCSVRow(FILE* file, const TelemetrySample* sample) {
+    fprintf(file, "%d", sample->tick);
+    for (int i = 0; i <= CELL_TYPE_MOSS; i++) {
+        fprintf(file, ",%d", sample->cellCounts[i]);
+    }
+    fprintf(file, ",%d,%d,%d,%.3f,%d\n", sample->airMoisture, sample->waterMoisture,
+            sample->soilMoisture, sample->meanTemperature, sample->activeCells);
+}
+
+// Binary files start with a magic tag and the record size, followed by raw samples
+void WriteTelemetryBinaryHeader(FILE* file) {
+    const char magic[4] = { 'T', 'L', 'M', '1' };
+    int recordSize = (int)sizeof(TelemetrySample);
+    fwrite(magic, sizeof(magic), 1, file);
+    fwrite(&recordSize, sizeof(recordSize), 1, file);
+}
+
+void WriteTelemetryBinaryRow(FILE* file, const TelemetrySample* sample) {
+    fwrite(sample, sizeof(*sample), 1, file);
+}
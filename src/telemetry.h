@@ -0,0 +1,65 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "grid.h"
+#include <stdio.h>
+
+// Ring buffer size and default sampling period (in simulation ticks)
+#define TELEMETRY_CAPACITY 512
+#define TELEMETRY_DEFAULT_INTERVAL 10
+
+// One sample of world statistics
+typedef struct {
+    int tick;
+    int cellCounts[CELL_TYPE_MOSS + 1]; // cells per material, indexed by type
+    int airMoisture;                    // moisture held as vapour
+    int waterMoisture;                  // moisture held as liquid
+    int soilMoisture;                   // moisture held in soil
+    float meanTemperature;
+    int activeCells;                    // cells changed by the last tick
+} TelemetrySample;
+
+// Per-world telemetry state: a fixed-size ring of samples
+typedef struct TelemetryState {
+    TelemetrySample samples[TELEMETRY_CAPACITY];
+    int head;         // next slot to write
+    int count;        // samples currently retained
+    int total;        // samples recorded since reset
+    int interval;     // ticks between samples
+    int activeCells;  // cells changed during the current tick
+} TelemetryState;
+
+// Allocate and release a world's telemetry (called from InitWorld/CleanupWorld)
+void InitTelemetry(World* world);
+void CleanupTelemetry(World* world);
+
+// Copy the recorded samples of another world
+void CopyTelemetry(World* dst, const World* src);
+
+// Sampling control
+void ResetTelemetry(World* world);
+void SetTelemetryInterval(World* world, int ticks);
+
+// Sample collection, folded into the per-tick sweep in UpdateGrid
+bool BeginTelemetrySample(World* world, TelemetrySample* sample);
+void AccumulateTelemetry(TelemetrySample* sample, const GridCell* cell, int temperature);
+void CommitTelemetrySample(World* world, TelemetrySample* sample);
+
+// Count cells changed by a simulation pass (MoveCell, pressure flows).
+// The counter covers one tick and is cleared by ResetActiveCells.
+void CountActiveCells(World* world, int cells);
+void ResetActiveCells(World* world);
+
+// Ring buffer access, index 0 is the oldest retained sample
+int GetTelemetryCount(const World* world);
+int GetTelemetryTotal(const World* world);
+const TelemetrySample* GetTelemetrySample(const World* world, int index);
+const TelemetrySample* GetLatestTelemetrySample(const World* world);
+
+// Export helpers for headless runs
+void WriteTelemetryCSVHeader(FILE* file);
+void WriteTelemetryCSVRow(FILE* file, const TelemetrySample* sample);
+void WriteTelemetryBinaryHeader(FILE* file);
+void WriteTelemetryBinaryRow(FILE* file, const TelemetrySample* sample);
+
+#endif // TELEMETRY_H
@@ -0,0 +1,100 @@
+#include "ui_panel.h"
+#include <stdio.h>
+#include <stdarg.h>
+
+bool UpdatePanelLayout(UIPanel* panel, int screenWidth, int screenHeight, float dpiScale) {
+    PanelLayout* layout = &panel->layout;
+    if (layout->screenWidth == screenWidth && layout->screenHeight == screenHeight &&
+        layout->dpiScale == dpiScale) {
+        return false;
+    }
+
+    layout->screenWidth = screenWidth;
+    layout->screenHeight = screenHeight;
+    layout->dpiScale = dpiScale;
+
+    // Panel width scales with resolution and DPI
+    float uiScale = (screenWidth >= 3840 && screenHeight >= 2160) ? 1.5f : 1.0f;
+    int panelWidth = PANEL_BASE_WIDTH * uiScale * dpiScale;
+    if (panelWidth > screenWidth * PANEL_MAX_SCREEN_SHARE) {
+        panelWidth = screenWidth * PANEL_MAX_SCREEN_SHARE;
+    }
+
+    layout->panel = (Rectangle){ screenWidth - panelWidth, 0, panelWidth, screenHeight };
+    layout->viewport = (Rectangle){ 0, 0, screenWidth - panelWidth, screenHeight - VIEWPORT_BOTTOM_MARGIN };
+    layout->startX = layout->panel.x + 20;
+    layout->contentWidth = panelWidth - 40;
+
+    // Material buttons, as many per row as fit
+    const int buttonStartY = 90;
+    int buttonsPerRow = layout->contentWidth / (PANEL_BUTTON_SIZE + PANEL_BUTTON_PADDING);
+    if (buttonsPerRow < 1) buttonsPerRow = 1;
+
+    for (int i = 0; i <= CELL_TYPE_MOSS; i++) {
+        int row = i / buttonsPerRow;
+        int col = i % buttonsPerRow;
+        layout->buttons[i] = (Rectangle){
+            layout->startX + col * (PANEL_BUTTON_SIZE + PANEL_BUTTON_PADDING),
+            buttonStartY + row * (PANEL_BUTTON_SIZE + PANEL_BUTTON_PADDING + 20),
+            PANEL_BUTTON_SIZE,
+            PANEL_BUTTON_SIZE
+        };
+    }
+
+    int rows = (CELL_TYPE_MOSS + buttonsPerRow) / buttonsPerRow;
+    layout->brushY = buttonStartY + rows * (PANEL_BUTTON_SIZE + PANEL_BUTTON_PADDING + 20);
+    layout->simControlsY = layout->brushY + 100;
+    layout->infoY = layout->simControlsY + 215;
+    layout->telemetryY = layout->infoY + 205;
+
+    // Everything on the panel moved
+    panel->dirty = true;
+    panel->telemetryTotal = -1;
+    return true;
+}
+
+int PanelButtonAt(const PanelLayout* layout, Vector2 point) {
+    for (int i = 0; i <= CELL_TYPE_MOSS; i++) {
+        if (CheckCollisionPointRec(point, layout->buttons[i])) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Format a widget's text for new key values
+static void FormatWidget(UIPanel* panel, int widget, long long key, long long key2, const char* format, va_list args) {
+    TextWidget* w = &panel->widgets[widget];
+    vsnprintf(w->text, sizeof(w->text), format, args);
+    w->key = key;
+    w->key2 = key2;
+    w->valid = true;
+    panel->textRebuilds++;
+    if (widget < WIDGET_FIRST_LIVE) panel->dirty = true;
+}
+
+bool SetWidgetText(UIPanel* panel, int widget, long long key, const char* format, ...) {
+    TextWidget* w = &panel->widgets[widget];
+    if (w->valid && w->key == key && w->key2 == 0) return false;
+
+    va_list args;
+    va_start(args, format);
+    FormatWidget(panel, widget, key, 0, format, args);
+    va_end(args);
+    return true;
+}
+
+bool SetWidgetText2(UIPanel* panel, int widget, long long key, long long key2, const char* format, ...) {
+    TextWidget* w = &panel->widgets[widget];
+    if (w->valid && w->key == key && w->key2 == key2) return false;
+
+    va_list args;
+    va_start(args, format);
+    FormatWidget(panel, widget, key, key2, format, args);
+    va_end(args);
+    return true;
+}
+
+void InvalidateWidget(UIPanel* panel, int widget) {
+    panel->widgets[widget].valid = false;
+}
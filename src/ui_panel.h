@@ -0,0 +1,100 @@
+#ifndef UI_PANEL_H
+#define UI_PANEL_H
+
+#include "raylib.h"
+#include "cell_types.h"
+#include <stdbool.h>
+
+#define PANEL_BASE_WIDTH 300        // panel width before UI/DPI scaling
+#define PANEL_MAX_SCREEN_SHARE 0.3f // the panel never takes more than this share of the screen
+#define VIEWPORT_BOTTOM_MARGIN 80   // pixels kept free below the viewport
+#define PANEL_BUTTON_SIZE 64
+#define PANEL_BUTTON_PADDING 10
+
+// Window layout shared by drawing and hit-testing, recomputed only when the
+// screen size or DPI scale changes
+typedef struct {
+    int screenWidth;
+    int screenHeight;
+    float dpiScale;
+
+    Rectangle viewport;    // game area, left of the panel
+    Rectangle panel;       // side panel on the right
+    int startX;            // left edge of the panel contents
+    int contentWidth;
+    Rectangle buttons[CELL_TYPE_MOSS + 1];  // material buttons, indexed by cell type
+    int brushY;
+    int simControlsY;
+    int infoY;             // moisture and cursor readouts
+    int telemetryY;
+} PanelLayout;
+
+// A line of text bound to up to two values; the text is only formatted again
+// when one of them changes
+typedef struct {
+    char text[64];
+    long long key;
+    long long key2;
+    bool valid;
+} TextWidget;
+
+// Indices of the panel's text widgets
+enum {
+    // Drawn into the cached panel, they change on user input only
+    WIDGET_BRUSH,
+    WIDGET_WATER_MODEL,
+    WIDGET_LOD,
+
+    // Readouts that follow the simulation and the cursor, drawn directly every frame
+    WIDGET_MOISTURE,
+    WIDGET_UPLOAD,
+    WIDGET_MOUSE,
+    WIDGET_CELL,
+    WIDGET_CELL_TYPE,
+    WIDGET_CELL_MOISTURE,
+    WIDGET_BRUSH_AREA,
+    WIDGET_TICK,
+    WIDGET_COUNT
+};
+#define WIDGET_FIRST_LIVE WIDGET_MOISTURE
+
+#define PANEL_TELEMETRY_HEIGHT 250  // height of the telemetry graphs below the readouts
+
+// Retained side panel: the layout, the widget texts and cached renderings of
+// the static part of the panel and of the telemetry graphs. The panel is only
+// redrawn when a control on it changed, the graphs when a sample was added;
+// the live readouts are plain text drawn over them every frame.
+typedef struct {
+    PanelLayout layout;
+    TextWidget widgets[WIDGET_COUNT];
+    int selectedType;       // selection shown in the cached rendering
+    int telemetryTotal;     // telemetry samples shown in the cached graphs
+    bool dirty;             // the cached panel is out of date
+    RenderTexture2D cache;
+    RenderTexture2D telemetryCache;
+
+    // Counters for the last frame and in total
+    int drawCalls;          // draw calls issued for the panel in the last frame
+    int textRebuilds;       // widget texts formatted in the last frame
+    int redraws;            // times the cached panel was rebuilt
+    int telemetryRedraws;   // times the cached graphs were rebuilt
+} UIPanel;
+
+// Recompute the layout if the screen size or DPI scale changed; returns true when it did
+bool UpdatePanelLayout(UIPanel* panel, int screenWidth, int screenHeight, float dpiScale);
+
+// Material button under a screen position, or -1
+int PanelButtonAt(const PanelLayout* layout, Vector2 point);
+
+// Set a widget's text from 'key' and a format. Returns true only when the key
+// changed, so unchanged values cost a single comparison; a changed widget on the
+// cached panel marks it dirty.
+bool SetWidgetText(UIPanel* panel, int widget, long long key, const char* format, ...);
+
+// Same for a text bound to two values
+bool SetWidgetText2(UIPanel* panel, int widget, long long key, long long key2, const char* format, ...);
+
+// Force a widget's text to be rebuilt on the next update
+void InvalidateWidget(UIPanel* panel, int widget);
+
+#endif // UI_PANEL_H
@@ -1,6 +1,17 @@
 #ifndef UPDATE_WATER_H
 #define UPDATE_WATER_H
 
-void UpdateWater(void);
+#include "cell_rules.h"
 
-#endif // UPDATE_WATER_H
\ No newline at end of file
+// Water behaviour as an ordered neighbourhood rule table
+extern const CellRule waterRules[];
+extern const int waterRuleCount;
+
+// Water models selectable at runtime
+#define WATER_MODEL_CELLULAR 0  // rule-driven cell swaps
+#define WATER_MODEL_PRESSURE 1  // mass-based pressure equalization
+
+void UpdateWater(World* world);
+void SetWaterModel(World* world, int model);
+
+#endif // UPDATE_WATER_H
@@ -0,0 +1,652 @@
+#include "verify.h"
+#include "grid.h"
+#include "cell_types.h"
+#include "cell_actions.h"
+#include "simulation.h"
+#include "update_water.h"
+#include "fluid.h"
+#include "random_tick.h"
+#include "organisms.h"
+#include "reference_sim.h"
+#include "region_stats.h"
+#include "chunk_summary.h"
+#include "dirty_tiles.h"
+#include "sim_lod.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#define VERIFY_MAX_REPORTS 20   // mismatches printed before the rest are only counted
+#define VERIFY_CALLS_PER_TICK 64 // random MoveCell / MergeAirMoisture calls checked per tick
+#define VERIFY_REGIONS_PER_TICK 8 // random rectangles queried from the region tables per tick
+#define VERIFY_DIRTY_RECTS 256   // rectangle budget for the dirty tile check, and a small one forcing the fallback
+#define VERIFY_FEW_DIRTY_RECTS 2
+#define VERIFY_LOD_INTERVAL 3    // reduced rate of the level-of-detail copy
+#define VERIFY_EVAPORATION_EVERY 10      // ticks between evaporation rate measurements
+#define VERIFY_EVAPORATION_TOLERANCE 0.10 // random ticks run up to about 5% low (see EvaporateCell)
+
+typedef struct {
+    int checks;
+    int failures;
+    int reports;
+} VerifyResults;
+
+// A pass checked against its reference on a copy of the world
+typedef struct {
+    const char* name;
+    void (*optimized)(World* world);
+    void (*reference)(World* world);
+} VerifiedPass;
+
+static const VerifiedPass verifiedPasses[] = {
+    { "UpdateWater", UpdateWater, RefUpdateWater },
+    { "UpdateAir", UpdateAir, RefUpdateAir },
+};
+
+// End-of-run statistics compared between reference and optimized runs
+typedef struct {
+    double waterCells;
+    double waterDepth;    // mass-weighted mean row of the liquid, as a fraction of the height
+    double cloudMoisture; // moisture held by air in the cloud rows
+} EnsembleStats;
+
+// Build a random scene: soil and rock blobs, water bodies, plants and moss on the
+// ground, and moist air near the top
+static void BuildRandomScene(World* world) {
+    SetWaterModel(world, WorldRandom(world, 0, 1) ? WATER_MODEL_PRESSURE : WATER_MODEL_CELLULAR);
+
+    int blobs = WorldRandom(world, 4, 10);
+    for (int i = 0; i < blobs; i++) {
+        static const int types[] = { CELL_TYPE_SOIL, CELL_TYPE_ROCK, CELL_TYPE_WATER, CELL_TYPE_WATER };
+        int type = types[WorldRandom(world, 0, 3)];
+        int radius = WorldRandom(world, 2, world->height / 6 + 2);
+        PlaceCircularPattern(world, WorldRandom(world, 1, world->width - 2),
+                             WorldRandom(world, world->height / 4, world->height - 2), type, radius);
+    }
+
+    // Plants and moss on top of the ground, so the organism updates run too
+    int sprouts = WorldRandom(world, 6, 16);
+    for (int i = 0; i < sprouts; i++) {
+        int x = WorldRandom(world, 1, world->width - 2);
+        int y = 1;
+        while (y < world->height - 1 && GetCell(world, x, y)->type == CELL_TYPE_AIR) y++;
+        if (y < 2 || y >= world->height - 1) continue;
+        bool onSoil = (GetCell(world, x, y)->type == CELL_TYPE_SOIL);
+        PlaceCell(world, x, y - 1, (onSoil && WorldRandom(world, 0, 1)) ? CELL_TYPE_MOSS : CELL_TYPE_PLANT);
+    }
+
+    for (int y = 1; y < world->height - 1; y++) {
+        for (int x = 1; x < world->width - 1; x++) {
+            GridCell* cell = GetCell(world, x, y);
+            if (cell->type == CELL_TYPE_AIR) {
+                cell->moisture = (y < 12) ? WorldRandom(world, 20, 100) : WorldRandom(world, 0, 60);
+            } else if (cell->type == CELL_TYPE_WATER && world->waterModel == WATER_MODEL_PRESSURE) {
+                cell->moisture = WorldRandom(world, WATER_MIN_MASS, WATER_MAX_MASS);
+            }
+        }
+    }
+}
+
+static void ReportFailure(VerifyResults* results, unsigned int seed, int tick, const char* what, const char* detail) {
+    results->failures++;
+    if (results->reports++ < VERIFY_MAX_REPORTS) {
+        printf("FAIL seed %u tick %d %s: %s\n", seed, tick, what, detail);
+    }
+}
+
+// Compare the fields the simulation reads or writes. Returns true when the worlds match.
+static bool CompareWorlds(const World* ref, const World* opt, char* detail, size_t size) {
+    for (int y = 0; y < ref->height; y++) {
+        for (int x = 0; x < ref->width; x++) {
+            const GridCell* a = GetCell(ref, x, y);
+            const GridCell* b = GetCell(opt, x, y);
+            if (a->type != b->type || a->moisture != b->moisture || a->volume != b->volume ||
+                a->is_falling != b->is_falling || a->objectID != b->objectID ||
+                a->variation != b->variation ||
+                a->Energy != b->Energy || a->birthTick != b->birthTick) {
+                snprintf(detail, size, "cell (%d,%d) reference type %d moisture %d falling %d, optimized type %d moisture %d falling %d",
+                         x, y, a->type, a->moisture, a->is_falling, b->type, b->moisture, b->is_falling);
+                return false;
+            }
+        }
+    }
+
+    // Same grid, but random numbers were drawn in a different order
+    if (ref->rngState != opt->rngState) {
+        snprintf(detail, size, "random stream diverged");
+        return false;
+    }
+    return true;
+}
+
+// Run one pass on two copies of the world and compare them
+static void CheckPass(const VerifiedPass* pass, const World* world, World* ref, World* opt,
+                      unsigned int seed, VerifyResults* results) {
+    char detail[256];
+    int before = CalculateTotalMoisture(world);
+
+    CopyWorldState(ref, world);
+    CopyWorldState(opt, world);
+
+    // The reference solves every chunk, so nothing may be asleep for an exact comparison
+    WakeAllFluid(opt);
+
+    pass->reference(ref);
+    pass->optimized(opt);
+    results->checks++;
+
+    if (!CompareWorlds(ref, opt, detail, sizeof(detail))) {
+        ReportFailure(results, seed, world->tick, pass->name, detail);
+    }
+    if (CalculateTotalMoisture(opt) != before) {
+        snprintf(detail, sizeof(detail), "total moisture %d -> %d", before, CalculateTotalMoisture(opt));
+        ReportFailure(results, seed, world->tick, pass->name, detail);
+    }
+}
+
+// Apply the same random MoveCell and MergeAirMoisture calls to two copies and compare them.
+// Coordinates include the border and one cell beyond it, which must be ignored.
+static void CheckCellCalls(World* world, World* ref, World* opt, unsigned int seed, VerifyResults* results) {
+    char detail[256];
+    int before = CalculateTotalMoisture(world);
+
+    CopyWorldState(ref, world);
+    CopyWorldState(opt, world);
+
+    for (int i = 0; i < VERIFY_CALLS_PER_TICK; i++) {
+        int x = WorldRandom(world, 1, world->width - 2);
+        int y = WorldRandom(world, 1, world->height - 2);
+        if (WorldRandom(world, 0, 1)) {
+            RefMergeAirMoisture(ref, x, y);
+            MergeAirMoisture(opt, x, y);
+        } else {
+            int x2 = x + WorldRandom(world, -1, 1);
+            int y2 = y + WorldRandom(world, -1, 1);
+            if (WorldRandom(world, 0, 15) == 0) {
+                x2 = WorldRandom(world, -1, world->width);
+            }
+            RefMoveCell(ref, x, y, x2, y2);
+            MoveCell(opt, x, y, x2, y2);
+        }
+    }
+    results->checks++;
+
+    if (!CompareWorlds(ref, opt, detail, sizeof(detail))) {
+        ReportFailure(results, seed, world->tick, "MoveCell/MergeAirMoisture", detail);
+    }
+    if (CalculateTotalMoisture(opt) != before) {
+        snprintf(detail, sizeof(detail), "total moisture %d -> %d", before, CalculateTotalMoisture(opt));
+        ReportFailure(results, seed, world->tick, "MoveCell/MergeAirMoisture", detail);
+    }
+}
+
+// Compare region queries, answered from tables refreshed for the changed tiles
+// only, with totals summed over the cells. Rectangles may reach past the grid.
+static void CheckRegionStats(World* world, unsigned int seed, VerifyResults* results) {
+    for (int i = 0; i <= VERIFY_REGIONS_PER_TICK; i++) {
+        int x0 = 0, y0 = 0, x1 = world->width, y1 = world->height;
+        if (i > 0) {
+            x0 = WorldRandom(world, -2, world->width);
+            y0 = WorldRandom(world, -2, world->height);
+            x1 = x0 + WorldRandom(world, 1, world->width);
+            y1 = y0 + WorldRandom(world, 1, world->height);
+        }
+        RegionSummary sum = QueryRegion(world, x0, y0, x1, y1);
+        results->checks++;
+
+        long long moisture = 0;
+        int counts[REGION_MATERIALS] = { 0 };
+        for (int y = (y0 > 0 ? y0 : 0); y < y1 && y < world->height; y++) {
+            for (int x = (x0 > 0 ? x0 : 0); x < x1 && x < world->width; x++) {
+                const GridCell* cell = GetCell(world, x, y);
+                moisture += cell->moisture;
+                if (cell->type >= 0 && cell->type < REGION_MATERIALS) counts[cell->type]++;
+            }
+        }
+
+        if (sum.moisture != moisture || memcmp(sum.counts, counts, sizeof(counts)) != 0) {
+            char detail[128];
+            snprintf(detail, sizeof(detail), "[%d,%d)x[%d,%d): moisture %lld, expected %lld, water %d, expected %d",
+                     x0, x1, y0, y1, sum.moisture, moisture, sum.counts[CELL_TYPE_WATER], counts[CELL_TYPE_WATER]);
+            ReportFailure(results, seed, world->tick, "QueryRegion", detail);
+        }
+    }
+}
+
+// Compare every tile's chunk summaries, refreshed for the changed tiles only,
+// with the bounds of its cells
+static void CheckChunkSummaries(World* world, unsigned int seed, VerifyResults* results) {
+    RefreshChunkSummaries(world);
+    for (int y0 = 0; y0 < world->height; y0 += DIRTY_TILE_SIZE) {
+        for (int x0 = 0; x0 < world->width; x0 += DIRTY_TILE_SIZE) {
+            int x1 = (x0 + DIRTY_TILE_SIZE < world->width) ? x0 + DIRTY_TILE_SIZE : world->width;
+            int y1 = (y0 + DIRTY_TILE_SIZE < world->height) ? y0 + DIRTY_TILE_SIZE : world->height;
+
+            for (int m = 0; m < CHUNK_MATERIALS; m++) {
+                MaterialSummary s = SummarizeMaterial(world, m, x0, y0, x1, y1);
+                MaterialSummary e = { 0, 0, 0.0f, 0.0f };
+                for (int y = y0; y < y1; y++) {
+                    for (int x = x0; x < x1; x++) {
+                        const GridCell* cell = GetCell(world, x, y);
+                        if (cell->type != m) continue;
+                        if (e.count == 0 || cell->moisture > e.maxMoisture) e.maxMoisture = cell->moisture;
+                        int temperature = GetRowTemperature(world, y);
+                        if (e.count == 0 || temperature < e.minTemperature) e.minTemperature = temperature;
+                        if (e.count == 0 || temperature > e.maxTemperature) e.maxTemperature = temperature;
+                        e.count++;
+                    }
+                }
+                results->checks++;
+
+                if (s.count != e.count || (e.count > 0 && (s.maxMoisture != e.maxMoisture ||
+                    s.minTemperature != e.minTemperature || s.maxTemperature != e.maxTemperature))) {
+                    char detail[128];
+                    snprintf(detail, sizeof(detail), "tile (%d, %d) type %d: %d cells, max moisture %d, expected %d cells, %d",
+                             x0, y0, m, s.count, s.maxMoisture, e.count, e.maxMoisture);
+                    ReportFailure(results, seed, world->tick, "ChunkSummaries", detail);
+                }
+            }
+        }
+    }
+}
+
+// Number of rectangles covering a tile
+static int CountCovering(const DirtyRect* rects, int count, int tx, int ty) {
+    int x = tx * DIRTY_TILE_SIZE;
+    int y = ty * DIRTY_TILE_SIZE;
+    int covering = 0;
+    for (int r = 0; r < count; r++) {
+        if (x >= rects[r].x0 && x < rects[r].x1 && y >= rects[r].y0 && y < rects[r].y1) covering++;
+    }
+    return covering;
+}
+
+static bool RectsInGrid(const World* world, const DirtyRect* rects, int count) {
+    for (int r = 0; r < count; r++) {
+        if (rects[r].x0 < 0 || rects[r].y0 < 0 || rects[r].x1 > world->width || rects[r].y1 > world->height ||
+            rects[r].x0 >= rects[r].x1 || rects[r].y0 >= rects[r].y1 ||
+            (rects[r].x0 & (DIRTY_TILE_SIZE - 1)) || (rects[r].y0 & (DIRTY_TILE_SIZE - 1))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Check the rectangles the renderer would upload: every dirty tile covered once
+// and no clean one, or with too small a budget the bounding box of the dirty tiles.
+// Clears the tiles afterwards, as the renderer does every frame.
+static void CheckDirtyRects(World* world, unsigned int seed, VerifyResults* results) {
+    DirtyRect rects[VERIFY_DIRTY_RECTS];
+    DirtyRect few[VERIFY_FEW_DIRTY_RECTS];
+    int count = CollectDirtyRects(world, rects, VERIFY_DIRTY_RECTS);
+    int fewCount = CollectDirtyRects(world, few, VERIFY_FEW_DIRTY_RECTS);
+    int tilesX = (world->width + DIRTY_TILE_SIZE - 1) / DIRTY_TILE_SIZE;
+    int tilesY = (world->height + DIRTY_TILE_SIZE - 1) / DIRTY_TILE_SIZE;
+    char detail[128];
+    results->checks++;
+
+    int minX = tilesX, minY = tilesY, maxX = -1, maxY = -1;
+    for (int ty = 0; ty < tilesY; ty++) {
+        for (int tx = 0; tx < tilesX; tx++) {
+            bool dirty = IsTileDirty(world, tx, ty);
+            if (dirty) {
+                if (tx < minX) minX = tx;
+                if (tx > maxX) maxX = tx;
+                if (ty < minY) minY = ty;
+                maxY = ty;
+            }
+            int covering = CountCovering(rects, count, tx, ty);
+            if (count < VERIFY_DIRTY_RECTS && covering != (dirty ? 1 : 0)) {
+                snprintf(detail, sizeof(detail), "tile (%d, %d) %s, covered by %d of %d rectangles",
+                         tx, ty, dirty ? "dirty" : "clean", covering, count);
+                ReportFailure(results, seed, world->tick, "DirtyRects", detail);
+                ClearDirtyTiles(world);
+                return;
+            }
+        }
+    }
+    if (!RectsInGrid(world, rects, count) || !RectsInGrid(world, few, fewCount)) {
+        ReportFailure(results, seed, world->tick, "DirtyRects", "rectangle outside the grid or off the tile grid");
+    }
+
+    // The small budget gives the same rectangles when they fit, otherwise the bounding box
+    if (count <= VERIFY_FEW_DIRTY_RECTS) {
+        if (fewCount != count || memcmp(few, rects, count * sizeof(DirtyRect)) != 0) {
+            snprintf(detail, sizeof(detail), "%d rectangles with a budget of %d, %d with %d",
+                     count, VERIFY_DIRTY_RECTS, fewCount, VERIFY_FEW_DIRTY_RECTS);
+            ReportFailure(results, seed, world->tick, "DirtyRects", detail);
+        }
+    } else {
+        DirtyRect box = { minX * DIRTY_TILE_SIZE, minY * DIRTY_TILE_SIZE,
+                          (maxX + 1) * DIRTY_TILE_SIZE, (maxY + 1) * DIRTY_TILE_SIZE };
+        if (box.x1 > world->width) box.x1 = world->width;
+        if (box.y1 > world->height) box.y1 = world->height;
+        if (fewCount != 1 || memcmp(&few[0], &box, sizeof(box)) != 0) {
+            snprintf(detail, sizeof(detail), "fallback [%d,%d)x[%d,%d), bounding box [%d,%d)x[%d,%d)",
+                     few[0].x0, few[0].x1, few[0].y0, few[0].y1, box.x0, box.x1, box.y0, box.y1);
+            ReportFailure(results, seed, world->tick, "DirtyRects", detail);
+        }
+    }
+    ClearDirtyTiles(world);
+}
+
+// Advance the copy run at a reduced rate away from its focus. Zone boundaries
+// must not create or destroy moisture, whichever side of them is due.
+static void CheckReducedRate(World* lod, unsigned int seed, VerifyResults* results) {
+    int before = CalculateTotalMoisture(lod);
+    UpdateGrid(lod);
+    results->checks++;
+    if (CalculateTotalMoisture(lod) != before) {
+        char detail[64];
+        snprintf(detail, sizeof(detail), "total moisture %d -> %d", before, CalculateTotalMoisture(lod));
+        ReportFailure(results, seed, lod->tick, "UpdateGrid (reduced rate)", detail);
+    }
+}
+
+// One tick of UpdateGrid with the water and air passes replaced by their references
+static void ReferenceTick(World* world) {
+    world->tick++;
+    for (int y = 0; y < world->height; y++) {
+        for (int x = 0; x < world->width; x++) {
+            GetCell(world, x, y)->is_falling = false;
+            if (x == 0 || x == world->width - 1 || y == 0 || y == world->height - 1) {
+                GetCell(world, x, y)->type = CELL_TYPE_BORDER;
+            }
+        }
+    }
+
+    RefUpdateWater(world);
+    RefUpdateAir(world);
+    UpdateRandomTicks(world);
+    UpdateOrganisms(world);
+}
+
+static EnsembleStats MeasureWorld(const World* world) {
+    EnsembleStats stats = { 0 };
+    double mass = 0.0;
+    double weightedRow = 0.0;
+
+    for (int y = 0; y < world->height; y++) {
+        for (int x = 0; x < world->width; x++) {
+            const GridCell* cell = GetCell(world, x, y);
+            if (cell->type == CELL_TYPE_WATER) {
+                stats.waterCells++;
+                mass += cell->moisture;
+                weightedRow += (double)cell->moisture * y;
+            } else if (cell->type == CELL_TYPE_AIR && y < 10) {
+                stats.cloudMoisture += cell->moisture;
+            }
+        }
+    }
+    stats.waterDepth = (mass > 0.0) ? weightedRow / mass / world->height : 0.0;
+    return stats;
+}
+
+static double RelativeDifference(double reference, double optimized) {
+    double scale = fabs(reference) > 1.0 ? fabs(reference) : 1.0;
+    return fabs(optimized - reference) / scale;
+}
+
+// Long runs of the pressure model diverge once settled chunks sleep, so they are
+// compared by the mean of end-of-run statistics over several seeds
+static void CheckEnsemble(int seeds, unsigned int firstSeed, int ticks, int width, int height,
+                          double tolerance, VerifyResults* results) {
+    EnsembleStats refMean = { 0 };
+    EnsembleStats optMean = { 0 };
+    int runs = 0;
+
+    for (int s = 0; s < seeds; s++) {
+        World ref;
+        World opt;
+        if (!InitWorld(&opt, width, height, firstSeed + s)) continue;
+        BuildRandomScene(&opt);
+        SetWaterModel(&opt, WATER_MODEL_PRESSURE);
+        if (!CloneWorld(&ref, &opt)) {
+            CleanupWorld(&opt);
+            continue;
+        }
+
+        for (int tick = 0; tick < ticks; tick++) {
+            UpdateGrid(&opt);
+            ReferenceTick(&ref);
+        }
+
+        EnsembleStats a = MeasureWorld(&ref);
+        EnsembleStats b = MeasureWorld(&opt);
+        refMean.waterCells += a.waterCells;
+        refMean.waterDepth += a.waterDepth;
+        refMean.cloudMoisture += a.cloudMoisture;
+        optMean.waterCells += b.waterCells;
+        optMean.waterDepth += b.waterDepth;
+        optMean.cloudMoisture += b.cloudMoisture;
+        runs++;
+
+        if (CalculateTotalMoisture(&opt) != CalculateTotalMoisture(&ref)) {
+            char detail[128];
+            snprintf(detail, sizeof(detail), "total moisture %d (reference %d)",
+                     CalculateTotalMoisture(&opt), CalculateTotalMoisture(&ref));
+            ReportFailure(results, firstSeed + s, opt.tick, "ensemble", detail);
+        }
+
+        CleanupWorld(&ref);
+        CleanupWorld(&opt);
+    }
+    if (runs == 0) return;
+
+    struct {
+        const char* name;
+        double reference;
+        double optimized;
+    } measures[] = {
+        { "water cells", refMean.waterCells / runs, optMean.waterCells / runs },
+        { "water depth", refMean.waterDepth / runs, optMean.waterDepth / runs },
+        { "cloud moisture", refMean.cloudMoisture / runs, optMean.cloudMoisture / runs },
+    };
+
+    for (size_t m = 0; m < sizeof(measures) / sizeof(measures[0]); m++) {
+        double difference = RelativeDifference(measures[m].reference, measures[m].optimized);
+        printf("Ensemble %s: reference %.3f, optimized %.3f (%.2f%%)\n",
+               measures[m].name, measures[m].reference, measures[m].optimized, difference * 100.0);
+        results->checks++;
+        if (difference > tolerance) {
+            char detail[128];
+            snprintf(detail, sizeof(detail), "%s differs by %.2f%%, tolerance %.2f%%",
+                     measures[m].name, difference * 100.0, tolerance * 100.0);
+            ReportFailure(results, firstSeed, ticks, "ensemble", detail);
+        }
+    }
+}
+
+static long long AirMoisture(const World* world) {
+    long long moisture = 0;
+    for (int y = 0; y < world->height; y++) {
+        for (int x = 0; x < world->width; x++) {
+            const GridCell* cell = GetCell(world, x, y);
+            if (cell->type == CELL_TYPE_AIR) moisture += cell->moisture;
+        }
+    }
+    return moisture;
+}
+
+// Moisture evaporated over 'ticks' ticks from a copy of the world, either by
+// visiting every cell or by random ticks with tiles away from the corner
+// updating every 'ticks' ticks (a single tick at the full rate when ticks is 1)
+static long long MeasureEvaporation(const World* world, bool sampled, int ticks) {
+    World copy;
+    if (!CloneWorld(&copy, world)) return 0;
+    if (ticks > 1) SetSimulationFocus(&copy, 0, 0, 1, 1, 0, ticks);
+
+    long long before = AirMoisture(&copy);
+    for (int t = 0; t < ticks; t++) {
+        copy.tick++;
+        if (sampled) {
+            UpdateRandomTicks(&copy);
+        } else {
+            UpdateEvaporation(&copy);
+        }
+    }
+    long long evaporated = AirMoisture(&copy) - before;
+    CleanupWorld(&copy);
+    return evaporated;
+}
+
+// Random ticks stand one sampled cell in for many, and reduced-rate tiles for
+// several ticks. From the same states they should evaporate about as much as
+// visiting every cell on every tick.
+static void CheckEvaporationRate(int seeds, unsigned int firstSeed, int ticks, int width, int height,
+                                 VerifyResults* results) {
+    long long perCell[2] = { 0, 0 };
+    long long sampled[2] = { 0, 0 };
+    static const int spans[2] = { 1, VERIFY_LOD_INTERVAL };
+
+    for (int s = 0; s < seeds; s++) {
+        World world;
+        if (!InitWorld(&world, width, height, firstSeed + s)) continue;
+        BuildRandomScene(&world);
+        for (int tick = 0; tick < ticks; tick++) {
+            if (tick % VERIFY_EVAPORATION_EVERY == 0) {
+                for (int i = 0; i < 2; i++) {
+                    perCell[i] += MeasureEvaporation(&world, false, spans[i]);
+                    sampled[i] += MeasureEvaporation(&world, true, spans[i]);
+                }
+            }
+            UpdateGrid(&world);
+        }
+        CleanupWorld(&world);
+    }
+
+    for (int i = 0; i < 2; i++) {
+        double ratio = (perCell[i] > 0) ? (double)sampled[i] / perCell[i] : 1.0;
+        printf("Evaporation over %d tick%s: random ticks %lld, every cell %lld (%.1f%%)\n",
+               spans[i], spans[i] > 1 ? "s at a reduced rate" : "", sampled[i], perCell[i], ratio * 100.0);
+        results->checks++;
+        if (fabs(ratio - 1.0) > VERIFY_EVAPORATION_TOLERANCE) {
+            char detail[128];
+            snprintf(detail, sizeof(detail), "random ticks evaporate %.1f%% of the per-cell amount over %d ticks",
+                     ratio * 100.0, spans[i]);
+            ReportFailure(results, firstSeed, ticks, "evaporation", detail);
+        }
+    }
+}
+
+int RunVerify(int argc, char** argv) {
+    int seeds = 8;
+    unsigned int firstSeed = 1;
+    int ticks = 200;
+    int width = 96;
+    int height = 72;
+    bool statistical = false;
+    double tolerance = 0.05;
+    int layout = GRID_LAYOUT_ROWS;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = (i + 1 < argc);
+        if (strcmp(argv[i], "--seeds") == 0 && hasValue) {
+            seeds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            firstSeed = (unsigned int)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--ticks") == 0 && hasValue) {
+            ticks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--size") == 0 && hasValue) {
+            if (sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width < 3 || height < 3) {
+                printf("ERROR: Invalid world size '%s', expected WxH\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--tolerance") == 0 && hasValue) {
+            tolerance = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--layout") == 0 && hasValue) {
+            layout = ParseGridLayout(argv[++i]);
+            if (layout < 0) {
+                printf("ERROR: Unknown grid layout '%s'\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--statistical") == 0) {
+            statistical = true;
+        }
+    }
+
+    VerifyResults results = { 0 };
+    for (int s = 0; s < seeds; s++) {
+        unsigned int seed = firstSeed + s;
+        World world;
+        World ref;
+        World opt;
+        if (!InitWorldWithLayout(&world, width, height, seed, layout)) return 1;
+        BuildRandomScene(&world);
+        if (!InitRegionStats(&world)) {
+            CleanupWorld(&world);
+            return 1;
+        }
+        if (!CloneWorld(&ref, &world)) {
+            CleanupWorld(&world);
+            return 1;
+        }
+        if (!CloneWorld(&opt, &world)) {
+            CleanupWorld(&ref);
+            CleanupWorld(&world);
+            return 1;
+        }
+        World lod;
+        if (!CloneWorld(&lod, &world)) {
+            CleanupWorld(&opt);
+            CleanupWorld(&ref);
+            CleanupWorld(&world);
+            return 1;
+        }
+
+        // The optimized copy tracks changed tiles, so the passes can skip tiles by their summaries
+        InitDirtyTiles(&opt);
+        InitChunkSummaries(&opt);
+
+        // The level-of-detail copy keeps its last columns at the full rate (from the
+        // last multiple of SIM_LOD_SNAP on) and runs its own course from here
+        InitDirtyTiles(&lod);
+        InitChunkSummaries(&lod);
+        SetSimulationFocus(&lod, width - 1, 0, width, height, 0, VERIFY_LOD_INTERVAL);
+
+        // Each tick, check the passes against the state UpdateGrid hands them, then
+        // advance with the optimized code so mismatches never carry over
+        for (int tick = 0; tick < ticks; tick++) {
+            for (size_t p = 0; p < sizeof(verifiedPasses) / sizeof(verifiedPasses[0]); p++) {
+                CheckPass(&verifiedPasses[p], &world, &ref, &opt, seed, &results);
+            }
+            CheckCellCalls(&world, &ref, &opt, seed, &results);
+
+            int before = CalculateTotalMoisture(&world);
+            uint32_t stream = world.rngState;
+            UpdateGrid(&world);
+            results.checks++;
+            if (CalculateTotalMoisture(&world) != before) {
+                char detail[64];
+                snprintf(detail, sizeof(detail), "total moisture %d -> %d", before, CalculateTotalMoisture(&world));
+                ReportFailure(&results, seed, world.tick, "UpdateGrid", detail);
+            }
+
+            // Updates only draw counter-based random numbers (CellRandom), which do not
+            // depend on the order cells are visited in
+            if (world.rngState != stream) {
+                ReportFailure(&results, seed, world.tick, "UpdateGrid", "drew from the sequential random stream");
+            }
+            CheckRegionStats(&world, seed, &results);
+            CheckChunkSummaries(&world, seed, &results);
+            CheckDirtyRects(&world, seed, &results);
+            CheckReducedRate(&lod, seed, &results);
+        }
+
+        printf("Seed %u: %s water, %d ticks\n", seed,
+               world.waterModel == WATER_MODEL_PRESSURE ? "pressure" : "cellular", ticks);
+        CleanupWorld(&lod);
+        CleanupWorld(&opt);
+        CleanupWorld(&ref);
+        CleanupWorld(&world);
+    }
+
+    if (statistical) {
+        CheckEnsemble(seeds, firstSeed, ticks, width, height, tolerance, &results);
+        CheckEvaporationRate(seeds, firstSeed, ticks, width, height, &results);
+    }
+
+    printf("Verify: %d checks, %d failures\n", results.checks, results.failures);
+    return results.failures ? 1 : 0;
+}
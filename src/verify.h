@@ -0,0 +1,18 @@
+#ifndef VERIFY_H
+#define VERIFY_H
+
+// Differential test of the simulation passes: random seeded scenes are stepped
+// with the optimized passes, and every tick each pass is also run on a copy with
+// its frozen reference version (see reference_sim.h). The results must match
+// cell for cell and conserve total moisture, and updates must only draw
+// counter-based random numbers. Region queries (region_stats.h) and chunk
+// summaries (chunk_summary.h) must agree with the cells.
+// Options: --seeds N, --seed N (first seed), --ticks N, --size WxH,
+//          --layout rows|tiles|morton (grid storage order of the checked worlds),
+//          --statistical (also compare long reference and optimized runs of the
+//          pressure model, whose settled chunks sleep, by ensemble statistics),
+//          --tolerance F (relative, for --statistical)
+// Returns the process exit code (non-zero when any check failed).
+int RunVerify(int argc, char** argv);
+
+#endif // VERIFY_H
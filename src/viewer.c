@@ -0,0 +1,205 @@
+#include "viewer.h"
+#include "raylib.h"
+#include "frame_publish.h"
+#include "palette.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define VIEWER_ATTACH_SECONDS 5.0
+
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void SleepMilliseconds(int ms) {
+#if !defined(_WIN32)
+    struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+#endif
+}
+
+// Wait for the publisher to create its segment
+static FrameSubscriber* AttachWaiting(const char* name) {
+    double start = Now();
+    FrameSubscriber* subscriber = AttachFramePublish(name);
+    while (!subscriber && Now() - start < VIEWER_ATTACH_SECONDS) {
+        SleepMilliseconds(10);
+        subscriber = AttachFramePublish(name);
+    }
+    if (!subscriber) {
+        printf("ERROR: No frames published as '%s'\n", name);
+    }
+    return subscriber;
+}
+
+// True when every color is one the palette gives to the cell type beside it
+// (the border type -1 is stored as 255)
+static bool FrameColorsMatchTypes(const PublishedFrame* frame) {
+    int count = frame->width * frame->height;
+    for (int i = 0; i < count; i++) {
+        int type = (frame->types[i] == 255) ? CELL_TYPE_BORDER : frame->types[i];
+        if (!IsPaletteColor(type, frame->colors[i])) return false;
+    }
+    return true;
+}
+
+// Read frames without a window and check that each one is consistent
+static int RunCheckReader(const char* name, int frames) {
+    FrameSubscriber* subscriber = AttachWaiting(name);
+    if (!subscriber) return 1;
+    BuildPalette();
+
+    int good = 0;
+    int retried = 0;
+    int inconsistent = 0;
+    int firstTick = -1;
+    int lastTick = -1;
+    int lastSlot = -1;
+    uint32_t lastSequence = 0;
+
+    while (good + inconsistent < frames) {
+        PublishedFrame frame;
+        bool closed = IsFramePublishClosed(subscriber);
+        if (!BeginReadFrame(subscriber, &frame) || (frame.slot == lastSlot && frame.sequence == lastSequence)) {
+            if (closed) break;
+            SleepMilliseconds(1);
+            continue;
+        }
+
+        // Hash the frame in place, then make sure it was not overwritten meanwhile
+        uint32_t checksum = FrameChecksum(frame.colors, frame.types, frame.width * frame.height, frame.tick);
+        bool colorsMatch = FrameColorsMatchTypes(&frame);
+        if (!EndReadFrame(subscriber, &frame)) {
+            retried++;
+            continue;
+        }
+        lastSlot = frame.slot;
+        lastSequence = frame.sequence;
+
+        if (checksum != frame.checksum || !colorsMatch || frame.tick < lastTick) {
+            inconsistent++;
+            continue;
+        }
+        if (firstTick < 0) firstTick = frame.tick;
+        lastTick = frame.tick;
+        good++;
+    }
+
+    printf("Viewer check: %d frames (ticks %d to %d), %d reads retried after being overwritten, %d inconsistent\n",
+           good, firstTick, lastTick, retried, inconsistent);
+    DetachFramePublish(subscriber);
+    return (inconsistent > 0) ? 1 : 0;
+}
+
+// Largest rectangle with the frame's aspect ratio that fits the window
+static Rectangle FitRect(int width, int height) {
+    float scaleX = (float)GetScreenWidth() / width;
+    float scaleY = (float)GetScreenHeight() / height;
+    float scale = (scaleX < scaleY) ? scaleX : scaleY;
+    float w = width * scale;
+    float h = height * scale;
+    return (Rectangle){ (GetScreenWidth() - w) / 2, (GetScreenHeight() - h) / 2, w, h };
+}
+
+static void UnloadFrameTextures(Texture2D textures[2]) {
+    for (int i = 0; i < 2; i++) {
+        if (textures[i].id != 0) UnloadTexture(textures[i]);
+        textures[i] = (Texture2D){ 0 };
+    }
+}
+
+int RunViewer(int argc, char** argv) {
+    const char* name = NULL;
+    int frames = 0;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = (i + 1 < argc);
+        if (strcmp(argv[i], "--viewer") == 0 && hasValue) {
+            name = argv[++i];
+        } else if (strcmp(argv[i], "--frames") == 0 && hasValue) {
+            frames = atoi(argv[++i]);
+        }
+    }
+    if (!name) {
+        printf("ERROR: Usage: --viewer name [--frames N]\n");
+        return 1;
+    }
+    if (frames > 0) {
+        return RunCheckReader(name, frames);
+    }
+
+    InitWindow(1280, 720, "Sandbox Viewer");
+    SetWindowState(FLAG_WINDOW_RESIZABLE);
+    SetTargetFPS(60);
+
+    // Frames are uploaded straight from the shared mapping into the back texture,
+    // which is only shown once the publisher is known not to have touched the frame
+    FrameSubscriber* subscriber = NULL;
+    Texture2D textures[2] = { 0 };
+    int front = 0;
+    int shownTick = -1;
+    int lastSlot = -1;
+    uint32_t lastSequence = 0;
+    int dropped = 0;
+    double lastAttach = -VIEWER_ATTACH_SECONDS;
+
+    while (!WindowShouldClose()) {
+        if (!subscriber && GetTime() - lastAttach >= 1.0) {
+            lastAttach = GetTime();
+            subscriber = AttachFramePublish(name);
+            lastSlot = -1;
+        }
+
+        PublishedFrame frame;
+        if (subscriber && BeginReadFrame(subscriber, &frame) &&
+            (frame.slot != lastSlot || frame.sequence != lastSequence)) {
+            Texture2D* back = &textures[1 - front];
+            if (back->id != 0 && (back->width != frame.width || back->height != frame.height)) {
+                UnloadFrameTextures(textures);
+            }
+            if (back->id == 0) {
+                Image image = { (void*)frame.colors, frame.width, frame.height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+                *back = LoadTextureFromImage(image);
+                SetTextureFilter(*back, TEXTURE_FILTER_POINT);
+            } else {
+                UpdateTexture(*back, frame.colors);
+            }
+
+            if (EndReadFrame(subscriber, &frame)) {
+                front = 1 - front;
+                shownTick = frame.tick;
+                lastSlot = frame.slot;
+                lastSequence = frame.sequence;
+            } else {
+                dropped++;
+            }
+        }
+
+        // Once the publisher stops, keep the last frame and wait for a new run
+        if (subscriber && IsFramePublishClosed(subscriber)) {
+            DetachFramePublish(subscriber);
+            subscriber = NULL;
+        }
+
+        BeginDrawing();
+        ClearBackground(BLACK);
+        if (textures[front].id != 0) {
+            Texture2D texture = textures[front];
+            DrawTexturePro(texture, (Rectangle){ 0, 0, texture.width, texture.height },
+                           FitRect(texture.width, texture.height), (Vector2){ 0, 0 }, 0.0f, WHITE);
+        }
+        DrawText(TextFormat("%s  tick %d  %s  dropped %d", name, shownTick,
+                            subscriber ? "live" : "waiting for publisher", dropped),
+                 10, 10, 20, WHITE);
+        EndDrawing();
+    }
+
+    UnloadFrameTextures(textures);
+    DetachFramePublish(subscriber);
+    CloseWindow();
+    return 0;
+}
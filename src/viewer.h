@@ -0,0 +1,13 @@
+#ifndef VIEWER_H
+#define VIEWER_H
+
+// Watch a simulation published with --headless --publish name from another
+// process (see frame_publish.h). The viewer maps the frames read-only and never
+// slows the simulation down; frames the publisher overwrote while they were
+// being uploaded are dropped and the previous one stays on screen.
+// Usage: --viewer name, optionally --frames N to read N frames without a window
+// and check every one against its checksum.
+// Returns the process exit code.
+int RunViewer(int argc, char** argv);
+
+#endif // VIEWER_H
@@ -0,0 +1,66 @@
+#include "viewport.h"
+#include <math.h>
+
+float MinViewportZoom(const Viewport* view, int worldWidth, int worldHeight) {
+    float zoomX = (float)view->width / worldWidth;
+    float zoomY = (float)view->height / worldHeight;
+    float zoom = (zoomX < zoomY) ? zoomX : zoomY;
+    return (zoom < VIEWPORT_MAX_ZOOM) ? zoom : VIEWPORT_MAX_ZOOM;
+}
+
+// Clamp one camera axis; a world narrower than the view is centred
+static float ClampAxis(float camera, float visible, int worldSize) {
+    if (visible >= worldSize) return (worldSize - visible) / 2.0f;
+    if (camera < 0.0f) return 0.0f;
+    if (camera > worldSize - visible) return worldSize - visible;
+    return camera;
+}
+
+void ClampViewport(Viewport* view, int worldWidth, int worldHeight) {
+    float minZoom = MinViewportZoom(view, worldWidth, worldHeight);
+    if (view->zoom < minZoom) view->zoom = minZoom;
+    if (view->zoom > VIEWPORT_MAX_ZOOM) view->zoom = VIEWPORT_MAX_ZOOM;
+
+    view->cameraX = ClampAxis(view->cameraX, view->width / view->zoom, worldWidth);
+    view->cameraY = ClampAxis(view->cameraY, view->height / view->zoom, worldHeight);
+}
+
+void ZoomViewport(Viewport* view, float factor, Vector2 anchor, int worldWidth, int worldHeight) {
+    // World point under the anchor before zooming
+    float worldX = view->cameraX + (anchor.x - view->x) / view->zoom;
+    float worldY = view->cameraY + (anchor.y - view->y) / view->zoom;
+
+    view->zoom *= factor;
+    ClampViewport(view, worldWidth, worldHeight);
+
+    // Move the camera so the same point stays under the anchor
+    view->cameraX = worldX - (anchor.x - view->x) / view->zoom;
+    view->cameraY = worldY - (anchor.y - view->y) / view->zoom;
+    ClampViewport(view, worldWidth, worldHeight);
+}
+
+void PanViewport(Viewport* view, float dx, float dy, int worldWidth, int worldHeight) {
+    view->cameraX += dx / view->zoom;
+    view->cameraY += dy / view->zoom;
+    ClampViewport(view, worldWidth, worldHeight);
+}
+
+void CenterViewport(Viewport* view, float cellX, float cellY, int worldWidth, int worldHeight) {
+    view->cameraX = cellX - view->width / view->zoom / 2.0f;
+    view->cameraY = cellY - view->height / view->zoom / 2.0f;
+    ClampViewport(view, worldWidth, worldHeight);
+}
+
+bool ScreenToCell(const Viewport* view, Vector2 screen, int* cellX, int* cellY) {
+    *cellX = (int)floorf(view->cameraX + (screen.x - view->x) / view->zoom);
+    *cellY = (int)floorf(view->cameraY + (screen.y - view->y) / view->zoom);
+    return screen.x >= view->x && screen.x < view->x + view->width &&
+           screen.y >= view->y && screen.y < view->y + view->height;
+}
+
+Vector2 CellToScreen(const Viewport* view, float cellX, float cellY) {
+    return (Vector2){
+        view->x + (cellX - view->cameraX) * view->zoom,
+        view->y + (cellY - view->cameraY) * view->zoom
+    };
+}
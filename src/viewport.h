@@ -0,0 +1,42 @@
+#ifndef VIEWPORT_H
+#define VIEWPORT_H
+
+#include "raylib.h"
+#include <stdbool.h>
+
+#define VIEWPORT_MAX_ZOOM 64.0f   // most screen pixels per grid cell
+#define VIEWPORT_ZOOM_STEP 1.25f  // zoom factor per wheel notch or key press
+
+// Camera onto the world: a screen rectangle showing the cells from (cameraX, cameraY) on
+typedef struct {
+    int x;               // screen rectangle of the viewport
+    int y;
+    int width;
+    int height;
+    float zoom;          // screen pixels per grid cell (below 1 when zoomed out)
+    float cameraX;       // world cell at the top-left corner of the viewport
+    float cameraY;
+} Viewport;
+
+// Smallest zoom, at which the whole world fits in the viewport
+float MinViewportZoom(const Viewport* view, int worldWidth, int worldHeight);
+
+// Keep the zoom in range and the camera over the world (centred when the world is smaller)
+void ClampViewport(Viewport* view, int worldWidth, int worldHeight);
+
+// Zoom by 'factor', keeping the world point under 'anchor' (screen coordinates) in place
+void ZoomViewport(Viewport* view, float factor, Vector2 anchor, int worldWidth, int worldHeight);
+
+// Move the camera by a distance in screen pixels
+void PanViewport(Viewport* view, float dx, float dy, int worldWidth, int worldHeight);
+
+// Centre the camera on a world position
+void CenterViewport(Viewport* view, float cellX, float cellY, int worldWidth, int worldHeight);
+
+// Grid cell under a screen position; false when the position is outside the viewport
+bool ScreenToCell(const Viewport* view, Vector2 screen, int* cellX, int* cellY);
+
+// Screen position of a world position
+Vector2 CellToScreen(const Viewport* view, float cellX, float cellY);
+
+#endif // VIEWPORT_H
@@ -0,0 +1,376 @@
+#include "world_gen.h"
+#include "grid.h"
+#include "cell_types.h"
+#include "cell_defaults.h"
+#include "cell_actions.h"
+#include "fluid.h"
+#include "organisms.h"
+#include "dirty_tiles.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#if !defined(_WIN32)
+    #include <unistd.h>
+#endif
+
+#define WORLDGEN_TEMPERATURE_VARIATION 3.0f  // most degrees the noise adds or removes
+#define WORLDGEN_SOIL_DRYING 1.5f            // soil moisture lost per cell above the water table
+
+// Fractal value noise: octaves of random values on a square lattice, each with
+// half the spacing and half the amplitude of the one before
+typedef struct {
+    uint32_t seed;
+    int period;     // lattice spacing of the first octave, in cells
+    int octaves;    // at most WORLDGEN_OCTAVES, and period >> (octaves - 1) must be at least 1
+} NoiseField;
+
+// Four floats in one SIMD register (GCC and Clang vector extension), so the
+// per-row arithmetic is vectorized at any optimization level
+typedef float NoiseVector __attribute__((vector_size(16)));
+#define NOISE_VECTORS (WORLDGEN_CHUNK_SIZE / 4)
+
+// Noise values for the columns of one chunk, as vectors or one by one
+typedef union {
+    NoiseVector v[NOISE_VECTORS];
+    float f[WORLDGEN_CHUNK_SIZE];
+} NoiseSpan;
+
+// State for evaluating a field row by row over one span of columns: where each
+// column falls between lattice points, and the lattice values of the rows above
+// and below the current one, already interpolated along x. Spans narrower than
+// a chunk are computed at full width; the extra columns are never read.
+typedef struct {
+    int x0;
+    int latticeY[WORLDGEN_OCTAVES];  // lattice row of 'above', INT_MIN before the first row
+    int latticeX[WORLDGEN_OCTAVES];  // first lattice column the span touches
+    int latticePoints[WORLDGEN_OCTAVES];
+    unsigned char lattice[WORLDGEN_OCTAVES][WORLDGEN_CHUNK_SIZE];  // lattice point left of each column, from the span's first
+    float weight[WORLDGEN_OCTAVES][WORLDGEN_CHUNK_SIZE];           // smoothed distance to it
+    NoiseSpan above[WORLDGEN_OCTAVES];
+    NoiseSpan below[WORLDGEN_OCTAVES];
+} NoiseRows;
+
+// Work shared by the worker threads
+typedef struct {
+    World* world;
+    const WorldGenOptions* options;
+    GridCell templates[CELL_TYPE_MOSS + 1];  // default cells of each type
+    NoiseField materialNoise;
+    NoiseField moistureNoise;
+    NoiseField temperatureNoise;
+    int* surfaceY;      // per column, first row of ground
+    int* rockY;         // per column, first row of the rock layer
+    int waterY;         // first row at or below the water table
+    int chunksX;
+    int chunkCount;
+    int nextChunk;
+    pthread_mutex_t lock;
+    int cells[CELL_TYPE_MOSS + 1];
+} WorldGenQueue;
+
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int CountCores(void) {
+#if defined(_WIN32)
+    const char* cores = getenv("NUMBER_OF_PROCESSORS");
+    int count = cores ? atoi(cores) : 1;
+#else
+    int count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return (count < 1) ? 1 : count;
+}
+
+WorldGenOptions DefaultWorldGenOptions(unsigned int seed) {
+    WorldGenOptions options;
+    options.seed = seed;
+    options.threads = 0;
+    options.surfaceLevel = 0.42f;
+    options.surfaceRelief = 0.3f;
+    options.soilDepth = 0.1f;
+    options.waterTable = 0.5f;
+    options.bottomTemperature = 18.0f;
+    options.topTemperature = 5.0f;
+    return options;
+}
+
+// Random value in [-1, 1) at a lattice point
+static float LatticeValue(uint32_t seed, int ix, int iy) {
+    uint32_t h = seed ^ ((uint32_t)ix * 0x27D4EB2Du) ^ ((uint32_t)iy * 0x165667B1u);
+    h = (h ^ (h >> 15)) * 0x85EBCA6Bu;
+    h = (h ^ (h >> 13)) * 0xC2B2AE35u;
+    h ^= h >> 16;
+    return (float)(h >> 8) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+static float SmoothStep(float t) {
+    return t * t * (3.0f - 2.0f * t);
+}
+
+static void BeginNoiseRows(const NoiseField* field, NoiseRows* rows, int x0) {
+    for (int o = 0; o < field->octaves; o++) {
+        int period = field->period >> o;
+        float inverse = 1.0f / period;
+        int first = x0 / period;
+        for (int i = 0; i < WORLDGEN_CHUNK_SIZE; i++) {
+            int lx = (x0 + i) / period;
+            rows->lattice[o][i] = (unsigned char)(lx - first);
+            rows->weight[o][i] = SmoothStep((x0 + i - lx * period) * inverse);
+        }
+        rows->latticeX[o] = first;
+        rows->latticePoints[o] = rows->lattice[o][WORLDGEN_CHUNK_SIZE - 1] + 2;
+        rows->latticeY[o] = INT_MIN;
+    }
+}
+
+// Values of lattice row ly interpolated along x over the span; each lattice
+// point is hashed once
+static void InterpolateLatticeRow(uint32_t seed, int ly, const NoiseRows* rows, int o, NoiseSpan* out) {
+    float values[WORLDGEN_CHUNK_SIZE + 1];
+    for (int p = 0; p < rows->latticePoints[o]; p++) {
+        values[p] = LatticeValue(seed, rows->latticeX[o] + p, ly);
+    }
+
+    const unsigned char* lattice = rows->lattice[o];
+    const float* weight = rows->weight[o];
+    for (int i = 0; i < WORLDGEN_CHUNK_SIZE; i++) {
+        float a = values[lattice[i]];
+        out->f[i] = a + (values[lattice[i] + 1] - a) * weight[i];
+    }
+}
+
+// Noise in [-1, 1] for the span's columns of row y. Rows must be requested top
+// to bottom after BeginNoiseRows.
+static void NoiseRow(const NoiseField* field, NoiseRows* rows, int y, NoiseSpan* out) {
+    for (int k = 0; k < NOISE_VECTORS; k++) {
+        out->v[k] = (NoiseVector){ 0.0f, 0.0f, 0.0f, 0.0f };
+    }
+
+    // Octave amplitudes 1, 1/2, 1/4, ... scaled so they add up to 1
+    float amplitude = 1.0f / (2.0f - 1.0f / (1 << (field->octaves - 1)));
+    for (int o = 0; o < field->octaves; o++) {
+        int period = field->period >> o;
+        uint32_t seed = field->seed + (uint32_t)o * 0x9E3779B9u;
+        int ly = y / period;
+        NoiseSpan* above = &rows->above[o];
+        NoiseSpan* below = &rows->below[o];
+
+        // Lattice rows only change every 'period' rows, and the new upper row is the old lower one
+        if (ly != rows->latticeY[o]) {
+            if (ly == rows->latticeY[o] + 1) {
+                *above = *below;
+            } else {
+                InterpolateLatticeRow(seed, ly, rows, o, above);
+            }
+            InterpolateLatticeRow(seed, ly + 1, rows, o, below);
+            rows->latticeY[o] = ly;
+        }
+
+        // The per-row work: one vector multiply-add per four columns
+        float t = amplitude * SmoothStep((float)(y - ly * period) / period);
+        float a = amplitude - t;
+        NoiseVector weightAbove = { a, a, a, a };
+        NoiseVector weightBelow = { t, t, t, t };
+        for (int k = 0; k < NOISE_VECTORS; k++) {
+            out->v[k] += above->v[k] * weightAbove + below->v[k] * weightBelow;
+        }
+        amplitude *= 0.5f;
+    }
+}
+
+// Material of an interior cell from its column's layers and the material noise
+static int GeneratedType(const WorldGenQueue* queue, int x, int y, float material) {
+    if (y < queue->surfaceY[x]) {
+        // Valleys below the water table hold lakes
+        return (y >= queue->waterY) ? CELL_TYPE_WATER : CELL_TYPE_AIR;
+    }
+    if (y < queue->rockY[x]) {
+        return (material > 0.5f) ? CELL_TYPE_ROCK : CELL_TYPE_SOIL;
+    }
+
+    // Pockets in the rock: water below the water table, soil above it
+    if (material < -0.45f) {
+        return (y >= queue->waterY) ? CELL_TYPE_WATER : CELL_TYPE_SOIL;
+    }
+    return CELL_TYPE_ROCK;
+}
+
+static int ClampInt(int v, int min, int max) {
+    return (v < min) ? min : ((v > max) ? max : v);
+}
+
+static void GenerateChunk(WorldGenQueue* queue, int chunk, int* cells) {
+    World* world = queue->world;
+    const WorldGenOptions* options = queue->options;
+    int x0 = (chunk % queue->chunksX) * WORLDGEN_CHUNK_SIZE;
+    int y0 = (chunk / queue->chunksX) * WORLDGEN_CHUNK_SIZE;
+    int x1 = (x0 + WORLDGEN_CHUNK_SIZE < world->width) ? x0 + WORLDGEN_CHUNK_SIZE : world->width;
+    int y1 = (y0 + WORLDGEN_CHUNK_SIZE < world->height) ? y0 + WORLDGEN_CHUNK_SIZE : world->height;
+    int count = x1 - x0;
+
+    NoiseRows materialRows, moistureRows, temperatureRows;
+    BeginNoiseRows(&queue->materialNoise, &materialRows, x0);
+    BeginNoiseRows(&queue->moistureNoise, &moistureRows, x0);
+    if (x0 == 0) BeginNoiseRows(&queue->temperatureNoise, &temperatureRows, x0);
+    NoiseSpan material, moisture, temperature;
+
+    for (int y = y0; y < y1; y++) {
+        NoiseRow(&queue->materialNoise, &materialRows, y, &material);
+        NoiseRow(&queue->moistureNoise, &moistureRows, y, &moisture);
+
+        // Same gradient as InitializeTemperatureGradient, cooler at the top. Each
+        // row varies with the noise at its first column, so only the chunks on
+        // the left edge set it.
+        if (x0 == 0) {
+            NoiseRow(&queue->temperatureNoise, &temperatureRows, y, &temperature);
+            float gradient = options->bottomTemperature -
+                             (options->bottomTemperature - options->topTemperature) * (float)y / world->height;
+            world->rowTemperature[y] = (int)(gradient + temperature.f[0] * WORLDGEN_TEMPERATURE_VARIATION + 0.5f);
+        }
+
+        for (int i = 0; i < count; i++) {
+            int x = x0 + i;
+            if (x == 0 || x == world->width - 1 || y == 0 || y == world->height - 1) continue;
+
+            int type = GeneratedType(queue, x, y, material.f[i]);
+            GridCell* cell = GetCell(world, x, y);
+            *cell = queue->templates[type];
+            cells[type]++;
+
+            switch (type) {
+                case CELL_TYPE_AIR:
+                    // Patchy humidity, within the range PlaceAir gives
+                    cell->moisture = ClampInt((int)(10.0f + 8.0f * moisture.f[i]), 0, 100);
+                    break;
+                case CELL_TYPE_SOIL:
+                    // Saturated at the water table, drier further above it
+                    cell->moisture = ClampInt((int)(90.0f - (queue->waterY - y) * WORLDGEN_SOIL_DRYING + 15.0f * moisture.f[i]),
+                                              10, 100);
+                    break;
+                case CELL_TYPE_WATER:
+                    cell->moisture = 700 + CellRandom(world, x, y, RANDOM_PLACE_MOISTURE, 0, 300);
+                    break;
+                case CELL_TYPE_ROCK:
+                    cell->variation = RandomColorVariation(world, x, y);
+                    break;
+            }
+        }
+    }
+}
+
+static void* WorldGenWorker(void* arg) {
+    WorldGenQueue* queue = (WorldGenQueue*)arg;
+    int cells[CELL_TYPE_MOSS + 1] = { 0 };
+
+    for (;;) {
+        pthread_mutex_lock(&queue->lock);
+        int chunk = queue->nextChunk++;
+        pthread_mutex_unlock(&queue->lock);
+        if (chunk >= queue->chunkCount) break;
+
+        GenerateChunk(queue, chunk, cells);
+    }
+
+    pthread_mutex_lock(&queue->lock);
+    for (int t = 0; t <= CELL_TYPE_MOSS; t++) {
+        queue->cells[t] += cells[t];
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return NULL;
+}
+
+// Ground surface and rock layer of every column, from one-dimensional noise
+// (a single row of two noise fields)
+static void BuildColumns(WorldGenQueue* queue) {
+    const World* world = queue->world;
+    const WorldGenOptions* options = queue->options;
+    NoiseField surfaceNoise = { options->seed * 2654435761u + 1u, 256, 5 };
+    NoiseField soilNoise = { options->seed * 2654435761u + 2u, 128, 3 };
+    NoiseSpan surface, soil;
+
+    for (int x0 = 0; x0 < world->width; x0 += WORLDGEN_CHUNK_SIZE) {
+        int count = (x0 + WORLDGEN_CHUNK_SIZE < world->width) ? WORLDGEN_CHUNK_SIZE : world->width - x0;
+        NoiseRows surfaceRows, soilRows;
+        BeginNoiseRows(&surfaceNoise, &surfaceRows, x0);
+        BeginNoiseRows(&soilNoise, &soilRows, x0);
+        NoiseRow(&surfaceNoise, &surfaceRows, 0, &surface);
+        NoiseRow(&soilNoise, &soilRows, 0, &soil);
+
+        for (int i = 0; i < count; i++) {
+            float level = options->surfaceLevel + options->surfaceRelief * surface.f[i];
+            int surfaceY = ClampInt((int)(level * world->height), 1, world->height - 1);
+            int depth = (int)(options->soilDepth * world->height * (1.0f + 0.5f * soil.f[i]));
+            queue->surfaceY[x0 + i] = surfaceY;
+            queue->rockY[x0 + i] = surfaceY + ((depth > 1) ? depth : 1);
+        }
+    }
+}
+
+bool GenerateWorld(World* world, const WorldGenOptions* options, WorldGenStats* stats) {
+    double start = Now();
+
+    WorldGenQueue* queue = (WorldGenQueue*)calloc(1, sizeof(WorldGenQueue));
+    int* columns = (int*)malloc(2 * (size_t)world->width * sizeof(int));
+    if (!queue || !columns) {
+        printf("ERROR: Failed to allocate memory for world generation\n");
+        free(queue);
+        free(columns);
+        return false;
+    }
+    queue->world = world;
+    queue->options = options;
+    for (int t = 0; t <= CELL_TYPE_MOSS; t++) {
+        InitializeCellDefaults(&queue->templates[t], t);
+    }
+    queue->materialNoise = (NoiseField){ options->seed * 2654435761u + 3u, 64, 5 };
+    queue->moistureNoise = (NoiseField){ options->seed * 2654435761u + 4u, 128, 4 };
+    queue->temperatureNoise = (NoiseField){ options->seed * 2654435761u + 5u, 256, 3 };
+    queue->surfaceY = columns;
+    queue->rockY = columns + world->width;
+    queue->waterY = (int)(options->waterTable * world->height);
+    BuildColumns(queue);
+
+    queue->chunksX = (world->width + WORLDGEN_CHUNK_SIZE - 1) / WORLDGEN_CHUNK_SIZE;
+    queue->chunkCount = queue->chunksX * ((world->height + WORLDGEN_CHUNK_SIZE - 1) / WORLDGEN_CHUNK_SIZE);
+    pthread_mutex_init(&queue->lock, NULL);
+
+    int threads = (options->threads > 0) ? options->threads : CountCores();
+    if (threads > WORLDGEN_MAX_THREADS) threads = WORLDGEN_MAX_THREADS;
+    if (threads > queue->chunkCount) threads = queue->chunkCount;
+
+    pthread_t workers[WORLDGEN_MAX_THREADS];
+    int started = 0;
+    for (int t = 0; t < threads; t++) {
+        if (pthread_create(&workers[started], NULL, WorldGenWorker, queue) == 0) {
+            started++;
+        } else {
+            printf("ERROR: Failed to start world generation worker %d\n", t);
+        }
+    }
+    if (started == 0) WorldGenWorker(queue); // Fall back to running on this thread
+    for (int t = 0; t < started; t++) {
+        pthread_join(workers[t], NULL);
+    }
+    pthread_mutex_destroy(&queue->lock);
+
+    // A new scene: no plants or moss, every tile changed and all water free to move
+    InitOrganisms(world);
+    MarkAllDirty(world);
+    WakeFluidRect(world, 0, 0, world->width, world->height);
+
+    if (stats) {
+        stats->seconds = Now() - start;
+        stats->threads = (started > 0) ? started : 1;
+        stats->chunks = queue->chunkCount;
+        memcpy(stats->cells, queue->cells, sizeof(stats->cells));
+    }
+    free(columns);
+    free(queue);
+    return true;
+}
@@ -0,0 +1,47 @@
+#ifndef WORLD_GEN_H
+#define WORLD_GEN_H
+
+#include "grid.h"
+#include <stdbool.h>
+
+// Seeded procedural scenes: a rolling ground surface over soil and rock layers,
+// lakes wherever the ground dips below the water table, water-filled pockets in
+// the rock beneath it, soil that gets wetter towards the water table, patchy air
+// humidity and a temperature gradient that varies a little from row to row.
+//
+// Every value is a pure function of the seed and the cell's position (fractal
+// value noise), so the world can be filled in any order. Worker threads take
+// WORLDGEN_CHUNK_SIZE square chunks from a shared queue and fill them row by row;
+// each row's noise is evaluated for the whole chunk width at once from lattice
+// values interpolated along x, which only change every few rows, leaving a plain
+// multiply-add loop over arrays per octave that the compiler vectorizes.
+#define WORLDGEN_CHUNK_SIZE 64
+#define WORLDGEN_MAX_THREADS 64
+#define WORLDGEN_OCTAVES 5
+
+typedef struct {
+    unsigned int seed;
+    int threads;             // worker threads, 0 for one per core
+    float surfaceLevel;      // mean ground height, as a fraction of the world height from the top
+    float surfaceRelief;     // most the ground rises or falls from its mean, as a fraction of the world height
+    float soilDepth;         // mean soil thickness above the rock, as a fraction of the world height
+    float waterTable;        // water table height, as a fraction of the world height from the top
+    float bottomTemperature; // temperature at the bottom and top of the world
+    float topTemperature;
+} WorldGenOptions;
+
+typedef struct {
+    double seconds;          // wall time of the whole generation
+    int threads;             // worker threads that ran
+    int chunks;
+    int cells[CELL_TYPE_MOSS + 1]; // interior cells of each type
+} WorldGenStats;
+
+WorldGenOptions DefaultWorldGenOptions(unsigned int seed);
+
+// Replace every interior cell of the world with a generated scene. The border,
+// tick and random streams are left alone, and the result does not depend on the
+// number of threads. Returns false when out of memory; stats may be NULL.
+bool GenerateWorld(World* world, const WorldGenOptions* options, WorldGenStats* stats);
+
+#endif // WORLD_GEN_H